@@ -0,0 +1,145 @@
+#include "avion.hpp"
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+static const size_t AUCUNE_BALISE = std::numeric_limits<size_t>::max();
+
+const double ALTITUDE_CROISIERE_EST = 9000.0; // Premier niveau des routes vers l'est (m)
+const double ALTITUDE_CROISIERE_OUEST = 10000.0; // Premier niveau des routes vers l'ouest : 1000 m de séparation avec le sens opposé
+const int NOMBRE_NIVEAUX = 3; // Niveaux par sens, espacés de 2000 m
+const double ALTITUDE_FIN_CROISIERE = 4000.0; // Altitude d'arrivée sur l'aéroport, celle de l'entrée en approche
+const double DISTANCE_MONTEE = 100000.0; // Distance pour rejoindre le niveau de croisière (m)
+const double DISTANCE_DESCENTE = 100000.0; // Distance de descente jusqu'à l'aéroport (m)
+
+ReseauAerien::ReseauAerien() {}
+
+size_t ReseauAerien::trouverBalise(const std::string& nom) const {
+    auto it = std::find(nomsBalises_.begin(), nomsBalises_.end(), nom);
+    if (it == nomsBalises_.end()) return AUCUNE_BALISE;
+    return static_cast<size_t>(it - nomsBalises_.begin());
+}
+
+void ReseauAerien::ajouterBalise(const std::string& nom, Position pos) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (trouverBalise(nom) != AUCUNE_BALISE) throw std::invalid_argument("Balise en double : " + nom);
+    nomsBalises_.push_back(nom);
+    balises_.push_back(Position(pos.getX(), pos.getY(), 0));
+    voisins_.emplace_back();
+    routes_.clear(); // Les routes en cache ne tiennent pas compte de la nouvelle balise
+}
+
+void ReseauAerien::ajouterSegment(const std::string& a, const std::string& b) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t ia = trouverBalise(a);
+    size_t ib = trouverBalise(b);
+    if (ia == AUCUNE_BALISE) throw std::invalid_argument("Balise inconnue : " + a);
+    if (ib == AUCUNE_BALISE) throw std::invalid_argument("Balise inconnue : " + b);
+    double longueur = balises_[ia].distance(balises_[ib]);
+    voisins_[ia].push_back({ ib, longueur });
+    voisins_[ib].push_back({ ia, longueur });
+    segments_.push_back({ ia, ib });
+    routes_.clear();
+}
+
+std::vector<Position> ReseauAerien::plusCourtChemin(const Aeroport* depart, const Aeroport* arrivee) const {
+    size_t source = trouverBalise(depart->nom);
+    size_t cible = trouverBalise(arrivee->nom);
+    if (source == AUCUNE_BALISE || cible == AUCUNE_BALISE) return {};
+
+    std::vector<double> distances(balises_.size(), std::numeric_limits<double>::infinity());
+    std::vector<size_t> predecesseurs(balises_.size(), AUCUNE_BALISE);
+
+    // File de priorité (distance, balise), la plus petite distance en premier
+    using Entree = std::pair<double, size_t>;
+    std::priority_queue<Entree, std::vector<Entree>, std::greater<Entree>> file;
+    distances[source] = 0;
+    file.push({ 0, source });
+
+    while (!file.empty()) {
+        auto [dist, balise] = file.top();
+        file.pop();
+        if (balise == cible) break; // Le plus court chemin vers l'arrivée est fixé
+        if (dist > distances[balise]) continue; // Entrée périmée
+
+        for (const auto& [voisin, longueur] : voisins_[balise]) {
+            if (dist + longueur < distances[voisin]) {
+                distances[voisin] = dist + longueur;
+                predecesseurs[voisin] = balise;
+                file.push({ distances[voisin], voisin });
+            }
+        }
+    }
+    if (predecesseurs[cible] == AUCUNE_BALISE) return {}; // Aéroports non reliés par le réseau
+
+    std::vector<Position> chemin;
+    for (size_t b = cible; b != AUCUNE_BALISE; b = predecesseurs[b]) chemin.push_back(balises_[b]);
+    std::reverse(chemin.begin(), chemin.end());
+    return chemin;
+}
+
+std::shared_ptr<const std::vector<Position>> ReseauAerien::calculerRoute(const Aeroport* depart, const Aeroport* arrivee) const {
+    // Chemin horizontal : voies aériennes, sinon ligne directe entre les deux aéroports
+    std::vector<Position> chemin = plusCourtChemin(depart, arrivee);
+    if (chemin.empty()) chemin = { depart->position, arrivee->position };
+
+    std::vector<double> abscisses(chemin.size(), 0.0); // Distance parcourue depuis le départ à chaque point
+    for (size_t i = 1; i < chemin.size(); ++i) abscisses[i] = abscisses[i - 1] + chemin[i - 1].distance(chemin[i]);
+    double longueur = abscisses.back();
+
+    // Niveau de croisière selon le sens (règle semi-circulaire simplifiée), réparti par trajet :
+    // des trajets différents qui empruntent les mêmes voies ne volent en général pas au même niveau
+    double croisiere = (arrivee->position.getX() >= depart->position.getX()) ? ALTITUDE_CROISIERE_EST : ALTITUDE_CROISIERE_OUEST;
+    croisiere += 2000.0 * static_cast<double>(std::hash<std::string>{}(depart->nom + "-" + arrivee->nom) % NOMBRE_NIVEAUX);
+    double finMontee = std::min(DISTANCE_MONTEE, longueur / 3.0);
+    double debutDescente = std::max(longueur - DISTANCE_DESCENTE, longueur * 2.0 / 3.0);
+
+    auto altitude = [&](double s) {
+        double montee = croisiere * s / finMontee;
+        double descente = ALTITUDE_FIN_CROISIERE + (croisiere - ALTITUDE_FIN_CROISIERE) * (longueur - s) / (longueur - debutDescente);
+        return std::min({ croisiere, montee, descente });
+    };
+    auto pointA = [&](double s) {
+        size_t i = 1;
+        while (i + 1 < chemin.size() && abscisses[i] < s) ++i;
+        double t = (s - abscisses[i - 1]) / std::max(abscisses[i] - abscisses[i - 1], 1e-9);
+        Position p = chemin[i - 1] + (chemin[i] - chemin[i - 1]) * t;
+        return Position(p.getX(), p.getY(), altitude(s));
+    };
+
+    // Points de passage (le départ lui-même est exclu), avec le haut de montée et le début de descente intercalés
+    std::vector<std::pair<double, Position>> points;
+    for (size_t i = 1; i < chemin.size(); ++i) {
+        points.push_back({ abscisses[i], Position(chemin[i].getX(), chemin[i].getY(), altitude(abscisses[i])) });
+    }
+    points.push_back({ finMontee, pointA(finMontee) });
+    points.push_back({ debutDescente, pointA(debutDescente) });
+    std::stable_sort(points.begin(), points.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    auto route = std::make_shared<std::vector<Position>>();
+    route->reserve(points.size());
+    for (const auto& [s, p] : points) route->push_back(p);
+    return route;
+}
+
+std::shared_ptr<const std::vector<Position>> ReseauAerien::getRoute(const Aeroport* depart, const Aeroport* arrivee) {
+    if (!depart || !arrivee) throw std::invalid_argument("Aeroport NULL");
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto cle = std::make_pair(depart, arrivee);
+    auto it = routes_.find(cle);
+    if (it != routes_.end()) return it->second; // Route déjà calculée pour ce trajet
+
+    auto route = calculerRoute(depart, arrivee);
+    routes_.emplace(cle, route);
+    return route;
+}
+
+std::vector<std::pair<Position, Position>> ReseauAerien::getSegments() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<Position, Position>> resultat;
+    resultat.reserve(segments_.size());
+    for (const auto& [a, b] : segments_) resultat.push_back({ balises_[a], balises_[b] });
+    return resultat;
+}
@@ -0,0 +1,127 @@
+#include "allocations.hpp"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <algorithm>
+
+namespace {
+    struct Compteurs {
+        std::atomic<std::uint64_t> allocations{ 0 };
+        std::atomic<std::uint64_t> octets{ 0 };
+        std::atomic<std::uint64_t> liberations{ 0 };
+    };
+
+    // Initialisés avant tout constructeur statique : operator new peut être appelé avant main
+    Compteurs compteurs[ProfilAllocations::MAX_PORTEES];
+    const char* noms[ProfilAllocations::MAX_PORTEES] = { "hors portee" };
+    std::atomic<int> nombrePortees{ 1 };
+    std::mutex mutexPortees; // Sérialise les enregistrements
+    thread_local int porteeCourante = 0;
+}
+
+#ifdef PROFIL_ALLOCATIONS
+bool ProfilAllocations::estActif() { return true; }
+#else
+bool ProfilAllocations::estActif() { return false; }
+#endif
+
+int ProfilAllocations::enregistrer(const char* nom) {
+    std::lock_guard<std::mutex> lock(mutexPortees);
+    int nombre = nombrePortees.load(std::memory_order_relaxed);
+    for (int i = 0; i < nombre; ++i) {
+        if (std::strcmp(noms[i], nom) == 0) return i; // Même nom à plusieurs endroits : une seule portée
+    }
+    if (nombre == MAX_PORTEES) return 0;
+    noms[nombre] = nom;
+    nombrePortees.store(nombre + 1, std::memory_order_release);
+    return nombre;
+}
+
+std::vector<CompteAllocations> ProfilAllocations::relever() {
+    std::vector<CompteAllocations> releve;
+    int nombre = nombrePortees.load(std::memory_order_acquire);
+    releve.reserve(static_cast<size_t>(nombre));
+    for (int i = 0; i < nombre; ++i) {
+        releve.push_back({ noms[i], compteurs[i].allocations.load(std::memory_order_relaxed), compteurs[i].octets.load(std::memory_order_relaxed),
+                           compteurs[i].liberations.load(std::memory_order_relaxed) });
+    }
+    return releve;
+}
+
+void ProfilAllocations::ecrireRapport(std::ostream& os, const std::vector<CompteAllocations>& avant, const std::vector<CompteAllocations>& apres, double pas) {
+    if (pas <= 0) return;
+    std::vector<CompteAllocations> ecarts;
+    CompteAllocations total{ "Total", 0, 0, 0 };
+    for (size_t i = 0; i < apres.size(); ++i) {
+        CompteAllocations ecart = apres[i];
+        if (i < avant.size()) {
+            ecart.allocations -= avant[i].allocations;
+            ecart.octets -= avant[i].octets;
+            ecart.liberations -= avant[i].liberations;
+        }
+        total.allocations += ecart.allocations;
+        total.octets += ecart.octets;
+        total.liberations += ecart.liberations;
+        if (ecart.allocations > 0 || ecart.liberations > 0) ecarts.push_back(ecart);
+    }
+    std::sort(ecarts.begin(), ecarts.end(), [](const CompteAllocations& a, const CompteAllocations& b) { return a.allocations > b.allocations; });
+    ecarts.push_back(total);
+
+    std::ios_base::fmtflags format = os.flags();
+    os << std::left << std::setw(22) << "Portee" << std::right << std::setw(16) << "Allocations/pas" << std::setw(14) << "Octets/pas"
+       << std::setw(16) << "Liberations/pas" << "\n" << std::fixed << std::setprecision(1);
+    for (const auto& ecart : ecarts) {
+        os << std::left << std::setw(22) << ecart.portee << std::right << std::setw(16) << ecart.allocations / pas
+           << std::setw(14) << ecart.octets / pas << std::setw(16) << ecart.liberations / pas << "\n";
+    }
+    os.flags(format);
+}
+
+ProfilAllocations::Portee::Portee(int portee) : precedente_(porteeCourante) { porteeCourante = portee; }
+ProfilAllocations::Portee::~Portee() { porteeCourante = precedente_; }
+
+#ifdef PROFIL_ALLOCATIONS
+// Remplacement des opérateurs globaux : compte puis délègue à malloc et free
+
+static void* allouer(std::size_t taille) {
+    Compteurs& c = compteurs[porteeCourante];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.octets.fetch_add(taille, std::memory_order_relaxed);
+    if (taille == 0) taille = 1;
+    while (true) {
+        if (void* p = std::malloc(taille)) return p;
+        std::new_handler gestionnaire = std::get_new_handler();
+        if (!gestionnaire) throw std::bad_alloc();
+        gestionnaire();
+    }
+}
+
+static void liberer(void* p) noexcept {
+    if (!p) return;
+    compteurs[porteeCourante].liberations.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+
+void* operator new(std::size_t taille) { return allouer(taille); }
+void* operator new[](std::size_t taille) { return allouer(taille); }
+
+void* operator new(std::size_t taille, const std::nothrow_t&) noexcept {
+    try { return allouer(taille); }
+    catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t taille, const std::nothrow_t&) noexcept {
+    try { return allouer(taille); }
+    catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { liberer(p); }
+void operator delete[](void* p) noexcept { liberer(p); }
+void operator delete(void* p, std::size_t) noexcept { liberer(p); }
+void operator delete[](void* p, std::size_t) noexcept { liberer(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { liberer(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { liberer(p); }
+#endif
\ No newline at end of file
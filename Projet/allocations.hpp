@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <ostream>
+
+// Profilage des allocations (option CMake PROFIL_ALLOCATIONS) : operator new et operator delete sont remplacés par des versions
+// qui comptent, par portée nommée. La portée courante est propre au thread ; une portée ouverte dans une autre la masque jusqu'à
+// sa fermeture (les allocations de Logs::log sont comptées dans "Logs", pas dans le contrôleur qui journalise).
+// Sans l'option, PORTEE_ALLOCATIONS ne produit aucun code et les opérateurs standard restent en place.
+
+struct CompteAllocations {
+    const char* portee;
+    std::uint64_t allocations;
+    std::uint64_t octets;
+    std::uint64_t liberations;
+};
+
+class ProfilAllocations {
+public:
+    static const int MAX_PORTEES = 32;
+
+    static bool estActif(); // Compilé avec PROFIL_ALLOCATIONS
+    static int enregistrer(const char* nom); // Indice de la portée de ce nom (chaîne littérale), créée au premier appel
+    static std::vector<CompteAllocations> relever(); // Compteurs cumulés de chaque portée, "hors portee" en premier
+    static void ecrireRapport(std::ostream& os, const std::vector<CompteAllocations>& avant, const std::vector<CompteAllocations>& apres,
+                              double pas); // Allocations, octets et libérations par pas simulé entre deux relevés
+
+    class Portee { // Rend la portée courante du thread jusqu'à la fin du bloc
+    private:
+        int precedente_;
+
+    public:
+        explicit Portee(int portee);
+        ~Portee();
+        Portee(const Portee&) = delete;
+        void operator=(const Portee&) = delete;
+    };
+};
+
+#ifdef PROFIL_ALLOCATIONS
+#define PORTEE_ALLOCATIONS(nom) \
+    static const int indicePorteeAllocations = ProfilAllocations::enregistrer(nom); \
+    ProfilAllocations::Portee porteeAllocations(indicePorteeAllocations)
+#else
+#define PORTEE_ALLOCATIONS(nom) ((void)0)
+#endif
\ No newline at end of file
@@ -0,0 +1,503 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <exception>
+#include <tuple>
+
+// Analyse en flux d'un fichier logs.json : le fichier est découpé en blocs lus par plusieurs threads, chaque bloc est résumé
+// à part puis les résumés sont fusionnés dans l'ordre du fichier. La mémoire dépend du nombre de threads et d'avions,
+// pas de la taille du fichier. Accepte aussi les anciens logs (un champ par ligne, sans Temps, Avion ni Aeroport).
+
+const double INCONNU = std::numeric_limits<double>::quiet_NaN();
+const size_t MARGE_LECTURE = 64 * 1024; // Lu après la fin du bloc pour terminer son dernier élément (agrandi si besoin)
+
+struct OptionsAnalyse {
+    std::string fichier = "img/logs.json";
+    int threads = 0; // 0 : un par coeur
+    size_t tailleBloc = 16 << 20; // Octets par bloc
+    double fenetre = 3600.0; // Fenêtre des pointes de trafic par aéroport (s simulées)
+    std::string chronologies; // CSV des jalons de chaque avion (vide : non écrit)
+    std::string avion; // Avion dont tous les événements sont affichés dans l'ordre (vide : aucun)
+};
+
+struct Evenement { // Un élément du log ; vues sur le tampon du bloc, chaînes laissées échappées
+    double temps = INCONNU;
+    std::string_view controleur, aeroport, avion, action, details;
+};
+
+struct ResumeAvion { // Jalons d'un avion, premières occurrences
+    size_t evenements = 0;
+    double premier = INCONNU, dernier = INCONNU;
+    std::string depart, arrivee;
+    double decollage = INCONNU, autorisation = INCONNU, parking = INCONNU;
+    size_t attentes = 0; // Mises en circuit d'attente
+    double urgence = INCONNU;
+    double priseEnCompte = INCONNU; // Première action d'un contrôleur après l'urgence
+    double premierControleur = INCONNU; // Première action d'un contrôleur dans le bloc : répond à une urgence d'un bloc précédent
+    bool crash = false;
+};
+
+struct ResumeAeroport {
+    std::vector<size_t> decollages, atterrissages; // Par fenêtre de temps simulé
+    size_t attentes = 0, creneaux = 0; // Mises en attente, attentes d'un créneau
+};
+
+struct HachageTexte { // Recherche par string_view dans les tables indexées par std::string, sans copie
+    using is_transparent = void;
+    size_t operator()(std::string_view texte) const { return std::hash<std::string_view>{}(texte); }
+};
+
+struct CompteAction {
+    std::string controleur, action;
+    size_t nombre;
+};
+
+struct ResumeBloc {
+    size_t evenements = 0, invalides = 0, tronques = 0;
+    double tempsMin = INCONNU, tempsMax = INCONNU;
+    std::vector<CompteAction> actions; // Une quinzaine de types : recherche linéaire
+    std::unordered_map<std::string, ResumeAvion, HachageTexte, std::equal_to<>> avions;
+    std::map<std::string, ResumeAeroport, std::less<>> aeroports;
+    std::string chronologie; // Événements de l'avion suivi, une ligne chacun
+
+    void compterAction(std::string_view controleur, std::string_view action, size_t nombre);
+    void ajouter(const Evenement& e, const OptionsAnalyse& options);
+    void fusionner(ResumeBloc&& suivant); // Ajoute le résumé du bloc qui suit dans le fichier
+};
+
+static double minimum(double a, double b) { return std::isnan(a) ? b : (std::isnan(b) ? a : std::min(a, b)); }
+static double maximum(double a, double b) { return std::isnan(a) ? b : (std::isnan(b) ? a : std::max(a, b)); }
+static void premiere(double& jalon, double temps) { if (std::isnan(jalon)) jalon = temps; }
+
+static void compter(std::vector<size_t>& cases, double temps, double fenetre) {
+    size_t i = std::isnan(temps) ? 0 : static_cast<size_t>(std::max(temps, 0.0) / fenetre);
+    if (cases.size() <= i) cases.resize(i + 1, 0);
+    ++cases[i];
+}
+
+// Nom de l'avion dans le texte des anciens logs ("Avion X", "... pour X", "... de X", "... sur X")
+static std::string_view avionDesDetails(std::string_view details) {
+    for (std::string_view repere : { "Avion ", " pour ", " de ", " sur " }) {
+        size_t p = details.find(repere);
+        if (p == std::string_view::npos) continue;
+        std::string_view reste = details.substr(p + repere.size());
+        std::string_view nom = reste.substr(0, reste.find(' '));
+        if (!nom.empty() && nom.back() == '.') nom.remove_suffix(1);
+        return nom;
+    }
+    return {};
+}
+
+void ResumeBloc::compterAction(std::string_view controleur, std::string_view action, size_t nombre) {
+    for (auto& compte : actions) {
+        if (compte.action == action && compte.controleur == controleur) {
+            compte.nombre += nombre;
+            return;
+        }
+    }
+    actions.push_back({ std::string(controleur), std::string(action), nombre });
+}
+
+void ResumeBloc::ajouter(const Evenement& e, const OptionsAnalyse& options) {
+    ++evenements;
+    compterAction(e.controleur, e.action, 1);
+    tempsMin = minimum(tempsMin, e.temps);
+    tempsMax = maximum(tempsMax, e.temps);
+
+    bool tour = e.controleur == "TWR", approche = e.controleur == "APP";
+    if (!e.aeroport.empty()) {
+        auto it = aeroports.find(e.aeroport);
+        if (it == aeroports.end()) it = aeroports.emplace(std::string(e.aeroport), ResumeAeroport()).first;
+        ResumeAeroport& aero = it->second;
+        if (tour && e.action == "Decollage") compter(aero.decollages, e.temps, options.fenetre);
+        else if (approche && e.action == "Autorisation atterrissage") compter(aero.atterrissages, e.temps, options.fenetre);
+        else if (approche && e.action == "Mise en attente") ++aero.attentes;
+        else if (approche && e.action == "Attente creneau") ++aero.creneaux;
+    }
+
+    std::string_view nom = e.avion.empty() ? avionDesDetails(e.details) : e.avion;
+    if (nom.empty()) return;
+    auto it = avions.find(nom);
+    if (it == avions.end()) it = avions.emplace(std::string(nom), ResumeAvion()).first;
+    ResumeAvion& avion = it->second;
+    ++avion.evenements;
+    avion.premier = minimum(avion.premier, e.temps);
+    avion.dernier = maximum(avion.dernier, e.temps);
+
+    if (tour || approche || e.controleur == "CCR") {
+        premiere(avion.premierControleur, e.temps);
+        if (!std::isnan(avion.urgence)) premiere(avion.priseEnCompte, e.temps); // Urgence déjà déclarée dans ce bloc
+    }
+    if (tour && e.action == "Decollage" && std::isnan(avion.decollage)) { avion.decollage = e.temps; avion.depart = e.aeroport; }
+    else if (tour && e.action == "Parking") premiere(avion.parking, e.temps);
+    else if (approche && e.action == "Autorisation atterrissage" && std::isnan(avion.autorisation)) { avion.autorisation = e.temps; avion.arrivee = e.aeroport; }
+    else if (approche && e.action == "Mise en attente") ++avion.attentes;
+    else if (e.controleur == "AVION" && e.action == "URGENCE") premiere(avion.urgence, e.temps);
+    else if (e.controleur == "AVION" && e.action == "CRASH") avion.crash = true;
+
+    if (!options.avion.empty() && nom == options.avion) {
+        char temps[32];
+        std::snprintf(temps, sizeof(temps), "%12.3f", e.temps);
+        chronologie.append(temps).append("  ").append(e.controleur).append(" ").append(e.aeroport)
+                   .append(e.aeroport.empty() ? "" : " ").append(e.action).append(" : ").append(e.details).append("\n");
+    }
+}
+
+void ResumeBloc::fusionner(ResumeBloc&& suivant) {
+    evenements += suivant.evenements;
+    invalides += suivant.invalides;
+    tronques += suivant.tronques;
+    tempsMin = minimum(tempsMin, suivant.tempsMin);
+    tempsMax = maximum(tempsMax, suivant.tempsMax);
+    for (const auto& compte : suivant.actions) compterAction(compte.controleur, compte.action, compte.nombre);
+    for (auto& [nom, s] : suivant.aeroports) {
+        ResumeAeroport& a = aeroports[nom];
+        if (a.decollages.size() < s.decollages.size()) a.decollages.resize(s.decollages.size(), 0);
+        for (size_t i = 0; i < s.decollages.size(); ++i) a.decollages[i] += s.decollages[i];
+        if (a.atterrissages.size() < s.atterrissages.size()) a.atterrissages.resize(s.atterrissages.size(), 0);
+        for (size_t i = 0; i < s.atterrissages.size(); ++i) a.atterrissages[i] += s.atterrissages[i];
+        a.attentes += s.attentes;
+        a.creneaux += s.creneaux;
+    }
+    for (auto& [nom, s] : suivant.avions) {
+        auto it = avions.find(nom);
+        if (it == avions.end()) { avions.emplace(nom, std::move(s)); continue; }
+        ResumeAvion& a = it->second;
+        // Tous les événements du bloc suivant sont postérieurs : ils répondent à une urgence encore sans réponse
+        if (!std::isnan(a.urgence)) premiere(a.priseEnCompte, s.premierControleur);
+        else if (!std::isnan(s.urgence)) { a.urgence = s.urgence; a.priseEnCompte = s.priseEnCompte; }
+        a.evenements += s.evenements;
+        a.premier = minimum(a.premier, s.premier);
+        a.dernier = maximum(a.dernier, s.dernier);
+        if (std::isnan(a.decollage) && !std::isnan(s.decollage)) { a.decollage = s.decollage; a.depart = s.depart; }
+        if (std::isnan(a.autorisation) && !std::isnan(s.autorisation)) { a.autorisation = s.autorisation; a.arrivee = s.arrivee; }
+        premiere(a.parking, s.parking);
+        premiere(a.premierControleur, s.premierControleur);
+        a.attentes += s.attentes;
+        a.crash = a.crash || s.crash;
+    }
+    chronologie += suivant.chronologie;
+}
+
+static size_t sauterBlancs(const std::string& t, size_t p) {
+    while (p < t.size() && (t[p] == ' ' || t[p] == '\t' || t[p] == '\r' || t[p] == '\n')) ++p;
+    return p;
+}
+
+// Chaîne JSON commençant au guillemet t[p] ; renvoie la position après le guillemet fermant, npos si le tampon s'arrête avant
+static size_t lireChaine(const std::string& t, size_t p, std::string_view& valeur) {
+    size_t debut = ++p;
+    while (p < t.size()) {
+        const char* guillemet = static_cast<const char*>(std::memchr(t.data() + p, '"', t.size() - p));
+        if (!guillemet) break;
+        p = static_cast<size_t>(guillemet - t.data());
+        size_t barres = 0; // Guillemet échappé si précédé d'un nombre impair de barres obliques inverses
+        while (p - barres > debut && t[p - barres - 1] == '\\') ++barres;
+        if (barres % 2 == 0) {
+            valeur = std::string_view(t.data() + debut, p - debut);
+            return p + 1;
+        }
+        ++p;
+    }
+    return std::string::npos;
+}
+
+// Élément (objet JSON plat) commençant à l'accolade t[p] ; renvoie la position après l'accolade fermante,
+// npos si le tampon s'arrête avant, exception si l'élément est mal formé
+static size_t lireElement(const std::string& t, size_t p, Evenement& e) {
+    e = Evenement();
+    ++p;
+    while (true) {
+        p = sauterBlancs(t, p);
+        if (p >= t.size()) return std::string::npos;
+        if (t[p] == '}') return p + 1;
+        if (t[p] == ',') { ++p; continue; }
+        if (t[p] != '"') throw std::runtime_error("cle attendue");
+
+        std::string_view cle;
+        p = lireChaine(t, p, cle);
+        if (p == std::string::npos) return p;
+        p = sauterBlancs(t, p);
+        if (p >= t.size()) return std::string::npos;
+        if (t[p] != ':') throw std::runtime_error("':' attendu");
+        p = sauterBlancs(t, p + 1);
+        if (p >= t.size()) return std::string::npos;
+
+        if (t[p] == '"') {
+            std::string_view valeur;
+            p = lireChaine(t, p, valeur);
+            if (p == std::string::npos) return p;
+            if (cle == "Controleur") e.controleur = valeur;
+            else if (cle == "Aeroport") e.aeroport = valeur;
+            else if (cle == "Avion") e.avion = valeur;
+            else if (cle == "Action") e.action = valeur;
+            else if (cle == "Details") e.details = valeur;
+        }
+        else {
+            size_t debut = p;
+            while (p < t.size() && t[p] != ',' && t[p] != '}' && t[p] != ' ' && t[p] != '\n' && t[p] != '\r') ++p;
+            if (p >= t.size()) return std::string::npos;
+            if (cle == "Temps") {
+                double temps = 0;
+                if (std::from_chars(t.data() + debut, t.data() + p, temps).ec != std::errc()) throw std::runtime_error("Temps invalide");
+                e.temps = temps;
+            }
+        }
+    }
+}
+
+// Résume les éléments dont la ligne commence dans [debut, fin). Le dernier peut déborder du bloc : la suite est lue au besoin.
+static ResumeBloc analyserBloc(std::ifstream& flux, std::string& tampon, std::uint64_t debut, std::uint64_t fin, std::uint64_t taille,
+                               const OptionsAnalyse& options) {
+    ResumeBloc resume;
+    std::uint64_t lecture = (debut > 0) ? debut - 1 : 0; // L'octet avant le bloc dit si sa première ligne y commence
+    auto lire = [&](size_t position, std::uint64_t octets) {
+        tampon.resize(position + static_cast<size_t>(octets));
+        flux.clear();
+        flux.seekg(static_cast<std::streamoff>(lecture + position));
+        flux.read(tampon.data() + position, static_cast<std::streamsize>(octets));
+        if (flux.gcount() != static_cast<std::streamsize>(octets)) throw std::runtime_error("Lecture incomplete de " + options.fichier);
+    };
+    lire(0, std::min(fin + MARGE_LECTURE, taille) - lecture);
+
+    size_t ligne = 0;
+    if (debut > 0) {
+        ligne = tampon.find('\n');
+        if (ligne == std::string::npos) return resume;
+        ++ligne;
+    }
+    while (lecture + ligne < fin) {
+        size_t p = ligne;
+        while (p < tampon.size() && (tampon[p] == ' ' || tampon[p] == '\t')) ++p;
+        if (p < tampon.size() && tampon[p] == '{') {
+            Evenement e;
+            try {
+                size_t finElement;
+                while ((finElement = lireElement(tampon, p, e)) == std::string::npos) {
+                    std::uint64_t lu = lecture + tampon.size();
+                    if (lu >= taille) break; // Fichier en cours d'écriture ou interrompu
+                    lire(tampon.size(), std::min<std::uint64_t>(MARGE_LECTURE, taille - lu));
+                }
+                if (finElement == std::string::npos) {
+                    ++resume.tronques;
+                    break;
+                }
+                resume.ajouter(e, options);
+                p = finElement;
+            }
+            catch (const std::runtime_error&) {
+                ++resume.invalides;
+            }
+        }
+        size_t suivante = tampon.find('\n', p);
+        if (suivante == std::string::npos) break;
+        ligne = suivante + 1;
+    }
+    return resume;
+}
+
+static OptionsAnalyse lireOptions(int argc, char* argv[]) {
+    OptionsAnalyse options;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--", 0) != 0) { options.fichier = option; continue; }
+        if (i + 1 >= argc) throw std::runtime_error("Valeur manquante pour " + option);
+        std::string valeur = argv[++i];
+        if (option == "--threads") options.threads = std::stoi(valeur);
+        else if (option == "--bloc") options.tailleBloc = static_cast<size_t>(std::stoul(valeur)) << 20;
+        else if (option == "--fenetre") options.fenetre = std::stod(valeur);
+        else if (option == "--chronologies") options.chronologies = valeur;
+        else if (option == "--avion") options.avion = valeur;
+        else throw std::runtime_error("Option inconnue : " + option);
+    }
+    if (options.threads <= 0) options.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (options.tailleBloc == 0) throw std::runtime_error("Taille de bloc invalide");
+    if (options.fenetre <= 0) throw std::runtime_error("Fenetre invalide");
+    return options;
+}
+
+static std::string formaterTemps(double temps) {
+    if (std::isnan(temps)) return "";
+    char texte[32];
+    std::snprintf(texte, sizeof(texte), "%.3f", temps);
+    return texte;
+}
+
+static void ecrireChronologies(const ResumeBloc& total, const std::string& chemin) {
+    std::ofstream fichier(chemin);
+    if (!fichier.is_open()) throw std::runtime_error("Impossible de creer " + chemin);
+    fichier << "Avion;Premier;Dernier;Depart;Decollage;Arrivee;Autorisation;Parking;Attentes;Urgence;PriseEnCompte;Crash;Evenements\n";
+    std::vector<const std::pair<const std::string, ResumeAvion>*> avions;
+    for (const auto& entree : total.avions) avions.push_back(&entree);
+    std::sort(avions.begin(), avions.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+    for (const auto* entree : avions) {
+        const std::string& nom = entree->first;
+        const ResumeAvion& a = entree->second;
+        fichier << nom << ';' << formaterTemps(a.premier) << ';' << formaterTemps(a.dernier) << ';' << a.depart << ';' << formaterTemps(a.decollage)
+                << ';' << a.arrivee << ';' << formaterTemps(a.autorisation) << ';' << formaterTemps(a.parking) << ';' << a.attentes
+                << ';' << formaterTemps(a.urgence) << ';' << formaterTemps(a.priseEnCompte) << ';' << (a.crash ? 1 : 0) << ';' << a.evenements << '\n';
+    }
+}
+
+static void afficherResultats(const ResumeBloc& total, const OptionsAnalyse& options) {
+    double duree = std::isnan(total.tempsMin) ? 0.0 : total.tempsMax - total.tempsMin;
+    if (duree > 0) std::cout << "Temps simule couvert : " << std::fixed << std::setprecision(1) << total.tempsMin << " a " << total.tempsMax << " s\n";
+    else std::cout << "Aucun horodatage (ancien format) : taux et delais indisponibles\n";
+
+    // Aéroports : mouvements, taux moyens et pointe sur une fenêtre
+    if (total.aeroports.empty()) std::cout << "\nAucun aeroport dans les logs (ancien format)\n";
+    else {
+        std::cout << "\n" << std::left << std::setw(14) << "Aeroport" << std::right << std::setw(9) << "Decoll." << std::setw(9) << "Atterr."
+                  << std::setw(11) << "Decoll./h" << std::setw(11) << "Atterr./h" << std::setw(13) << "Pointe dec." << std::setw(13) << "Pointe att."
+                  << std::setw(10) << "Attentes" << std::setw(10) << "Creneaux" << "\n";
+        for (const auto& [nom, a] : total.aeroports) {
+            size_t decollages = 0, atterrissages = 0;
+            for (size_t n : a.decollages) decollages += n;
+            for (size_t n : a.atterrissages) atterrissages += n;
+            size_t pointeDecollages = a.decollages.empty() ? 0 : *std::max_element(a.decollages.begin(), a.decollages.end());
+            size_t pointeAtterrissages = a.atterrissages.empty() ? 0 : *std::max_element(a.atterrissages.begin(), a.atterrissages.end());
+            std::cout << std::left << std::setw(14) << nom << std::right << std::setw(9) << decollages << std::setw(9) << atterrissages << std::fixed << std::setprecision(1)
+                      << std::setw(11) << (duree > 0 ? decollages * 3600.0 / duree : 0.0) << std::setw(11) << (duree > 0 ? atterrissages * 3600.0 / duree : 0.0)
+                      << std::setw(13) << pointeDecollages << std::setw(13) << pointeAtterrissages << std::setw(10) << a.attentes << std::setw(10) << a.creneaux << "\n";
+        }
+        std::cout << "(pointes : mouvements au plus sur une fenetre de " << std::setprecision(0) << options.fenetre << " s)\n";
+    }
+
+    // Urgences : délai de la première action d'un contrôleur et de l'autorisation d'atterrissage
+    size_t urgences = 0, sansReponse = 0, crashs = 0, attentes = 0, reponses = 0, autorisations = 0;
+    double sommeReponse = 0, maxReponse = 0, sommeAutorisation = 0, maxAutorisation = 0;
+    for (const auto& [nom, a] : total.avions) {
+        if (a.crash) ++crashs;
+        attentes += a.attentes;
+        if (std::isnan(a.urgence)) continue;
+        ++urgences;
+        if (std::isnan(a.priseEnCompte)) ++sansReponse;
+        else {
+            ++reponses;
+            sommeReponse += a.priseEnCompte - a.urgence;
+            maxReponse = std::max(maxReponse, a.priseEnCompte - a.urgence);
+        }
+        if (!std::isnan(a.autorisation) && a.autorisation >= a.urgence) {
+            ++autorisations;
+            sommeAutorisation += a.autorisation - a.urgence;
+            maxAutorisation = std::max(maxAutorisation, a.autorisation - a.urgence);
+        }
+    }
+    std::cout << "\nAvions : " << total.avions.size() << ", mises en attente : " << attentes << ", crashs : " << crashs << "\n";
+    std::cout << "Urgences : " << urgences << " declarees, " << sansReponse << " sans action de controleur ensuite\n" << std::setprecision(1);
+    if (reponses > 0) std::cout << "  premiere action d'un controleur : " << sommeReponse / reponses << " s en moyenne, " << maxReponse << " s au plus\n";
+    if (autorisations > 0) std::cout << "  autorisation d'atterrissage : " << sommeAutorisation / autorisations << " s en moyenne, " << maxAutorisation << " s au plus\n";
+
+    std::cout << "\nEvenements par controleur et action\n";
+    std::vector<CompteAction> actions = total.actions;
+    std::sort(actions.begin(), actions.end(), [](const CompteAction& a, const CompteAction& b) {
+        return std::tie(a.controleur, a.action) < std::tie(b.controleur, b.action);
+    });
+    for (const auto& compte : actions) {
+        std::cout << "  " << std::left << std::setw(12) << compte.controleur << std::setw(28) << compte.action << std::right << std::setw(12) << compte.nombre << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        OptionsAnalyse options = lireOptions(argc, argv);
+        std::uint64_t taille = std::filesystem::file_size(options.fichier);
+        size_t nombreBlocs = static_cast<size_t>((taille + options.tailleBloc - 1) / options.tailleBloc);
+        size_t threads = std::min<size_t>(static_cast<size_t>(options.threads), std::max<size_t>(nombreBlocs, 1));
+        std::cout << "--- ANALYSE DES LOGS ---\n";
+        std::cout << options.fichier << " : " << std::fixed << std::setprecision(1) << taille / 1048576.0 << " Mo, " << nombreBlocs << " blocs, "
+                  << threads << " threads\n";
+
+        // Les blocs sont pris dans l'ordre ; un thread n'en prend pas plus de 2 x threads d'avance sur la fusion (mémoire bornée)
+        auto debut = std::chrono::steady_clock::now();
+        std::mutex mutex;
+        std::condition_variable condition;
+        size_t prochain = 0, fusionnes = 0;
+        std::map<size_t, ResumeBloc> termines;
+        std::exception_ptr erreur;
+
+        std::vector<std::thread> lecteurs;
+        for (size_t t = 0; t < threads; ++t) {
+            lecteurs.emplace_back([&]() {
+                std::ifstream flux(options.fichier, std::ios::binary);
+                std::string tampon;
+                while (true) {
+                    size_t bloc;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        condition.wait(lock, [&]() { return erreur || prochain >= nombreBlocs || prochain < fusionnes + 2 * threads; });
+                        if (erreur || prochain >= nombreBlocs) return;
+                        bloc = prochain++;
+                    }
+                    try {
+                        if (!flux.is_open()) throw std::runtime_error("Impossible d'ouvrir " + options.fichier);
+                        std::uint64_t debutBloc = static_cast<std::uint64_t>(bloc) * options.tailleBloc;
+                        ResumeBloc resume = analyserBloc(flux, tampon, debutBloc, std::min<std::uint64_t>(debutBloc + options.tailleBloc, taille), taille, options);
+                        std::lock_guard<std::mutex> lock(mutex);
+                        termines.emplace(bloc, std::move(resume));
+                    }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!erreur) erreur = std::current_exception();
+                    }
+                    condition.notify_all();
+                }
+            });
+        }
+
+        ResumeBloc total;
+        while (fusionnes < nombreBlocs) {
+            ResumeBloc resume;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]() { return erreur || termines.count(fusionnes) > 0; });
+                if (erreur) break;
+                auto it = termines.find(fusionnes);
+                resume = std::move(it->second);
+                termines.erase(it);
+                ++fusionnes;
+            }
+            condition.notify_all();
+            total.fusionner(std::move(resume));
+        }
+        for (auto& t : lecteurs) t.join();
+        if (erreur) std::rethrow_exception(erreur);
+        double duree = std::chrono::duration<double>(std::chrono::steady_clock::now() - debut).count();
+
+        std::cout << total.evenements << " evenements en " << std::setprecision(2) << duree << " s ("
+                  << std::setprecision(0) << (duree > 0 ? taille / 1048576.0 / duree : 0.0) << " Mo/s)";
+        if (total.invalides > 0) std::cout << ", " << total.invalides << " invalides";
+        if (total.tronques > 0) std::cout << ", dernier element tronque";
+        std::cout << "\n";
+
+        afficherResultats(total, options);
+        if (!options.avion.empty()) std::cout << "\nChronologie de " << options.avion << "\n" << total.chronologie;
+        if (!options.chronologies.empty()) {
+            ecrireChronologies(total, options.chronologies);
+            std::cout << "\nJalons de " << total.avions.size() << " avions ecrits dans " << options.chronologies << "\n";
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Erreur " << e.what() << "\n";
+        return -1;
+    }
+    return 0;
+}
\ No newline at end of file
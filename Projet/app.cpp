@@ -2,42 +2,218 @@
 #include <stdexcept>
 #include <algorithm>
 
-APP::APP(TWR* tour) : twr_(tour) {
+const float RESERVE_CARBURANT_ARRIVEE = 3000.f; // Carburant minimal souhaité au moment du créneau (L)
+const float RAYON_ATTENTE_CRENEAU = 15000.f; // Rayon du circuit d'attente à l'entrée de zone (m)
+const float RAYON_ATTENTE_PISTE = 5000.f; // Rayon du circuit d'attente près de la piste après un créneau manqué (m)
+const auto MARGE_CRENEAU = std::chrono::milliseconds(500); // Un cycle APP : tolérance sur l'heure d'arrivée au seuil
+
+bool APP::EntreeSequence::operator<(const EntreeSequence& autre) const {
+    if (priorite != autre.priorite) return priorite < autre.priorite;
+    if (heureEstimee != autre.heureEstimee) return heureEstimee < autre.heureEstimee;
+    return ordre < autre.ordre;
+}
+
+APP::APP(TWR* tour) : compteurSequence_(0), twr_(tour), nombreDansZone_(0), nombreEnAttente_(0) {
     if (!tour) throw std::invalid_argument("pointeur TWR NULL");
 }
 
-size_t APP::getNombreAvionsDansZone() const { return avionsDansZone_.size(); }
-size_t APP::getNombreAvionsEnAttente() const { return fileAttenteAtterrissage_.size(); }
+std::vector<Position> APP::trajectoireApproche(size_t indexPiste) const {
+    Position pos = twr_->getPositionPiste(indexPiste); // Récupération de la position de la piste
+    double x = pos.getX();
+    double y = pos.getY();
+
+    // Définition des points de passage pour l'approche finale
+    return {
+        {x, y + 20000.0, 4000.0},
+        {x, y + 10000.0, 2000.0},
+        {x, y + 3000.0, 1000.0},
+        {x, y + 1000.0, 500.0}
+    };
+}
+
+std::vector<Position> APP::circuitAttente(Position centre, float rayon, double altitude, int pasAngle) const {
+    std::vector<Position> cercle;
+    for (int i = 0; i < 5; ++i) {
+        for (int angle = 0; angle < 360; angle += pasAngle) {
+            // Cast explicite pour éviter le warning
+            float rad = static_cast<float>(angle * (3.14159265359 / 180.0));
+            cercle.push_back({
+                centre.getX() + rayon * std::cos(rad),
+                centre.getY() + rayon * std::sin(rad),
+                altitude
+            });
+        }
+    }
+    return cercle;
+}
+
+std::chrono::milliseconds APP::tempsVersSeuil(Avion* avion, size_t indexPiste, PhaseArrivee phase) const {
+    Position pos = avion->getPosition();
+    Position seuil = twr_->getPositionPiste(indexPiste);
+    double distance = 0.0;
+
+    if (phase == PhaseArrivee::APPROCHE) {
+        // Reste de la trajectoire en cours, puis le seuil
+        std::vector<Position> traj = avion->getTrajectoire();
+        for (const auto& point : traj) {
+            distance += pos.distance(point);
+            pos = point;
+        }
+        distance += pos.distance(seuil);
+    }
+    else if (phase == PhaseArrivee::ATTENTE_CRENEAU) {
+        // Rejoint le début de l'approche puis la parcourt en entier
+        std::vector<Position> approche = trajectoireApproche(indexPiste);
+        distance = pos.distance(approche.front());
+        for (size_t i = 1; i < approche.size(); ++i) distance += approche[i - 1].distance(approche[i]);
+        distance += approche.back().distance(seuil);
+    }
+    else {
+        distance = pos.distance(seuil); // Autorisé depuis le circuit d'attente : trajectoire directe
+    }
+
+    float vitesse = std::max(avion->getVitesse(), 1.f); // Distance parcourue par pas de simulation
+    return std::chrono::milliseconds(static_cast<long long>(distance / vitesse * PAS_AVION_MS));
+}
+
+PrioriteArrivee APP::evaluerPriorite(Avion* avion, std::chrono::steady_clock::time_point creneau) const {
+    if (avion->estEnUrgence()) return PrioriteArrivee::URGENCE;
+
+    // Carburant restant à l'heure du créneau, au rythme de consommation actuel
+    auto attente = std::max(creneau - Horloge::getHorloge().maintenant(), std::chrono::steady_clock::duration::zero());
+    float pas = static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(attente).count()) / PAS_AVION_MS;
+    if (avion->getCarburant() - avion->getConsommation() * pas < RESERVE_CARBURANT_ARRIVEE) return PrioriteArrivee::CARBURANT_BAS;
+    return PrioriteArrivee::NORMALE;
+}
+
+void APP::changerPriorite(Avion* avion, PrioriteArrivee priorite) {
+    auto it = arrivees_.find(avion);
+    if (it == arrivees_.end() || it->second.entree->priorite == priorite) return;
+
+    // Les clés d'un std::set sont constantes : on extrait l'entrée et on la réinsère à sa nouvelle place
+    auto noeud = sequence_.extract(it->second.entree);
+    noeud.value().priorite = priorite;
+    it->second.entree = sequence_.insert(std::move(noeud)).position;
+    Logs::getLogs().log("APP", "Sequence", "Priorite relevee pour " + avion->getNom(), avion->getNom(), twr_->getAeroport());
+}
+
+void APP::retirerDeSequence(Avion* avion) {
+    auto it = arrivees_.find(avion);
+    if (it == arrivees_.end()) return;
+    sequence_.erase(it->second.entree);
+    arrivees_.erase(it);
+}
+
+void APP::sequencer() {
+    std::vector<Piste> pistes = twr_->getPistes();
+    auto maintenant = Horloge::getHorloge().maintenant();
+
+    // Prochain instant libre de chaque piste d'arrivée (une piste encore occupée se dégage au mieux au cycle suivant)
+    std::vector<std::chrono::steady_clock::time_point> prochainLibre(pistes.size());
+    std::vector<bool> alternance(pistes.size()); // Piste mixte avec un décollage en attente : un créneau sur deux lui revient
+    for (size_t i = 0; i < pistes.size(); ++i) {
+        prochainLibre[i] = std::max(pistes[i].estLibre() ? maintenant : maintenant + MARGE_CRENEAU, pistes[i].getLiberationEstimee());
+        alternance[i] = pistes[i].getMode() == ModePiste::MIXTE && twr_->estDecollageEnAttente(i);
+        if (alternance[i] && pistes[i].getTour() == Tour::DECOLLAGE) prochainLibre[i] += pistes[i].getOccupationEstimee();
+    }
+
+    // Attribution des créneaux dans l'ordre de la séquence
+    std::vector<std::pair<Avion*, PrioriteArrivee>> promotions;
+    for (const auto& entree : sequence_) {
+        Arrivee& arrivee = arrivees_.at(entree.avion);
+
+        if (!arrivee.pisteFixee) {
+            // Piste qui offre le créneau le plus tôt
+            auto meilleurCreneau = std::chrono::steady_clock::time_point::max();
+            for (size_t i = 0; i < pistes.size(); ++i) {
+                if (!pistes[i].accepteArrivees()) continue;
+                auto creneau = std::max(maintenant + tempsVersSeuil(entree.avion, i, arrivee.phase), prochainLibre[i]);
+                if (creneau < meilleurCreneau) {
+                    meilleurCreneau = creneau;
+                    arrivee.piste = i;
+                }
+            }
+            if (meilleurCreneau == std::chrono::steady_clock::time_point::max()) throw std::logic_error("Aucune piste d'atterrissage");
+        }
+
+        size_t piste = arrivee.piste;
+        arrivee.creneau = std::max(maintenant + tempsVersSeuil(entree.avion, piste, arrivee.phase), prochainLibre[piste]);
+        // Espacement selon l'occupation réellement observée (dégagement compris), plus un cycle de marge
+        prochainLibre[piste] = arrivee.creneau + pistes[piste].getOccupationEstimee() * (alternance[piste] ? 2 : 1) + MARGE_CRENEAU;
+
+        // Une priorité ne fait que monter (urgence déclarée ou carburant insuffisant pour tenir le créneau)
+        PrioriteArrivee priorite = evaluerPriorite(entree.avion, arrivee.creneau);
+        if (priorite < entree.priorite) promotions.push_back({ entree.avion, priorite });
+    }
+
+    if (!promotions.empty()) {
+        for (const auto& [avion, priorite] : promotions) changerPriorite(avion, priorite);
+        sequencer(); // Les avions promus passent devant : nouveaux créneaux
+    }
+}
+
+void APP::lancerApproche(Avion* avion) {
+    Arrivee& arrivee = arrivees_.at(avion);
+    arrivee.phase = PhaseArrivee::APPROCHE;
+    avion->setTrajectoire(trajectoireApproche(arrivee.piste)); // Assignation de la trajectoire
+    avion->setEtat(EtatAvion::EN_APPROCHE); // Mise à jour de l'état
+    std::cout << "[APP] Trajectoire d'approche transmise a " << avion->getNom() << ".\n";
+}
+
+size_t APP::getNombreAvionsDansZone() const { return nombreDansZone_; }
+
+size_t APP::getNombreAvionsEnAttente() const { return nombreEnAttente_; }
+
+void APP::publierCompteurs() {
+    size_t n = 0;
+    for (const auto& [avion, arrivee] : arrivees_) {
+        if (arrivee.phase != PhaseArrivee::APPROCHE) n++;
+    }
+    nombreEnAttente_ = n;
+    nombreDansZone_ = avionsDansZone_.size();
+}
 
 void APP::ajouterAvion(Avion* avion) {
     std::lock_guard<std::recursive_mutex> lock(mutexAPP_);
     if (!avion) throw std::invalid_argument("Avion NULL");
     if (std::find(avionsDansZone_.begin(), avionsDansZone_.end(), avion) == avionsDansZone_.end()) { // Si l'avion n'est pas dans la zone APP
         avionsDansZone_.push_back(avion); // On l'ajoute dans la zone
+
+        // Insertion dans la séquence, rang provisoire selon l'heure estimée au seuil de la piste courante
+        size_t piste = std::min(avion->getPiste(), twr_->getNombrePistes() - 1);
+        auto heureEstimee = Horloge::getHorloge().maintenant() + tempsVersSeuil(avion, piste, PhaseArrivee::ATTENTE_CRENEAU);
+        PrioriteArrivee priorite = avion->estEnUrgence() ? PrioriteArrivee::URGENCE : PrioriteArrivee::NORMALE;
+        auto entree = sequence_.insert({ priorite, heureEstimee, compteurSequence_++, avion }).first;
+        arrivees_[avion] = { entree, piste, false, heureEstimee, PhaseArrivee::ATTENTE_CRENEAU, false };
+
         std::cout << "[APP] " << avion->getNom() << " entre dans la zone d'approche.\n";
     }
-    Logs::getLogs().log("APP", "Prise en charge", "Avion " + avion->getNom());
+    Logs::getLogs().log("APP", "Prise en charge", "Avion " + avion->getNom(), avion->getNom(), twr_->getAeroport());
 }
 
 void APP::assignerTrajectoireApproche(Avion* avion) {
     std::lock_guard<std::recursive_mutex> lock(mutexAPP_);
     if (!avion) throw std::invalid_argument("Avion NULL");
     if (!twr_) throw std::runtime_error("TWR NULL");
+    if (arrivees_.find(avion) == arrivees_.end()) throw std::logic_error("Avion absent de la sequence d'arrivee");
 
-    Position pos = twr_->getPositionPiste(); // Récupération de la position de la piste
-    double x = pos.getX(); 
-    double y = pos.getY();
+    sequencer(); // Créneau et piste selon les avions déjà séquencés
+    Arrivee& arrivee = arrivees_.at(avion);
+    arrivee.pisteFixee = true;
+    avion->setPiste(arrivee.piste);
 
-    // Définition des points de passage pour l'approche finale
-    std::vector<Position> traj = {
-        {x, y + 20000.0, 4000.0}, 
-        {x, y + 10000.0, 2000.0}, 
-        {x, y + 3000.0, 1000.0}, 
-        {x, y + 1000.0, 500.0}
-    };
-    avion->setTrajectoire(traj); // Assignation de la trajectoire
-    avion->setEtat(EtatAvion::EN_APPROCHE); // Mise à jour de l'état
-    std::cout << "[APP] Trajectoire d'approche transmise a " << avion->getNom() << ".\n";
+    // Retard absorbé à l'entrée de zone plutôt qu'en bout d'approche
+    auto heureEstimee = Horloge::getHorloge().maintenant() + tempsVersSeuil(avion, arrivee.piste, PhaseArrivee::ATTENTE_CRENEAU);
+    if (arrivee.creneau > heureEstimee + MARGE_CRENEAU) {
+        Position entreeApproche = trajectoireApproche(arrivee.piste).front();
+        avion->setTrajectoire(circuitAttente(entreeApproche, RAYON_ATTENTE_CRENEAU, entreeApproche.getAltitude(), 20));
+        avion->setEtat(EtatAvion::EN_ATTENTE_ATTERRISSAGE);
+        auto retard = std::chrono::duration_cast<std::chrono::milliseconds>(arrivee.creneau - heureEstimee);
+        std::cout << "[APP] " << avion->getNom() << " attend son creneau (" << retard.count() / 1000.0 << " s).\n";
+        Logs::getLogs().log("APP", "Attente creneau", "Avion " + avion->getNom(), avion->getNom(), twr_->getAeroport());
+        return;
+    }
+    lancerApproche(avion);
 }
 
 void APP::mettreEnAttente(Avion* avion) {
@@ -46,98 +222,156 @@ void APP::mettreEnAttente(Avion* avion) {
 
     bool deja = (avion->getEtat() == EtatAvion::EN_ATTENTE_ATTERRISSAGE);
     avion->setEtat(EtatAvion::EN_ATTENTE_ATTERRISSAGE); // Changement d'état vers attente
-    
+
+    auto it = arrivees_.find(avion);
+    if (it != arrivees_.end()) it->second.phase = PhaseArrivee::ATTENTE_PISTE; // Créneau manqué, repris au prochain séquencement
+
     if (!deja) { // Si l'avion n'était pas déjà en attente
-        fileAttenteAtterrissage_.push(avion); // Ajout à la file d'attente
         std::cout << "[APP] " << avion->getNom() << " entre en circuit d'attente.\n";
-        Logs::getLogs().log("APP", "Mise en attente", "Avion " + avion->getNom());
+        Logs::getLogs().log("APP", "Mise en attente", "Avion " + avion->getNom(), avion->getNom(), twr_->getAeroport());
     }
 
-    // Création d'une trajectoire circulaire pour l'attente
-    std::vector<Position> cercle;
+    // Création d'une trajectoire circulaire pour l'attente, près de la piste : l'avion n'a manqué son créneau que de peu
     if (twr_) {
-        Position centre = twr_->getPositionPiste();
-        float rayon = avion->getDestination()->rayonControle;
-        for (int i = 0; i < 5; ++i) {
-            for (int angle = 0; angle < 360; angle += 10) {
-                // Cast explicite pour éviter le warning
-                float rad = static_cast<float>(angle * (3.14159265359 / 180.0));
-                cercle.push_back({
-                    centre.getX() + rayon * std::cos(rad), 
-                    centre.getY() + rayon * std::sin(rad), 
-                    2000.0
-                });
-            }
-        }
-        avion->setTrajectoire(cercle);
+        Position centre = twr_->getPositionPiste(avion->getPiste());
+        float rayon = std::min(avion->getDestination()->rayonControle, RAYON_ATTENTE_PISTE);
+        avion->setTrajectoire(circuitAttente(centre, rayon, 2000.0, 20));
     }
 }
 
-bool APP::demanderAutorisationAtterrissage(Avion* avion) {
-    std::lock_guard<std::recursive_mutex> lock(mutexAPP_);
-    if (!avion || !twr_) return false;
+void APP::demanderAtterrissage(Avion* avion) {
+    auto it = arrivees_.find(avion);
+    if (it == arrivees_.end() || it->second.demandeEnCours) return;
+    it->second.demandeEnCours = true;
+    twr_->demanderAtterrissage(avion, this); // La tour répond dans notre boîte, l'APP ne prend pas son verrou
+}
 
-    if (twr_->autoriserAtterrissage(avion)) { // Demande d'autorisation à la tour
-        Position p = twr_->getPositionPiste();
-        avion->setTrajectoire({{p.getX() + 1500.0, p.getY(), 0.0}}); // Trajectoire finale vers la piste
+void APP::traiterReponse(Avion* avion, bool accord) {
+    auto it = arrivees_.find(avion);
+    if (it == arrivees_.end()) return;
+    it->second.demandeEnCours = false;
 
-        // Retrait de la liste des avions en zone d'approche car il passe à la tour
-        auto it = std::find(avionsDansZone_.begin(), avionsDansZone_.end(), avion);
-        if (it != avionsDansZone_.end()) {
-            avionsDansZone_.erase(it);
+    if (accord) {
+        // La tour a transmis la trajectoire finale : l'avion quitte la zone d'approche
+        auto itZone = std::find(avionsDansZone_.begin(), avionsDansZone_.end(), avion);
+        if (itZone != avionsDansZone_.end()) {
+            avionsDansZone_.erase(itZone);
         }
-
-        Logs::getLogs().log("APP", "Autorisation atterrissage", "Autorisation pour " + avion->getNom());
-        return true;
+        retirerDeSequence(avion);
+        Logs::getLogs().log("APP", "Autorisation atterrissage", "Autorisation pour " + avion->getNom(), avion->getNom(), twr_->getAeroport());
+        return;
     }
-    return false;
+
+    if (it->second.phase == PhaseArrivee::APPROCHE) mettreEnAttente(avion); // Bout d'approche sans piste : circuit d'attente
+    else if (it->second.entree->priorite == PrioriteArrivee::URGENCE && !twr_->estUrgenceEnCours()) gererUrgence(avion);
 }
 
-void APP::mettreAJour() {
+void APP::traiterMessages() {
     std::lock_guard<std::recursive_mutex> lock(mutexAPP_);
-    
     if (!twr_) return;
 
-    twr_->setDemandeAtterrissage(!fileAttenteAtterrissage_.empty()); // Informe la tour si des avions attendent
+    for (const auto& message : boite_.relever()) {
+        Avion* avion = message.avion;
+        switch (message.type) {
+            case TypeMessageAPP::TRANSFERT:
+                ajouterAvion(avion);
+                avion->setEtat(EtatAvion::EN_APPROCHE);
+                // Gestion immédiate si urgence, sinon procédure standard
+                if (avion->estEnUrgence()) gererUrgence(avion);
+                else assignerTrajectoireApproche(avion);
+                break;
 
-    // Gestion prioritaire des urgences en attente
-    for (Avion* avion : avionsDansZone_) {
-        if (avion->estEnUrgence() && avion->getEtat() == EtatAvion::EN_ATTENTE_ATTERRISSAGE) {
-            if (demanderAutorisationAtterrissage(avion)) {
-                std::cout << "[APP] Urgence - Priorite d'atterrisage a " << avion->getNom() << ".\n";
-                return;
+            case TypeMessageAPP::URGENCE: {
+                auto it = arrivees_.find(avion);
+                if (it == arrivees_.end()) break; // Déjà transmis à la tour
+                changerPriorite(avion, PrioriteArrivee::URGENCE);
+                if (it->second.demandeEnCours) break; // Réponse de la tour attendue : un refus relancera l'urgence
+                // En approche, l'avion poursuit : il passera en tête à sa demande d'atterrissage
+                if (it->second.phase != PhaseArrivee::APPROCHE && !twr_->estUrgenceEnCours()) gererUrgence(avion);
+                break;
             }
+
+            case TypeMessageAPP::FIN_APPROCHE: {
+                auto it = arrivees_.find(avion);
+                if (it != arrivees_.end() && it->second.phase == PhaseArrivee::APPROCHE) demanderAtterrissage(avion);
+                break;
+            }
+
+            case TypeMessageAPP::ATTERRISSAGE_AUTORISE:
+            case TypeMessageAPP::ATTERRISSAGE_REFUSE:
+                traiterReponse(avion, message.type == TypeMessageAPP::ATTERRISSAGE_AUTORISE);
+                break;
         }
     }
+    publierCompteurs();
+}
 
-    // Gestion de la file d'attente standard
-    if (!fileAttenteAtterrissage_.empty()) {
-        Avion* avion = fileAttenteAtterrissage_.front();
-        if (avion->getEtat() != EtatAvion::EN_ATTENTE_ATTERRISSAGE) { // Nettoyage si l'avion n'est plus en attente
-            fileAttenteAtterrissage_.pop();
-            return;
-        }
-        
-        // Si la tour est disponible et pas d'urgence en cours, on tente l'atterrissage
-        if (twr_ && !twr_->estUrgenceEnCours()) {
-            if (demanderAutorisationAtterrissage(avion)) {
-                fileAttenteAtterrissage_.pop();
-                std::cout << "[APP] " << avion->getNom() << " atterrissage en cours.\n";
-            }
+void APP::mettreAJour() {
+    std::lock_guard<std::recursive_mutex> lock(mutexAPP_);
+
+    if (!twr_) return;
+    traiterMessages();
+
+    // Nettoyage des avions disparus en vol (panne sèche)
+    for (auto it = avionsDansZone_.begin(); it != avionsDansZone_.end();) {
+        if ((*it)->getEtat() == EtatAvion::TERMINE) {
+            retirerDeSequence(*it);
+            it = avionsDansZone_.erase(it);
+        } else {
+            ++it;
         }
     }
 
-    // Surveillance des nouvelles urgences dans la zone
-    for (Avion* avion : avionsDansZone_) {
-        if (avion->estEnUrgence() && twr_ && !twr_->estUrgenceEnCours()) {
-            if (avion->getEtat() != EtatAvion::ATTERRISSAGE && avion->getEtat() != EtatAvion::EN_APPROCHE) {
-                gererUrgence(avion);
+    sequencer();
+
+    // Copie de l'ordre : une autorisation retire l'avion de la séquence
+    std::vector<Avion*> ordre;
+    ordre.reserve(sequence_.size());
+    for (const auto& entree : sequence_) ordre.push_back(entree.avion);
+
+    std::vector<Piste> pistes = twr_->getPistes();
+    auto maintenant = Horloge::getHorloge().maintenant();
+    bool atterrissageImminent = false;
+
+    for (Avion* avion : ordre) {
+        auto it = arrivees_.find(avion);
+        if (it == arrivees_.end()) continue;
+        Arrivee& arrivee = it->second;
+        bool urgence = (arrivee.entree->priorite == PrioriteArrivee::URGENCE);
+
+        // Un décollage lancé maintenant occuperait encore la piste au moment du créneau
+        if (arrivee.creneau <= maintenant + pistes[arrivee.piste].getOccupationEstimee()) atterrissageImminent = true;
+        if (arrivee.demandeEnCours) continue; // La tour n'a pas encore répondu
+
+        if (arrivee.phase == PhaseArrivee::ATTENTE_CRENEAU) {
+            if (urgence) {
+                if (!twr_->estUrgenceEnCours()) gererUrgence(avion);
+            }
+            else if (arrivee.creneau <= maintenant + tempsVersSeuil(avion, arrivee.piste, arrivee.phase)) {
+                lancerApproche(avion); // Libération : l'avion atteindra le seuil à son créneau
+            }
+            else if (avion->trajectoireTerminee()) {
+                Position entreeApproche = trajectoireApproche(arrivee.piste).front();
+                avion->setTrajectoire(circuitAttente(entreeApproche, RAYON_ATTENTE_CRENEAU, entreeApproche.getAltitude(), 20));
             }
         }
+        else if (arrivee.phase == PhaseArrivee::ATTENTE_PISTE) {
+            // Seul l'avion dont c'est le créneau demande la piste, pour ne pas doubler la séquence
+            bool creneauAtteint = arrivee.creneau <= maintenant + tempsVersSeuil(avion, arrivee.piste, arrivee.phase) + MARGE_CRENEAU;
+            if (urgence || (creneauAtteint && !twr_->estUrgenceEnCours())) {
+                std::cout << "[APP] " << (urgence ? "Urgence - Demande prioritaire pour " : "Demande d'atterrissage pour ") << avion->getNom() << ".\n";
+                demanderAtterrissage(avion); // En cas de refus, l'avion reste en attente (voir traiterReponse)
+            }
+            if (!arrivee.demandeEnCours && avion->trajectoireTerminee()) mettreEnAttente(avion); // Sinon la tour a pu déjà transmettre la trajectoire finale
+        }
     }
+
+    twr_->setDemandeAtterrissage(atterrissageImminent); // Informe la tour qu'un créneau d'arrivée approche
+    publierCompteurs();
 }
 
 void APP::gererUrgence(Avion* avion) {
+    std::lock_guard<std::recursive_mutex> lock(mutexAPP_);
     if (!avion) {
         std::cerr << "Avion NULL\n";
         return;
@@ -150,8 +384,58 @@ void APP::gererUrgence(Avion* avion) {
     twr_->setUrgenceEnCours(true); // Déclenche le mode urgence de la tour
     std::cout << "[APP] Urgence pour " << avion->getNom() << ". Priorite absolue.\n";
 
-    Position pos = twr_->getPositionPiste();
+    changerPriorite(avion, PrioriteArrivee::URGENCE);
+    sequencer(); // Tête de séquence : piste disponible le plus tôt
+    auto it = arrivees_.find(avion);
+    size_t piste = (it != arrivees_.end()) ? it->second.piste : avion->getPiste();
+    if (it != arrivees_.end()) {
+        it->second.pisteFixee = true;
+        it->second.phase = PhaseArrivee::APPROCHE;
+    }
+
+    avion->setPiste(piste);
+    Position pos = twr_->getPositionPiste(piste);
     avion->setTrajectoire({{pos.getX(), pos.getY(), 1000.0}, pos}); // Trajectoire directe vers la piste
     avion->setEtat(EtatAvion::EN_APPROCHE);
     std::cout << "[APP] Trajectoire directe d'urgence transmise.\n";
 }
+
+void APP::capturer(std::vector<Avion*>& avionsDansZone, std::vector<ArriveeSauvegardee>& sequence) const {
+    std::lock_guard<std::recursive_mutex> lock(mutexAPP_);
+    avionsDansZone = avionsDansZone_;
+    sequence.clear();
+    for (const auto& entree : sequence_) {
+        const Arrivee& arrivee = arrivees_.at(entree.avion);
+        sequence.push_back({ entree.avion, entree.priorite, entree.heureEstimee, entree.ordre, arrivee.piste, arrivee.pisteFixee, arrivee.creneau, arrivee.phase });
+    }
+}
+
+void APP::restaurer(const std::vector<Avion*>& avionsDansZone, const std::vector<ArriveeSauvegardee>& sequence) {
+    std::lock_guard<std::recursive_mutex> lock(mutexAPP_);
+    avionsDansZone_ = avionsDansZone;
+    sequence_.clear();
+    arrivees_.clear();
+    compteurSequence_ = 0;
+    for (const auto& a : sequence) {
+        if (!a.avion) throw std::invalid_argument("Avion NULL");
+        if (a.piste >= twr_->getNombrePistes()) throw std::out_of_range("Piste inexistante");
+        auto entree = sequence_.insert({ a.priorite, a.heureEstimee, a.ordre, a.avion }).first;
+        // Les demandes envoyées à la tour ne sont pas sauvegardées : la prochaine mise à jour les renvoie
+        arrivees_[a.avion] = { entree, a.piste, a.pisteFixee, a.creneau, a.phase, false };
+        compteurSequence_ = std::max(compteurSequence_, a.ordre + 1);
+    }
+    publierCompteurs();
+}
+
+void APP::deposerTransfert(Avion* avion) {
+    if (!avion) throw std::invalid_argument("Avion NULL");
+    boite_.deposer({ TypeMessageAPP::TRANSFERT, avion });
+}
+
+void APP::signalerUrgence(Avion* avion) { boite_.deposer({ TypeMessageAPP::URGENCE, avion }); }
+
+void APP::signalerFinApproche(Avion* avion) { boite_.deposer({ TypeMessageAPP::FIN_APPROCHE, avion }); }
+
+void APP::recevoirReponseAtterrissage(Avion* avion, bool accord) {
+    boite_.deposer({ accord ? TypeMessageAPP::ATTERRISSAGE_AUTORISE : TypeMessageAPP::ATTERRISSAGE_REFUSE, avion });
+}
\ No newline at end of file
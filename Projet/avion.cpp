@@ -1,65 +1,205 @@
 ﻿#include "avion.hpp"
 #include <stdexcept>
+#include <algorithm>
+#include <iterator>
+
+// Libellés dans l'ordre de EtatAvion, vérifié à la compilation
+struct LibelleEtat { EtatAvion etat; const char* nom; };
+static constexpr LibelleEtat LIBELLES_ETATS[] = {
+    { EtatAvion::STATIONNE, "Stationne" },
+    { EtatAvion::ROULE_VERS_PISTE, "Roule vers Piste" },
+    { EtatAvion::EN_ATTENTE_DECOLLAGE, "Attente Decollage" },
+    { EtatAvion::EN_ATTENTE_PISTE, "Seuil Piste" },
+    { EtatAvion::DECOLLAGE, "Decollage" },
+    { EtatAvion::EN_ROUTE, "En Croisiere" },
+    { EtatAvion::EN_APPROCHE, "Approche" },
+    { EtatAvion::EN_ATTENTE_ATTERRISSAGE, "Circuit Attente" },
+    { EtatAvion::ATTERRISSAGE, "Atterrissage" },
+    { EtatAvion::ROULE_VERS_PARKING, "Roule vers Parking" },
+    { EtatAvion::TERMINE, "Termine" }
+};
+
+static constexpr bool libellesDansLOrdre() {
+    for (size_t i = 0; i < std::size(LIBELLES_ETATS); ++i) {
+        if (static_cast<size_t>(LIBELLES_ETATS[i].etat) != i) return false;
+    }
+    return std::size(LIBELLES_ETATS) == NOMBRE_ETATS_AVION;
+}
+static_assert(libellesDansLOrdre(), "Un libelle par etat, dans l'ordre de EtatAvion");
+
+const char* nomEtat(EtatAvion etat) {
+    size_t e = static_cast<size_t>(etat);
+    return e < NOMBRE_ETATS_AVION ? LIBELLES_ETATS[e].nom : "Inconnu";
+}
 
 Avion::Avion(std::string n, float v, float vSol, float c, float conso, float dureeStat, Position pos)
     : nom_(n), vitesse_(v), vitesseSol_(vSol), carburant_(c), conso_(conso),
     dureeStationnement_(dureeStat), pos_(pos), etat_(EtatAvion::STATIONNE),
-    parking_(nullptr), destination_(nullptr), typeUrgence_(TypeUrgence::AUCUNE) {
+    parking_(nullptr), destination_(nullptr), piste_(0), typeUrgence_(TypeUrgence::AUCUNE),
+    trajectoire_(std::make_shared<const std::vector<Position>>()), prochainPoint_(0),
+    croisiereAnalytique_(false), longueurCroisiere_(0), atteintPointCroisiere_(false), carburantCroisiere_(0), pasCroisiere_(0), vitesseCroisiere_(v) {
     
     if (v <= 0 || vSol <= 0) throw std::invalid_argument("Vitesse avion invalide (<= 0)");
     if (c < 0) throw std::invalid_argument("Carburant initial negatif");
     if (conso < 0) throw std::invalid_argument("Consommation negative");
+    publier(true);
+}
+
+// Pas équivalents écoulés depuis le début de la croisière analytique, bornés à la fin du segment
+static float pasEcoules(std::chrono::steady_clock::time_point debut, double longueur, float vitesse, std::chrono::steady_clock::time_point maintenant) {
+    float ecoule = std::chrono::duration<float, std::milli>(maintenant - debut).count();
+    return std::min(ecoule / PAS_AVION_MS, static_cast<float>(longueur / vitesse));
+}
+
+void Avion::publier(bool saut) {
+    auto maintenant = Horloge::getHorloge().maintenant();
+    EtatPublie precedent = publie_.lire(); // Seul écrivain (verrou pris) : lecture sans conflit
+    EtatPublie e;
+    e.instantane.position = pos_;
+    if (saut) {
+        e.instantane.positionPrecedente = pos_;
+        e.instantane.horodatage = e.instantane.horodatagePrecedent = maintenant;
+    }
+    else if (!(precedent.instantane.position == pos_)) {
+        // L'avion a bougé : l'ancienne position devient le point de départ de l'interpolation
+        e.instantane.positionPrecedente = precedent.instantane.position;
+        e.instantane.horodatagePrecedent = precedent.instantane.horodatage;
+        e.instantane.horodatage = maintenant;
+    }
+    else {
+        e.instantane.positionPrecedente = precedent.instantane.positionPrecedente;
+        e.instantane.horodatagePrecedent = precedent.instantane.horodatagePrecedent;
+        e.instantane.horodatage = precedent.instantane.horodatage;
+    }
+    e.instantane.etat = etat_;
+    e.instantane.carburant = carburant_;
+    e.instantane.typeUrgence = typeUrgence_;
+    e.instantane.destination = destination_;
+    e.instantane.parking = parking_;
+    e.instantane.piste = piste_;
+    e.instantane.trajectoireTerminee = finTrajectoire();
+    e.instantane.prochainPoint = finTrajectoire() ? pos_ : (*trajectoire_)[prochainPoint_];
+    e.croisiereAnalytique = croisiereAnalytique_;
+    e.debutCroisiere = debutCroisiere_;
+    e.directionCroisiere = directionCroisiere_;
+    e.longueurCroisiere = longueurCroisiere_;
+    e.tempsCroisiere = tempsCroisiere_;
+    e.carburantCroisiere = carburantCroisiere_;
+    e.vitesseCroisiere = vitesseCroisiere_;
+    publie_.ecrire(e);
+}
+
+InstantaneAvion Avion::getInstantane() const {
+    EtatPublie e = publie_.lire();
+    if (e.croisiereAnalytique) {
+        // Position linéaire en fonction du temps sur le segment, et celle d'un pas plus tôt pour l'interpolation
+        auto maintenant = Horloge::getHorloge().maintenant();
+        auto avant = maintenant - std::chrono::milliseconds(PAS_AVION_MS);
+        float pas = pasEcoules(e.tempsCroisiere, e.longueurCroisiere, e.vitesseCroisiere, maintenant);
+        float pasAvant = std::max(0.f, pasEcoules(e.tempsCroisiere, e.longueurCroisiere, e.vitesseCroisiere, avant));
+        e.instantane.position = e.debutCroisiere + e.directionCroisiere * (e.vitesseCroisiere * pas);
+        e.instantane.positionPrecedente = e.debutCroisiere + e.directionCroisiere * (e.vitesseCroisiere * pasAvant);
+        e.instantane.horodatage = maintenant;
+        e.instantane.horodatagePrecedent = avant;
+        e.instantane.carburant = e.carburantCroisiere - conso_ * pas;
+    }
+    return e.instantane;
+}
+
+Position InstantaneAvion::interpoler(std::chrono::steady_clock::time_point instant) const {
+    if (horodatage <= horodatagePrecedent || instant >= horodatage) return position;
+    if (instant <= horodatagePrecedent) return positionPrecedente;
+    double t = std::chrono::duration<double>(instant - horodatagePrecedent) / (horodatage - horodatagePrecedent);
+    return positionPrecedente + (position - positionPrecedente) * t;
 }
 
 std::string Avion::getNom() const { return nom_; }
-float Avion::getVitesse() const { std::lock_guard<std::mutex> lock(mtx_); return vitesse_; }
-float Avion::getVitesseSol() const { std::lock_guard<std::mutex> lock(mtx_); return vitesseSol_; }
-float Avion::getCarburant() const { std::lock_guard<std::mutex> lock(mtx_); return carburant_; }
-float Avion::getConsommation() const { std::lock_guard<std::mutex> lock(mtx_); return conso_; }
-Position Avion::getPosition() const { std::lock_guard<std::mutex> lock(mtx_); return pos_; }
-EtatAvion Avion::getEtat() const { std::lock_guard<std::mutex> lock(mtx_); return etat_; }
-Parking* Avion::getParking() const { std::lock_guard<std::mutex> lock(mtx_); return parking_; }
-Aeroport* Avion::getDestination() const { std::lock_guard<std::mutex> lock(mtx_); return destination_; }
-float Avion::getDureeStationnement() const { std::lock_guard<std::mutex> lock(mtx_); return dureeStationnement_; }
-bool Avion::estEnUrgence() const { std::lock_guard<std::mutex> lock(mtx_); return typeUrgence_ != TypeUrgence::AUCUNE; }
-TypeUrgence Avion::getTypeUrgence() const { std::lock_guard<std::mutex> lock(mtx_); return typeUrgence_; }
-const std::vector<Position> Avion::getTrajectoire() const { std::lock_guard<std::mutex> lock(mtx_); return trajectoire_; }
-
-void Avion::setPosition(const Position& p) { std::lock_guard<std::mutex> lock(mtx_); pos_ = p; }
-void Avion::setTrajectoire(const std::vector<Position>& traj) { std::lock_guard<std::mutex> lock(mtx_); trajectoire_ = traj; }
-void Avion::setEtat(EtatAvion e) { std::lock_guard<std::mutex> lock(mtx_); etat_ = e; }
-void Avion::setParking(Parking* p) { std::lock_guard<std::mutex> lock(mtx_); parking_ = p; }
-void Avion::setDestination(Aeroport* dest) { std::lock_guard<std::mutex> lock(mtx_); destination_ = dest; }
+// Vitesses, consommation et durée de stationnement ne changent pas après la construction
+float Avion::getVitesse() const { return vitesse_; }
+float Avion::getVitesseSol() const { return vitesseSol_; }
+Vent Avion::getVent() const { return vent_.lire(); }
+void Avion::setVent(Vent vent) { vent_.ecrire(vent); } // Un seul écrivain : le relevé du champ de vent
+
+float Avion::vitesseSurTrajet(Position direction) const {
+    // Le cap compense la dérive : seule la composante du vent le long de la route change la vitesse
+    double longueur = direction.norme();
+    if (longueur < 1e-9) return vitesse_;
+    Vent vent = vent_.lire();
+    float longitudinal = static_cast<float>((vent.u * direction.getX() + vent.v * direction.getY()) / longueur);
+    return std::max(vitesse_ + longitudinal, VITESSE_MIN_VENT * vitesse_);
+}
+float Avion::getCarburant() const { return getInstantane().carburant; }
+float Avion::getConsommation() const { return conso_; }
+Position Avion::getPosition() const { return getInstantane().position; }
+EtatAvion Avion::getEtat() const { return getInstantane().etat; }
+Parking* Avion::getParking() const { return getInstantane().parking; }
+Aeroport* Avion::getDestination() const { return getInstantane().destination; }
+size_t Avion::getPiste() const { return getInstantane().piste; }
+float Avion::getDureeStationnement() const { return dureeStationnement_; }
+bool Avion::estEnUrgence() const { return getInstantane().estEnUrgence(); }
+TypeUrgence Avion::getTypeUrgence() const { return getInstantane().typeUrgence; }
+
+bool Avion::finTrajectoire() const { return prochainPoint_ >= trajectoire_->size(); }
+
+const std::vector<Position> Avion::getTrajectoire() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (finTrajectoire()) return {};
+    return std::vector<Position>(trajectoire_->begin() + prochainPoint_, trajectoire_->end());
+}
+
+bool Avion::trajectoireTerminee() const { return getInstantane().trajectoireTerminee; }
+Position Avion::getProchainPoint() const { return getInstantane().prochainPoint; }
+
+void Avion::setPosition(const Position& p) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (croisiereAnalytique_) quitterCroisiereAnalytique(Horloge::getHorloge().maintenant());
+    pos_ = p;
+    publier(true);
+}
+void Avion::setTrajectoire(const std::vector<Position>& traj) { setTrajectoire(std::make_shared<const std::vector<Position>>(traj)); }
+
+void Avion::setTrajectoire(std::shared_ptr<const std::vector<Position>> traj) {
+    if (!traj) throw std::invalid_argument("Trajectoire NULL");
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (croisiereAnalytique_) quitterCroisiereAnalytique(Horloge::getHorloge().maintenant());
+    trajectoire_ = std::move(traj);
+    prochainPoint_ = 0;
+    publier();
+}
+void Avion::setEtat(EtatAvion e) { std::lock_guard<std::mutex> lock(mtx_); etat_ = e; publier(); }
+void Avion::setParking(Parking* p) { std::lock_guard<std::mutex> lock(mtx_); parking_ = p; publier(); }
+void Avion::setDestination(Aeroport* dest) { std::lock_guard<std::mutex> lock(mtx_); destination_ = dest; publier(); }
+void Avion::setPiste(size_t indexPiste) { std::lock_guard<std::mutex> lock(mtx_); piste_ = indexPiste; publier(); }
 
 void Avion::avancer(float dt) {
     std::lock_guard<std::mutex> lock(mtx_);
 
-    if (trajectoire_.empty()) return; // Pas de mouvement si pas de trajectoire
+    if (croisiereAnalytique_) quitterCroisiereAnalytique(Horloge::getHorloge().maintenant());
+    if (finTrajectoire()) return; // Pas de mouvement si pas de trajectoire
 
     // Gestion de la consommation de carburant
     float consommationRequise = conso_ * dt;
     if (carburant_ < consommationRequise) {
         carburant_ = 0;
         etat_ = EtatAvion::TERMINE; // L'avion s'écrase
+        publier();
         std::cout << "[AVION " << nom_ << "] CRASH : Plus de carburant\n";
-        Logs::getLogs().log("AVION", "CRASH", "Avion " + nom_ + " crash.");
+        Logs::getLogs().log("AVION", "CRASH", "Avion " + nom_ + " crash.", nom_);
         return;
     }
 
-    Position cible = trajectoire_.front();
+    Position cible = (*trajectoire_)[prochainPoint_];
     
     // Calcul du vecteur direction et de la distance vers le prochain point
     Position direction = cible - pos_;
-    double dist = std::sqrt(direction.getX() * direction.getX() + 
-                            direction.getY() * direction.getY() + 
-                            direction.getAltitude() * direction.getAltitude());
+    double dist = direction.norme();
     
-    float distance_a_parcourir = vitesse_ * dt;
+    float distance_a_parcourir = vitesseSurTrajet(direction) * dt; // Plus de pas, donc plus de carburant, face au vent
 
     // Déplacement de l'avion
     if (dist <= distance_a_parcourir) {
         pos_ = cible; // On atteint le point exact
-        trajectoire_.erase(trajectoire_.begin()); // On passe au point suivant
+        prochainPoint_++; // On passe au point suivant
     }
     else {
         pos_ = pos_ + (direction * (distance_a_parcourir / dist)); // On avance vers le point
@@ -72,12 +212,104 @@ void Avion::avancer(float dt) {
         typeUrgence_ = TypeUrgence::CARBURANT;
         std::cout << "[AVION " << nom_ << "] Urgence CARBURANT (< 1000L)\n";
     }
+    publier(); // Une seule publication par pas
+}
+
+float Avion::pasDepuisDebutCroisiere(std::chrono::steady_clock::time_point maintenant) const {
+    return pasEcoules(tempsCroisiere_, longueurCroisiere_, vitesseCroisiere_, maintenant);
+}
+
+void Avion::quitterCroisiereAnalytique(std::chrono::steady_clock::time_point maintenant) {
+    float pas = pasDepuisDebutCroisiere(maintenant);
+    carburant_ = carburantCroisiere_ - conso_ * pas;
+    if (atteintPointCroisiere_ && pas * vitesseCroisiere_ >= longueurCroisiere_) {
+        pos_ = (*trajectoire_)[prochainPoint_]; // Point exact, comme en pas à pas
+        prochainPoint_++;
+    }
+    else {
+        pos_ = debutCroisiere_ + directionCroisiere_ * (vitesseCroisiere_ * pas);
+    }
+    pasCroisiere_ += static_cast<int>(pas);
+    croisiereAnalytique_ = false;
+    publier();
+    finCroisiere_.notify_all(); // Réveille le thread de l'avion s'il attend la fin du segment
+}
+
+std::chrono::milliseconds Avion::demarrerCroisiereAnalytique(Position centreZone, double rayonZone) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (croisiereAnalytique_ || finTrajectoire()) return std::chrono::milliseconds(0);
+
+    Position cible = (*trajectoire_)[prochainPoint_];
+    double longueurSegment = pos_.distance(cible);
+    float vitesse = vitesseSurTrajet(cible - pos_); // Vent supposé constant sur le segment
+    if (longueurSegment <= vitesse) return std::chrono::milliseconds(0);
+
+    // Distance sûre : l'avion ne peut pas entrer dans la zone avant de l'avoir parcourue (inégalité triangulaire)
+    double longueur = std::min(longueurSegment, pos_.distance(centreZone) - rayonZone);
+
+    // Le pas à pas reprend avant le seuil d'urgence carburant pour qu'il soit détecté normalement
+    if (conso_ > 0) longueur = std::min(longueur, static_cast<double>((carburant_ - 1000.f) / conso_) * vitesse);
+    if (longueur <= vitesse) return std::chrono::milliseconds(0);
+
+    croisiereAnalytique_ = true;
+    debutCroisiere_ = pos_;
+    directionCroisiere_ = (cible - pos_) * (1.0 / longueurSegment);
+    longueurCroisiere_ = longueur;
+    atteintPointCroisiere_ = (longueur == longueurSegment);
+    tempsCroisiere_ = Horloge::getHorloge().maintenant();
+    carburantCroisiere_ = carburant_;
+    vitesseCroisiere_ = vitesse;
+    publier();
+    return std::chrono::milliseconds(static_cast<long long>(longueur / vitesse * PAS_AVION_MS));
+}
+
+int Avion::attendreFinCroisiereAnalytique(std::chrono::milliseconds duree, std::stop_token arret) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    // Interrompu plus tôt si un contrôleur modifie la position ou la trajectoire
+    // Attente en temps réel par tranches : la compression du temps peut changer pendant le segment
+    auto fin = Horloge::getHorloge().maintenant() + duree;
+    while (croisiereAnalytique_ && !arret.stop_requested()) {
+        auto reste = fin - Horloge::getHorloge().maintenant();
+        if (reste <= std::chrono::steady_clock::duration::zero()) break;
+        auto tranche = std::min<std::chrono::nanoseconds>(Horloge::getHorloge().versDureeReelle(reste), std::chrono::milliseconds(100));
+        finCroisiere_.wait_for(lock, arret, tranche, [this]() { return !croisiereAnalytique_; });
+    }
+    if (croisiereAnalytique_) quitterCroisiereAnalytique(Horloge::getHorloge().maintenant());
+
+    int pas = pasCroisiere_;
+    pasCroisiere_ = 0;
+    return pas;
+}
+
+InstantaneAvion Avion::capturer(std::vector<Position>& trajectoire) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    // Sous le verrou, aucun pas ne s'intercale entre l'instantané et la trajectoire
+    InstantaneAvion etat = getInstantane();
+    trajectoire.clear();
+    if (!finTrajectoire()) trajectoire.assign(trajectoire_->begin() + prochainPoint_, trajectoire_->end());
+    return etat;
+}
+
+void Avion::restaurer(const InstantaneAvion& etat, const std::vector<Position>& trajectoire) {
+    if (etat.carburant < 0) throw std::invalid_argument("Carburant negatif");
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (croisiereAnalytique_) quitterCroisiereAnalytique(Horloge::getHorloge().maintenant());
+    pos_ = etat.position;
+    etat_ = etat.etat;
+    carburant_ = etat.carburant;
+    typeUrgence_ = etat.typeUrgence;
+    destination_ = etat.destination;
+    parking_ = etat.parking;
+    piste_ = etat.piste;
+    trajectoire_ = std::make_shared<const std::vector<Position>>(trajectoire);
+    prochainPoint_ = 0;
+    publier(true);
 }
 
 void Avion::avancerSol(float dt) {
     std::lock_guard<std::mutex> lock(mtx_);
 
-    if (trajectoire_.empty()) return;
+    if (finTrajectoire()) return;
 
     // Consommation réduite au sol (5% de la conso normale)
     float consommationSol = conso_ * 0.05f;
@@ -86,25 +318,24 @@ void Avion::avancerSol(float dt) {
     if (carburant_ < consommationRequise) {
         carburant_ = 0;
         etat_ = EtatAvion::TERMINE;
+        publier();
         std::cout << "[AVION " << nom_ << "] Panne carburant au sol\n";
         return;
     }
 
-    Position cible = trajectoire_.front();
+    Position cible = (*trajectoire_)[prochainPoint_];
     
     Position direction = cible - pos_;
-    double dist = std::sqrt(direction.getX() * direction.getX() + 
-                            direction.getY() * direction.getY() + 
-                            direction.getAltitude() * direction.getAltitude());
+    double dist = direction.norme();
     
     float distance_a_parcourir = vitesseSol_ * dt; // Utilisation de la vitesse au sol
 
     if (dist <= distance_a_parcourir) {
         pos_ = cible;
-        trajectoire_.erase(trajectoire_.begin());
+        prochainPoint_++;
 
         // Logique de fin de trajectoire au sol
-        if (trajectoire_.empty()) {
+        if (finTrajectoire()) {
             if (etat_ == EtatAvion::ROULE_VERS_PISTE) {
                 etat_ = EtatAvion::EN_ATTENTE_PISTE; // Prêt à décoller
                 if (parking_) {
@@ -124,12 +355,14 @@ void Avion::avancerSol(float dt) {
     }
 
     carburant_ -= consommationRequise;
+    publier();
 }
 
 void Avion::declarerUrgence(TypeUrgence type) {
     std::lock_guard<std::mutex> lock(mtx_);
     if (typeUrgence_ == TypeUrgence::AUCUNE) { // On ne déclare l'urgence que si pas déjà en urgence
         typeUrgence_ = type;
+        publier();
         std::string raison;
         switch (type) {
             case TypeUrgence::PANNE_MOTEUR: raison = "PANNE MOTEUR"; break;
@@ -138,7 +371,7 @@ void Avion::declarerUrgence(TypeUrgence type) {
             default: raison = "INCONNUE"; break;
         }
         std::cout << "[AVION " << nom_ << "] MAYDAY : Urgence " << raison << " !\n";
-        Logs::getLogs().log("AVION", "URGENCE", "Urgence : " + raison);
+        Logs::getLogs().log("AVION", "URGENCE", "Urgence : " + raison, nom_);
     }
 }
 
@@ -154,6 +387,7 @@ void Avion::effectuerMaintenance() {
     } else {
         std::cout << "[AVION " << nom_ << "] Ravitaillement complet.\n";
     }
+    publier();
 }
 
 // Opérateur de comparaison
@@ -4,8 +4,24 @@
 #include <mutex>
 #include <iostream>
 #include <queue>
+#include <set>
+#include <unordered_map>
 #include <cmath>
 #include <fstream>
+#include <chrono>
+#include <memory>
+#include <condition_variable>
+#include <map>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+#include <stop_token>
+#include <type_traits>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include "allocations.hpp"
 
 enum class EtatAvion {
     STATIONNE,// L'avion est stationn dans un parking
@@ -21,6 +37,9 @@ enum class EtatAvion {
     TERMINE // Disparition de l'avion
 };
 
+const size_t NOMBRE_ETATS_AVION = static_cast<size_t>(EtatAvion::TERMINE) + 1;
+const char* nomEtat(EtatAvion etat); // Libell de l'tat pour l'affichage et les outils ("Inconnu" hors de l'numration)
+
 enum class TypeUrgence {
     AUCUNE,
     PANNE_MOTEUR, 
@@ -33,27 +52,182 @@ enum class Tour { // Pour g
     ATTERRISSAGE
 };
 
+enum class ModePiste { // Utilisation d'une piste
+    MIXTE, // Atterrissages et dcollages en alternance
+    ARRIVEES, // Atterrissages uniquement
+    DEPARTS // Dcollages uniquement
+};
 
-class Position {
-private:
-    double x_, y_, altitude_;
+enum class PrioriteArrivee { // Rang dans la squence d'arrive (du plus prioritaire au moins prioritaire)
+    URGENCE,
+    CARBURANT_BAS,
+    NORMALE
+};
+
+enum class PhaseArrivee { // Situation d'un avion dans la squence d'un APP
+    ATTENTE_CRENEAU, // En attente  l'entre de la zone jusqu' son crneau
+    APPROCHE, // Sur la trajectoire d'approche (ou trajectoire directe d'urgence)
+    ATTENTE_PISTE // A manqu son crneau, attend en circuit que la piste se libre
+};
+
+const int PAS_AVION_MS = 75; // Dure d'un pas de simulation d'un avion (ms)
+const float VITESSE_MIN_VENT = 0.3f; // Part minimale de la vitesse propre conserve face au vent
+
+// Verrou de squence : un seul crivain, lecteurs sans verrou qui recommencent si une criture les a chevauchs.
+// Les donnes sont recopies mot par mot dans des atomiques pour que les lectures concurrentes restent dfinies.
+template <typename T>
+class VerrouSequence {
+    static_assert(std::is_trivially_copyable_v<T>, "VerrouSequence : type non copiable octet par octet");
+    static constexpr size_t NB_MOTS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<unsigned> sequence_{ 0 }; // Impaire pendant une criture
+    std::atomic<uint64_t> mots_[NB_MOTS] = {};
 
 public:
-    Position(double x = 0, double y = 0, double z = 0);
+    void ecrire(const T& valeur) { // Les crivains doivent tre srialiss par l'appelant
+        uint64_t tampon[NB_MOTS] = {};
+        std::memcpy(tampon, &valeur, sizeof(T));
+        unsigned seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < NB_MOTS; ++i) mots_[i].store(tampon[i], std::memory_order_relaxed);
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    T lire() const {
+        uint64_t tampon[NB_MOTS];
+        while (true) {
+            unsigned avant = sequence_.load(std::memory_order_acquire);
+            if (avant & 1) { std::this_thread::yield(); continue; } // criture en cours
+            for (size_t i = 0; i < NB_MOTS; ++i) tampon[i] = mots_[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == avant) break; // Copie cohrente
+        }
+        T valeur;
+        std::memcpy(&valeur, tampon, sizeof(T));
+        return valeur;
+    }
+};
 
-    double getX() const;
-    double getY() const;
-    double getAltitude() const;
-    void setPosition(double x, double y, double alt);
+// Bote aux lettres  plusieurs producteurs et un seul consommateur, sans verrou.
+// Les producteurs empilent (pile de Treiber) ; le consommateur rcupre toute la pile d'un coup et la remet dans l'ordre d'arrive.
+template <typename T>
+class BoiteMessages {
+    struct Noeud {
+        T message;
+        Noeud* suivant;
+    };
+    std::atomic<Noeud*> tete_{ nullptr };
 
-    double distance(const Position& other) const;
+public:
+    BoiteMessages() = default;
+    BoiteMessages(const BoiteMessages&) = delete;
+    BoiteMessages& operator=(const BoiteMessages&) = delete;
+    ~BoiteMessages() { relever(); }
+
+    void deposer(T message) { // Appelable depuis n'importe quel thread, ne bloque jamais
+        Noeud* noeud = new Noeud{ std::move(message), tete_.load(std::memory_order_relaxed) };
+        while (!tete_.compare_exchange_weak(noeud->suivant, noeud, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    void deposerLot(std::vector<T> messages) { // Chane prpare hors de la pile puis accroche en une seule opration
+        if (messages.empty()) return;
+        Noeud* premier = new Noeud{ std::move(messages[0]), nullptr }; // Le plus ancien, au fond de la chane
+        Noeud* dernier = premier;
+        for (size_t i = 1; i < messages.size(); ++i) dernier = new Noeud{ std::move(messages[i]), dernier };
+        premier->suivant = tete_.load(std::memory_order_relaxed);
+        while (!tete_.compare_exchange_weak(premier->suivant, dernier, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    std::vector<T> relever() { // Rserv au thread propritaire : renvoie les messages du plus ancien au plus rcent
+        Noeud* noeud = tete_.exchange(nullptr, std::memory_order_acquire);
+        std::vector<T> messages;
+        while (noeud) {
+            messages.push_back(std::move(noeud->message));
+            Noeud* suivant = noeud->suivant;
+            delete noeud;
+            noeud = suivant;
+        }
+        std::reverse(messages.begin(), messages.end());
+        return messages;
+    }
+};
+
+
+// Horloge de simulation : temps rel multipli par un facteur de compression rglable pendant la simulation.
+// Tous les dlais et horodatages de la simulation passent par elle (pauses, crneaux, occupation des pistes...).
+class Horloge {
+private:
+    struct Repere { // Dernier changement de facteur : le temps simul avance linairement depuis ce point
+        std::chrono::steady_clock::time_point reel;
+        std::chrono::steady_clock::time_point simule;
+        double facteur;
+    };
+    VerrouSequence<Repere> repere_; // Lu sans verrou par tous les threads
+    std::mutex mutex_; // Srialise les changements de facteur
+    Horloge();
+
+public:
+    static Horloge& getHorloge();
+    std::chrono::steady_clock::time_point maintenant() const; // Instant simul courant
+    double getFacteur() const; // Secondes simules par seconde relle
+    void setFacteur(double facteur); // Change la compression sans saut du temps simul
+    std::chrono::nanoseconds versDureeReelle(std::chrono::nanoseconds dureeSimulee) const; // Dure relle au facteur actuel
+    bool pause(std::chrono::milliseconds dureeSimulee, std::stop_token arret = {}) const; // Endort le thread appelant pour une dure simule ; false si l'arrt a t demand avant la fin
+    Horloge(const Horloge&) = delete;
+    void operator=(const Horloge&) = delete;
+};
+
+// Vecteur 3D (m), entirement dans l'en-tte pour tre inlin partout ; les seuils se comparent au carr, sans racine
+class Position {
+private:
+    double x_, y_, altitude_;
 
-    Position operator+(const Position& other) const;
-    Position operator-(const Position& other) const;
-    Position operator*(double scalar) const;
-    bool operator==(const Position& other) const;
+public:
+    constexpr Position(double x = 0, double y = 0, double z = 0) : x_(x), y_(y), altitude_(z) {}
+
+    constexpr double getX() const { return x_; }
+    constexpr double getY() const { return y_; }
+    constexpr double getAltitude() const { return altitude_; }
+    constexpr void setPosition(double x, double y, double alt) { x_ = x; y_ = y; altitude_ = alt; }
+
+    constexpr double normeCarre() const { return x_ * x_ + y_ * y_ + altitude_ * altitude_; }
+    double norme() const { return std::sqrt(normeCarre()); }
+    constexpr double distanceCarre(const Position& other) const { return (*this - other).normeCarre(); } //  comparer au carr d'un seuil
+    double distance(const Position& other) const { return std::sqrt(distanceCarre(other)); }
+    constexpr double distanceHorizontaleCarre(const Position& other) const { // Altitude ignore
+        return (x_ - other.x_) * (x_ - other.x_) + (y_ - other.y_) * (y_ - other.y_);
+    }
+    double distanceHorizontale(const Position& other) const { return std::sqrt(distanceHorizontaleCarre(other)); }
+
+    constexpr Position operator+(const Position& other) const { return Position(x_ + other.x_, y_ + other.y_, altitude_ + other.altitude_); }
+    constexpr Position operator-(const Position& other) const { return Position(x_ - other.x_, y_ - other.y_, altitude_ - other.altitude_); }
+    constexpr Position operator*(double scalar) const { return Position(x_ * scalar, y_ * scalar, altitude_ * scalar); }
+    constexpr bool operator==(const Position& other) const { // galit  1 mm prs
+        const double epsilon = 0.001;
+        auto proche = [epsilon](double a, double b) { return a - b < epsilon && b - a < epsilon; };
+        return proche(x_, other.x_) && proche(y_, other.y_) && proche(altitude_, other.altitude_);
+    }
 };
 
+// Seuils au carr exacts : x < seuilCarreStrict(s) quivaut au bit prs  sqrt(x) < s, et x <= seuilCarreInclus(s)  sqrt(x) <= s.
+// s * s ne suffit pas : la racine arrondie d'un carr  un ulp sous s * s peut valoir s (20 km par exemple). A calculer une fois par seuil.
+template <typename Reel>
+Reel seuilCarreStrict(Reel seuil) { // Plus petit carr dont la racine atteint seuil
+    Reel x = seuil * seuil;
+    while (x > 0 && std::sqrt(std::nextafter(x, Reel(0))) >= seuil) x = std::nextafter(x, Reel(0));
+    while (std::sqrt(x) < seuil) x = std::nextafter(x, std::numeric_limits<Reel>::infinity());
+    return x;
+}
+
+template <typename Reel>
+Reel seuilCarreInclus(Reel seuil) { // Plus grand carr dont la racine ne dpasse pas seuil
+    Reel x = seuil * seuil;
+    while (x > 0 && std::sqrt(x) > seuil) x = std::nextafter(x, Reel(0));
+    while (std::sqrt(std::nextafter(x, std::numeric_limits<Reel>::infinity())) <= seuil) x = std::nextafter(x, std::numeric_limits<Reel>::infinity());
+    return x;
+}
+
 class Parking {
 private:
     std::string nom_;
@@ -72,7 +246,146 @@ public:
     bool operator==(const Parking& other) const;
 };
 
+class Piste {
+private:
+    std::string nom_;
+    Position seuil_;
+    ModePiste mode_;
+    std::chrono::milliseconds tempsOccupation_;
+    bool libre_;
+    std::chrono::steady_clock::time_point disponibleA_; // Fin de l'occupation minimale du dernier mouvement
+    std::chrono::steady_clock::time_point debutOccupation_;
+    std::chrono::milliseconds occupationObservee_; // Dure moyenne relle d'occupation (jusqu'au dgagement)
+    std::chrono::milliseconds occupationCumulee_; // Somme des occupations termines (statistiques)
+    Tour tourActuel_;
+
+public:
+    Piste(std::string nom, Position seuil, ModePiste mode, float tempsOccupation);
+
+    std::string getNom() const; // Renvoie le nom de la piste
+    Position getSeuil() const; // Renvoie la position du seuil de piste
+    ModePiste getMode() const; // Renvoie le mode d'utilisation
+    bool accepteArrivees() const; // Renvoie si la piste peut servir aux atterrissages
+    bool accepteDeparts() const; // Renvoie si la piste peut servir aux dcollages
+    bool estLibre() const; // Renvoie si aucun avion n'occupe la piste
+    bool estDisponible(std::chrono::steady_clock::time_point maintenant) const; // Libre et temps d'occupation coul
+    std::chrono::steady_clock::time_point getDisponibleA() const; // Renvoie l'instant o la piste sera rutilisable
+    std::chrono::milliseconds getTempsOccupation() const; // Renvoie le temps d'occupation minimal par mouvement
+    void reserver(std::chrono::steady_clock::time_point maintenant); // Occupe la piste pour un mouvement
+    void liberer(std::chrono::steady_clock::time_point maintenant); // Libre la piste une fois dgage
+    std::chrono::milliseconds getOccupationEstimee() const; // Temps d'occupation attendu : minimum rglementaire ou dure observe
+    std::chrono::steady_clock::time_point getLiberationEstimee() const; // Instant estim o la piste sera de nouveau disponible
+    Tour getTour() const; // Renvoie le prochain type de mouvement prioritaire (mode mixte)
+    void setTour(Tour tour); // Dfinit le prochain type de mouvement prioritaire
+    std::chrono::steady_clock::time_point getDebutOccupation() const; // Renvoie le dbut du dernier mouvement
+    std::chrono::milliseconds getOccupationObservee() const; // Renvoie la dure moyenne d'occupation mesure
+    std::chrono::milliseconds getOccupationCumulee() const; // Renvoie le temps total d'occupation depuis la cration
+    void restaurer(bool libre, std::chrono::steady_clock::time_point disponibleA, std::chrono::steady_clock::time_point debutOccupation,
+                   std::chrono::milliseconds occupationObservee, Tour tour); // Reprend l'tat d'une sauvegarde
+};
+
+class ReseauRoulage {
+private:
+    std::vector<std::string> nomsNoeuds_;
+    std::vector<Position> noeuds_;
+    std::vector<std::vector<std::pair<size_t, double>>> voisins_; // Liste d'adjacence (noeud voisin, longueur)
+    std::vector<std::pair<size_t, size_t>> arcs_;
+    std::vector<size_t> noeudsParkings_; // Noeud de raccordement de chaque parking (meme ordre que les parkings de l'aeroport)
+    std::vector<size_t> sortiesPistes_; // Sortie de chaque piste (indice de piste)
+    std::vector<size_t> pointsAttente_; // Point d'attente de chaque piste (indice de piste)
+    std::vector<std::vector<std::vector<Position>>> cheminsVersParking_; // Cache [piste][parking] : sortie de piste -> parking
+    std::vector<std::vector<std::vector<Position>>> cheminsVersPiste_; // Cache [piste][parking] : parking -> point d'attente
+    std::vector<std::vector<double>> longueursVersPiste_;
+
+    size_t trouverNoeud(const std::string& nom) const;
+    std::vector<size_t> plusCourtsChemins(size_t source) const; // Dijkstra, renvoie le predecesseur de chaque noeud
+
+public:
+    ReseauRoulage();
+
+    void vider(); // Supprime tous les noeuds, arcs et chemins calcules
+    void ajouterNoeud(const std::string& nom, Position pos); // Ajoute une intersection de voies de circulation
+    void ajouterArc(const std::string& a, const std::string& b); // Relie deux noeuds (dans les deux sens)
+    void definirSortiePiste(const std::string& noeud, size_t indexPiste = 0); // Noeud ou les avions quittent la piste apres atterrissage
+    void definirPointAttente(const std::string& noeud, size_t indexPiste = 0); // Noeud ou les avions attendent avant de decoller
+    void relierParking(const std::string& noeud); // Raccorde le parking suivant (dans l'ordre des parkings) a un noeud
+    void precalculerChemins(const std::vector<Parking>& parkings, const std::vector<Piste>& pistes); // Calcule et met en cache tous les chemins de roulage
+
+    const std::vector<Position>& getCheminVersParking(size_t indexPiste, size_t indexParking) const; // Chemin de la sortie de piste jusqu'au parking
+    const std::vector<Position>& getCheminVersPiste(size_t indexPiste, size_t indexParking) const; // Chemin du parking jusqu'au point d'attente
+    double getLongueurVersPiste(size_t indexPiste, size_t indexParking) const; // Longueur du roulage du parking jusqu'au point d'attente
+    std::vector<std::pair<Position, Position>> getArcs() const; // Renvoie les segments du reseau (pour l'affichage)
+};
+
 struct Aeroport;
+class Indicateurs;
+
+struct InstantaneAvion { // Copie cohrente de l'tat d'un avion  un instant donn
+    Position position;
+    EtatAvion etat;
+    float carburant;
+    TypeUrgence typeUrgence;
+    Aeroport* destination;
+    Parking* parking;
+    size_t piste;
+    Position prochainPoint; // Position actuelle si la trajectoire est termine
+    bool trajectoireTerminee;
+    Position positionPrecedente; // Position publie avant la dernire, pour l'interpolation de l'affichage
+    std::chrono::steady_clock::time_point horodatage; // Instant simul de la position
+    std::chrono::steady_clock::time_point horodatagePrecedent; // Instant simul de la position prcdente
+
+    bool estEnUrgence() const { return typeUrgence != TypeUrgence::AUCUNE; }
+    Position interpoler(std::chrono::steady_clock::time_point instant) const; // Entre les deux dernires positions, borne  celles-ci
+};
+
+class ReseauAerien {
+private:
+    std::vector<std::string> nomsBalises_;
+    std::vector<Position> balises_;
+    std::vector<std::vector<std::pair<size_t, double>>> voisins_; // Liste d'adjacence (balise voisine, longueur)
+    std::vector<std::pair<size_t, size_t>> segments_;
+    std::map<std::pair<const Aeroport*, const Aeroport*>, std::shared_ptr<const std::vector<Position>>> routes_; // Cache (dpart, arrive) -> route
+    mutable std::mutex mutex_;
+
+    size_t trouverBalise(const std::string& nom) const;
+    std::vector<Position> plusCourtChemin(const Aeroport* depart, const Aeroport* arrivee) const; // Dijkstra d'aroport  aroport (vide si non relis)
+    std::shared_ptr<const std::vector<Position>> calculerRoute(const Aeroport* depart, const Aeroport* arrivee) const; // Chemin + profil monte/croisire/descente
+
+public:
+    ReseauAerien();
+
+    void ajouterBalise(const std::string& nom, Position pos); // Ajoute un point de report (les aroports en sont aussi)
+    void ajouterSegment(const std::string& a, const std::string& b); // Relie deux balises par une voie arienne (dans les deux sens)
+    std::shared_ptr<const std::vector<Position>> getRoute(const Aeroport* depart, const Aeroport* arrivee); // Route calcule une seule fois par trajet puis partage
+    std::vector<std::pair<Position, Position>> getSegments() const; // Renvoie les voies ariennes (pour l'affichage)
+};
+
+struct Vent { // Vent horizontal, dans l'unit des vitesses des avions (m par pas)
+    float u = 0; // Vers l'est (x croissant)
+    float v = 0; // Vers le nord (y croissant)
+};
+
+// Champ de vent sur une grille rgulire, variable dans le temps (instants successifs interpols).
+// Immuable une fois construit, lu sans verrou. Composantes (u, v) entrelaces par noeud et lignes contigus :
+// une interpolation bilinaire lit deux paires voisines sur deux lignes.
+class ChampVent {
+private:
+    double x0_, y0_, pas_; // Noeud sud-ouest et espacement de la grille (m)
+    size_t nx_, ny_;
+    std::vector<double> instants_; // Secondes simules depuis l'origine, croissantes
+    std::vector<float> composantes_; // [instant][y][x][u, v]
+    double periode_; // Non nulle : le champ boucle sur cette dure (champ gnr), sinon le dernier instant se prolonge
+    std::chrono::steady_clock::time_point origine_;
+
+    ChampVent(double x0, double y0, double pas, size_t nx, size_t ny);
+    size_t indexInstant(std::chrono::steady_clock::time_point instant, float& poids) const; // Instant prcdent et poids du suivant
+
+public:
+    static ChampVent charger(const std::string& chemin); // Grille lue dans un fichier (format dcrit dans vent.cpp)
+    static ChampVent generer(double xMin, double yMin, double xMax, double yMax, float vitesse, unsigned int graine); // Courant d'ouest et tourbillons qui drivent
+    void echantillonner(const std::vector<Position>& positions, std::chrono::steady_clock::time_point instant,
+                        std::vector<Vent>& vents) const; // Vent en chaque position (bilinaire, attnu prs du sol), instant et poids calculs une seule fois
+};
 
 class Avion {
 private:
@@ -86,9 +399,43 @@ private:
     EtatAvion etat_;
     Parking* parking_;
     Aeroport* destination_;
+    size_t piste_;
     TypeUrgence typeUrgence_;
-    std::vector<Position> trajectoire_;
-    mutable std::mutex mtx_;
+    std::shared_ptr<const std::vector<Position>> trajectoire_; // Points de passage (une route de croisire est partage par tous les vols du trajet)
+    size_t prochainPoint_; // Indice du prochain point de passage dans trajectoire_
+
+    // Croisire analytique (niveau de dtail rduit) : position et carburant calculs  la lecture
+    bool croisiereAnalytique_;
+    Position debutCroisiere_;
+    Position directionCroisiere_; // Vecteur unitaire du segment
+    double longueurCroisiere_; // Distance parcourue en mode analytique avant de revenir au pas  pas
+    bool atteintPointCroisiere_; // La fin du mode analytique est le point de passage lui-mme
+    std::chrono::steady_clock::time_point tempsCroisiere_;
+    float carburantCroisiere_;
+    int pasCroisiere_; // Pas simuls analytiquement depuis le dernier rveil du thread
+    float vitesseCroisiere_; // Vitesse vent compris sur le segment analytique (vent relev au dbut du segment)
+    std::condition_variable_any finCroisiere_;
+
+    struct EtatPublie { // Ce que voient les lecteurs : l'instantan du dernier pas et, en croisire analytique, de quoi le prolonger
+        InstantaneAvion instantane;
+        bool croisiereAnalytique;
+        Position debutCroisiere;
+        Position directionCroisiere;
+        double longueurCroisiere;
+        std::chrono::steady_clock::time_point tempsCroisiere;
+        float carburantCroisiere;
+        float vitesseCroisiere;
+    };
+    VerrouSequence<EtatPublie> publie_;
+    VerrouSequence<Vent> vent_; // Vent  la position de l'avion, relev pour toute la flotte  la fois
+
+    mutable std::mutex mtx_; // Srialise les critures (le thread de l'avion et les contrleurs)
+
+    bool finTrajectoire() const; // Tous les points de passage sont atteints (verrou dj pris)
+    float pasDepuisDebutCroisiere(std::chrono::steady_clock::time_point maintenant) const; // Pas quivalents couls, borns  la fin du segment
+    void quitterCroisiereAnalytique(std::chrono::steady_clock::time_point maintenant); // Fige position et carburant, reprend le pas  pas (verrou dj pris)
+    void publier(bool saut = false); // Publie l'tat courant pour les lecteurs (verrou dj pris) ; saut : pas d'interpolation depuis l'ancienne position
+    float vitesseSurTrajet(Position direction) const; // Vitesse le long de direction, vent de face ou arrire compris
 
 public:
     Avion(std::string n, float v, float vSol, float c, float conso, float dureeStat, Position pos);
@@ -96,108 +443,362 @@ public:
     std::string getNom() const; // Renvoie le nom de l'avion
     float getVitesse() const; // Renvoie la vitesse de croisire
     float getVitesseSol() const; // Renvoie la vitesse au sol
+    Vent getVent() const; // Renvoie le dernier vent relev  la position de l'avion
+    void setVent(Vent vent); // Vent  la position de l'avion, appliqu aux pas suivants
     float getCarburant() const; // Renvoie la quantit de carburant
     float getConsommation() const; // Renvoie la consommation
     Position getPosition() const; // Renvoie la position actuelle
     EtatAvion getEtat() const; // Renvoie l'tat actuel
     Parking* getParking() const; // Renvoie le parking assign
     Aeroport* getDestination() const; // Renvoie l'aroport de destination
+    size_t getPiste() const; // Renvoie l'indice de la piste assigne
     float getDureeStationnement() const; // Renvoie la dure de stationnement prvue
     bool estEnUrgence() const; // Renvoie si l'avion est en urgence
     TypeUrgence getTypeUrgence() const; // Renvoie le type d'urgence
-    const std::vector<Position> getTrajectoire() const; // Renvoie la trajectoire  suivre
+    const std::vector<Position> getTrajectoire() const; // Renvoie les points de passage restants
+    bool trajectoireTerminee() const; // Renvoie si l'avion a atteint son dernier point de passage
+    Position getProchainPoint() const; // Renvoie le prochain point de passage (la position actuelle si aucun)
+    InstantaneAvion getInstantane() const; // Renvoie position, tat, carburant, urgence... cohrents entre eux, sans bloquer l'avion
 
     void setPosition(const Position& p); // Dfinit la position
     void setTrajectoire(const std::vector<Position>& traj); // Dfinit la trajectoire
+    void setTrajectoire(std::shared_ptr<const std::vector<Position>> traj); // Suit une trajectoire partage sans la copier
     void setEtat(EtatAvion e); // Dfinit l'tat
     void setParking(Parking* p); // Assigne un parking
     void setDestination(Aeroport* dest); // Dfinit la destination
+    void setPiste(size_t indexPiste); // Assigne une piste (atterrissage ou dcollage)
 
     void avancer(float dt); // Fait avancer l'avion en vol
+    std::chrono::milliseconds demarrerCroisiereAnalytique(Position centreZone, double rayonZone); // Passe en croisire analytique sur le segment courant, renvoie sa dure (0 si impossible)
+    int attendreFinCroisiereAnalytique(std::chrono::milliseconds duree, std::stop_token arret); // Bloque jusqu' la fin du segment, une interruption ou l'arrt, renvoie le nombre de pas simuls
     void avancerSol(float dt); // Fait avancer l'avion au sol
     void declarerUrgence(TypeUrgence type); // Dclare une urgence
     void effectuerMaintenance(); // Effectue la maintenance au sol
+    InstantaneAvion capturer(std::vector<Position>& trajectoire) const; // Instantan et points de passage restants, cohrents entre eux (pour la sauvegarde)
+    void restaurer(const InstantaneAvion& etat, const std::vector<Position>& trajectoire); // Reprend l'tat d'une sauvegarde
 
     bool operator==(const Avion& other) const;
 };
 
+class APP;
+
+enum class TypeMessageAPP {
+    TRANSFERT, // Le CCR passe l'avion  l'APP
+    URGENCE, // L'avion dclare une urgence dans la zone
+    FIN_APPROCHE, // L'avion est au bout de sa trajectoire d'approche
+    ATTERRISSAGE_AUTORISE, // Rponse de la tour
+    ATTERRISSAGE_REFUSE // Rponse de la tour
+};
+
+struct MessageAPP {
+    TypeMessageAPP type;
+    Avion* avion;
+};
+
+struct ArriveeSauvegardee { // Place d'un avion dans la squence d'un APP, pour la sauvegarde
+    Avion* avion;
+    PrioriteArrivee priorite;
+    std::chrono::steady_clock::time_point heureEstimee;
+    unsigned long long ordre;
+    size_t piste;
+    bool pisteFixee;
+    std::chrono::steady_clock::time_point creneau;
+    PhaseArrivee phase;
+};
+
+struct DemandeAtterrissage {
+    Avion* avion;
+    APP* demandeur; // Destinataire de la rponse
+};
+
 class TWR {
 private:
-    bool pisteLibre_;
+    struct EtatPublie { // Vue des pistes pour les autres contrleurs, lue sans prendre mutexTWR_
+        std::vector<Piste> pistes;
+        std::vector<bool> decollageEnAttente; // Par piste : un avion attend au seuil
+    };
+
+    std::string aeroport_;
+    std::vector<Piste> pistes_;
     std::vector<Parking>& parkings_;
-    Position posPiste_;
+    const ReseauRoulage& roulage_;
     float tempsAtterrissageDecollage_;
     std::vector<Avion*> filePourDecollage_;
     mutable std::mutex mutexTWR_;
-    bool urgenceEnCours_;
-    Tour tourActuel_;
-    bool demandeAtterrissage_;
+    std::atomic<bool> urgenceEnCours_;
+    std::atomic<bool> demandeAtterrissage_;
+    size_t maxDepartsEnCours_;
+    BoiteMessages<DemandeAtterrissage> demandesAtterrissage_;
+    std::atomic<std::shared_ptr<const EtatPublie>> etatPublie_;
+    Indicateurs* indicateurs_; // Occupations de piste termines, si l'affichage les suit
+    const Aeroport* aeroportIndicateurs_;
+
+    size_t indexParking(const Parking* parking) const; // Renvoie l'indice du parking dans parkings_
+    bool parkingDisponible() const; // Renvoie si au moins un parking est libre
+    bool decollageEnAttente(size_t indexPiste) const; // Renvoie si un avion attend au seuil de cette piste
+    size_t chargeDepart(size_t indexPiste) const; // Nombre d'avions qui roulent vers cette piste ou attendent  son seuil
+    size_t choisirPisteDepart() const; // Piste de dcollage la moins charge
+    void lancerRoulages(std::chrono::steady_clock::time_point maintenant); // Lance les roulages dont l'heure de dpart est atteinte
+    void publierEtat(); // Publie la vue des pistes (verrou dj pris)
+    void libererPisteVerrouillee(size_t indexPiste, std::chrono::steady_clock::time_point maintenant); // Libre la piste et signale l'occupation (verrou dj pris)
 
 public:
-    TWR(std::vector<Parking>& parkings, Position posPiste, float tempsAtterrisageDecollage);
-
-    Position getPositionPiste() const; // Renvoie la position de la piste
-    bool estPisteLibre() const; // Renvoie si la piste est libre
-    void libererPiste(); // Libre la piste
-    void reserverPiste(); // Rserve la piste
+    TWR(const std::string& aeroport, std::vector<Parking>& parkings, const ReseauRoulage& roulage, Position posPiste, float tempsAtterrisageDecollage);
+    const std::string& getAeroport() const; // Nom de l'aroport de la tour
+    void setIndicateurs(Indicateurs* indicateurs, const Aeroport* aeroport); // Indicateurs  alimenter (avant le lancement des threads)
+
+    void viderPistes(); // Supprime les pistes (avant chargement du scnario)
+    void ajouterPiste(const std::string& nom, Position seuil, ModePiste mode, float tempsOccupation); // Ajoute une piste
+    size_t getNombrePistes() const; // Renvoie le nombre de pistes
+    size_t getIndexPiste(const std::string& nom) const; // Renvoie l'indice d'une piste  partir de son nom
+    std::vector<Piste> getPistes() const; // Renvoie une copie de l'tat des pistes (pour l'affichage)
+    Position getPositionPiste(size_t indexPiste = 0) const; // Renvoie la position du seuil d'une piste
+    bool estPisteLibre(size_t indexPiste) const; // Renvoie si la piste est libre
+    void libererPiste(size_t indexPiste); // Libre la piste
+    void reserverPiste(size_t indexPiste); // Rserve la piste
 
     void setDemandeAtterrissage(bool statut); // Signale une demande d'atterrissage
-    bool autoriserAtterrissage(Avion* avion); // Autorise l'atterrissage si possible
+    bool autoriserAtterrissage(Avion* avion); // Autorise l'atterrissage si possible et transmet la trajectoire vers la piste
+    void demanderAtterrissage(Avion* avion, APP* demandeur); // Dpose une demande d'atterrissage, la rponse arrive dans la bote de l'APP
+    void traiterMessages(); // Traite les demandes reues (thread de la tour)
 
     Parking* choisirParkingLibre(); // Trouve un parking libre
     void attribuerParking(Avion* avion, Parking* parking); // Assigne un parking  un avion
     void gererRoulageVersParking(Avion* avion, Parking* parking); // Calcule le trajet vers le parking
 
     void enregistrerPourDecollage(Avion* avion); // Ajoute un avion  la file de dcollage
+    void setMaxDepartsEnCours(size_t max); // Nombre maximal d'avions en roulage ou au point d'attente par piste
     Avion* choisirAvionPourDecollage(); // Slectionne le prochain avion  dcoller
     bool autoriserDecollage(Avion* avion); // Autorise le dcollage
     void retirerAvionDeDecollage(Avion* avion); // Retire l'avion de la file aprs dcollage
 
     void setUrgenceEnCours(bool statut); // Dfinit l'tat d'urgence de la tour
     bool estUrgenceEnCours() const; // Renvoie si une urgence est en cours
+    bool estDecollageEnAttente(size_t indexPiste) const; // Renvoie si un dcollage attend au seuil de cette piste
+
+    void capturer(std::vector<Piste>& pistes, std::vector<Avion*>& fileDecollage) const; // Pistes et file de dcollage sous un mme verrou (pour la sauvegarde)
+    void restaurer(const std::vector<Piste>& pistes, const std::vector<Avion*>& fileDecollage, bool urgenceEnCours); // Reprend l'tat d'une sauvegarde
 };
 
 class APP {
 private:
+    struct EntreeSequence {
+        PrioriteArrivee priorite;
+        std::chrono::steady_clock::time_point heureEstimee; // Heure estime au seuil lors de la prise en charge
+        unsigned long long ordre; // Dpartage deux avions estims au mme instant
+        Avion* avion;
+        bool operator<(const EntreeSequence& autre) const;
+    };
+
+    struct Arrivee {
+        std::set<EntreeSequence>::iterator entree; // Place de l'avion dans la squence
+        size_t piste;
+        bool pisteFixee; // Piste dfinitive ds que la trajectoire est transmise
+        std::chrono::steady_clock::time_point creneau; // Heure d'atterrissage attribue
+        PhaseArrivee phase;
+        bool demandeEnCours; // Demande d'atterrissage envoye  la tour, rponse pas encore reue
+    };
+
     std::vector<Avion*> avionsDansZone_;
-    std::queue<Avion*> fileAttenteAtterrissage_;
+    std::set<EntreeSequence> sequence_; // Squence d'arrive : priorit, puis premier estim premier servi
+    std::unordered_map<Avion*, Arrivee> arrivees_; // Index de la squence par avion
+    unsigned long long compteurSequence_;
     TWR* twr_;
     mutable std::recursive_mutex mutexAPP_;
+    BoiteMessages<MessageAPP> boite_;
+    std::atomic<size_t> nombreDansZone_; // Compteurs publis pour les autres threads
+    std::atomic<size_t> nombreEnAttente_;
+
+    std::vector<Position> trajectoireApproche(size_t indexPiste) const; // Points de passage de l'approche finale
+    std::vector<Position> circuitAttente(Position centre, float rayon, double altitude, int pasAngle) const; // Circuit d'attente circulaire
+    std::chrono::milliseconds tempsVersSeuil(Avion* avion, size_t indexPiste, PhaseArrivee phase) const; // Temps de vol restant jusqu'au seuil
+    PrioriteArrivee evaluerPriorite(Avion* avion, std::chrono::steady_clock::time_point creneau) const; // Urgence, carburant insuffisant au crneau, ou normale
+    void changerPriorite(Avion* avion, PrioriteArrivee priorite); // Replace l'avion dans la squence
+    void retirerDeSequence(Avion* avion); // Retire l'avion de la squence (autoris ou disparu)
+    void sequencer(); // Recalcule les crneaux de toute la squence selon l'occupation des pistes
+    void lancerApproche(Avion* avion); // Transmet la trajectoire d'approche (libration du crneau)
+    void demanderAtterrissage(Avion* avion); // Envoie une demande d'atterrissage  la tour (une seule  la fois par avion)
+    void traiterReponse(Avion* avion, bool accord); // Autorisation : l'avion passe  la tour ; refus : attente
+    void publierCompteurs(); // Met  jour les compteurs lus par le CCR
 
 public:
     APP(TWR* tour);
-    void ajouterAvion(Avion* avion); // Prend en charge un nouvel avion dans la zone
-    void assignerTrajectoireApproche(Avion* avion); // Dfinit la trajectoire d'approche
+    void ajouterAvion(Avion* avion); // Prend en charge un nouvel avion dans la zone et l'insre dans la squence
+    void assignerTrajectoireApproche(Avion* avion); // Attribue un crneau : approche directe ou attente  l'entre de zone
     void mettreEnAttente(Avion* avion); // Place l'avion en circuit d'attente
-    bool demanderAutorisationAtterrissage(Avion* avion); // Demande  la TWR l'autorisation d'atterrir
-    void mettreAJour(); // Met  jour l'tat des avions en approche
+    void traiterMessages(); // Relve la bote : transferts, urgences, fins d'approche, rponses de la tour
+    void mettreAJour(); // Met  jour l'tat des avions en approche (relve d'abord la bote)
     size_t getNombreAvionsDansZone() const; // Renvoie le nombre d'avions grs
     size_t getNombreAvionsEnAttente() const; // Renvoie le nombre d'avions en attente
     void gererUrgence(Avion* avion); // Gre un avion en urgence dans la zone
+    void deposerTransfert(Avion* avion); // Transfert depuis le CCR, trait au prochain relev
+    void signalerUrgence(Avion* avion); // Appel par l'avion qui dclare une urgence dans la zone
+    void signalerFinApproche(Avion* avion); // Appel par l'avion au bout de sa trajectoire d'approche
+    void recevoirReponseAtterrissage(Avion* avion, bool accord); // Appel par la tour
+
+    void capturer(std::vector<Avion*>& avionsDansZone, std::vector<ArriveeSauvegardee>& sequence) const; // Zone et squence sous un mme verrou (pour la sauvegarde)
+    void restaurer(const std::vector<Avion*>& avionsDansZone, const std::vector<ArriveeSauvegardee>& sequence); // Reprend l'tat d'une sauvegarde (sans demande en cours)
 };
 
 class CCR {
+public:
+    using PlanningVols = std::map<std::pair<std::string, std::string>, std::chrono::steady_clock::time_point>; // (dpart, arrive) -> dernier vol valid
+
 private:
     std::vector<Avion*> avionsEnCroisiere_;
-    std::mutex mutexCCR_;
+    ReseauAerien reseau_;
+    mutable std::mutex mutexCCR_;
+    PlanningVols planningVols_; // Evite que trop d'avions partent en mme temps sur un mme trajet
+    mutable std::mutex mutexPlanning_;
+    BoiteMessages<Avion*> prisesEnCharge_; // Avions qui viennent de dcoller
+
+    void traiterMessages(); // Ajoute les avions dposs depuis le dernier cycle
 
 public:
     CCR();
-    void prendreEnCharge(Avion* avion); // Prend en charge un avion en croisire
-    void transfererVersApproche(Avion* avion, APP* appCible); // Transfre l'avion au contrleur d'approche
-    void gererEspaceAerien(); // Gre les collisions et les transferts
+    ReseauAerien& getReseau(); // Renvoie le rseau de voies ariennes (charg avec le scnario)
+    void prendreEnCharge(Avion* avion, const Aeroport* depart); // Donne la route de croisire  l'avion et le dpose dans la bote du CCR
+    void prendreEnCharge(const std::vector<std::pair<Avion*, Aeroport*>>& lot); // Mme chose pour un lot (avion, dpart), dpos en une fois
+    void transfererVersApproche(Avion* avion, APP* appCible); // Dpose l'avion dans la bote du contrleur d'approche
+    void gererEspaceAerien(); // Relve la bote, gre les collisions et les transferts
     bool validerPlanDeVol(Aeroport* depart, Aeroport* arrivee); // Vrifie si le plan de vol est valide
+
+    void capturer(std::vector<Avion*>& enCroisiere, PlanningVols& planning) const; // Avions grs et planning (pour la sauvegarde)
+    void restaurer(const std::vector<Avion*>& enCroisiere, const PlanningVols& planning); // Reprend l'tat d'une sauvegarde
 };
 
 struct Aeroport {
     std::string nom;
     Position position;
     float rayonControle;
+    double rayonControleCarre; // seuilCarreInclus(rayonControle), pour les tests de distance sans racine
     std::vector<Parking> parkings;
+    ReseauRoulage roulage;
+    bool roulagePersonnalise; // Rseau de roulage charg depuis le scnario
     TWR* twr;
     APP* app;
 
     Aeroport(std::string n, Position pos, float rayon); // Constructeur de l'aroport
+    void viderRoulage(); // Supprime les parkings et le rseau de roulage par dfaut (avant chargement du scnario)
+    void construireRoulageParDefaut(); // Rseau par dfaut : chaque piste rejoint la voie de circulation des parkings
+    void preparerRoulage(); // Prcalcule les chemins de roulage une fois le rseau et les pistes chargs
+};
+
+// Sauvegarde binaire de l'tat dynamique du monde : avions, parkings, pistes, files des tours, squences des APP, CCR.
+// Le scnario (aroports, pistes, rseaux) reste celui du fichier de dpart : il doit tre le mme  la restauration.
+// Format versionn, enregistrements de taille fixe aligns sur 8 octets : le fichier peut tre projet en mmoire tel quel.
+class Sauvegarde {
+private:
+    CCR& ccr_;
+    const std::vector<Aeroport*>& aeroports_;
+
+    size_t indexAeroport(const Aeroport* aeroport) const; // Position dans aeroports_ (AUCUN si absent)
+    Aeroport* aeroportLePlusProche(const Position& position) const; // Aroport de dpart d'un avion restaur (nullptr sans aroport)
+
+public:
+    static const uint32_t VERSION = 1;
+
+    Sauvegarde(CCR& ccr, const std::vector<Aeroport*>& aeroports);
+    std::vector<char> capturer(const std::vector<Avion*>& flotte) const; // Image du monde, chaque contrleur verrouill  son tour et brivement
+    void ecrire(const std::string& chemin, const std::vector<char>& image) const; // Fichier temporaire puis renommage : une sauvegarde lisible reste toujours en place
+    std::vector<Avion*> restaurer(const std::string& chemin); // Recre les avions et l'tat des contrleurs (avant le lancement des threads)
+};
+
+// Indicateurs d'une simulation, dures en secondes de temps simul
+struct BilanSimulation {
+    double duree = 0; // Temps simul coul depuis le dmarrage
+    long long atterrissages = 0;
+    long long decollages = 0;
+    double attenteMoyenne = 0; // Temps moyen pass en attente par atterrissage
+    long long roulages = 0;
+    double roulageMoyen = 0; // Dure moyenne d'un roulage (vers la piste ou vers le parking)
+    double utilisationPistes = 0; // Part du temps o les pistes sont occupes, toutes pistes confondues
+    long long crashs = 0; // Avions  court de carburant
+    long long plansRefuses = 0; // Plans de vol refuss par le CCR
+};
+
+// Compteurs aliments par les threads des avions d'une simulation
+class Statistiques {
+private:
+    std::atomic<long long> atterrissages_;
+    std::atomic<long long> attenteMs_;
+    std::atomic<long long> decollages_;
+    std::atomic<long long> roulages_;
+    std::atomic<long long> roulageMs_;
+    std::atomic<long long> crashs_;
+    std::atomic<long long> plansRefuses_;
+
+public:
+    Statistiques();
+    void ajouterAtterrissage(std::chrono::steady_clock::duration attente); // Compte un atterrissage et le temps pass en attente avant
+    void ajouterDecollage(); // Compte un dcollage
+    void ajouterRoulage(std::chrono::steady_clock::duration duree); // Compte un roulage et sa dure
+    void ajouterCrash(); // Compte un avion  court de carburant
+    void ajouterPlanRefuse(); // Compte un plan de vol refus
+    BilanSimulation getBilan() const; // Compteurs et moyennes (la dure et l'utilisation des pistes sont remplies par la simulation)
+};
+
+// Indicateurs d'un aroport sur la fentre glissante (taux ramens  l'heure simule)
+struct IndicateursAeroport {
+    double arriveesHeure = 0;
+    double departsHeure = 0;
+    double attenteMoyenne = 0; // Attente moyenne en vol des avions arrivs dans la fentre (s)
+    double utilisationPistes = 0; // Part du temps de piste occupe dans la fentre, toutes pistes de l'aroport
+    long long parkingsOccupes = 0;
+    size_t parkings = 0;
+};
+
+// Indicateurs en direct pour l'affichage, tenus  jour  chaque vnement (changement d'tat, mouvement, libration de piste ou de parking) :
+// un relev cote le nombre d'aroports, jamais la taille de la flotte.
+// Fentre glissante dcoupe en tranches : les totaux sont augments  chaque vnement et diminus de chaque tranche qui expire.
+class Indicateurs {
+public:
+    static const size_t NOMBRE_ETATS = static_cast<size_t>(EtatAvion::TERMINE) + 1;
+
+private:
+    struct Tranche {
+        long long arrivees = 0;
+        long long departs = 0;
+        double attente = 0; // s
+        double occupationPistes = 0; // s
+    };
+
+    struct FenetreAeroport {
+        std::vector<Tranche> tranches; // Anneau, indic par numro de tranche modulo sa taille
+        Tranche total; // Somme des tranches de l'anneau
+        size_t pistes = 0;
+        size_t parkings = 0;
+        long long parkingsOccupes = 0;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<const Aeroport*, size_t> indices_;
+    std::unordered_map<const Parking*, size_t> indicesParkings_; // Aroport de chaque parking
+    mutable std::vector<FenetreAeroport> aeroports_;
+    std::array<long long, NOMBRE_ETATS> etats_; // Avions actifs par tat (TERMINE : avions sortis)
+    std::chrono::steady_clock::time_point debut_;
+    std::chrono::steady_clock::duration dureeTranche_;
+    mutable long long trancheCourante_; // Numro de la tranche la plus rcente depuis debut_
+
+    FenetreAeroport* trouver(const Aeroport* aeroport); // nullptr si l'aroport n'est pas suivi
+    void avancer(std::chrono::steady_clock::time_point instant) const; // Expire les tranches sorties de la fentre (verrou dj pris)
+    Tranche& trancheCourante(FenetreAeroport& fenetre, std::chrono::steady_clock::time_point instant); // Tranche de l'instant (verrou dj pris)
+
+public:
+    Indicateurs(const std::vector<Aeroport*>& aeroports, std::chrono::steady_clock::time_point debut, std::chrono::seconds fenetre, size_t tranches);
+    Indicateurs(const Indicateurs&) = delete;
+    void operator=(const Indicateurs&) = delete;
+
+    void ajouterAvion(EtatAvion etat); // Avion lanc dans cet tat
+    void changerEtat(EtatAvion avant, EtatAvion apres); // Transition observe par le thread de l'avion
+    void ajouterArrivee(const Aeroport* aeroport, std::chrono::steady_clock::time_point instant, std::chrono::steady_clock::duration attente); // Atterrissage et attente en vol qui l'a prcd
+    void ajouterDepart(const Aeroport* aeroport, std::chrono::steady_clock::time_point instant); // Dcollage
+    void ajouterOccupationPiste(const Aeroport* aeroport, std::chrono::steady_clock::time_point instant, std::chrono::steady_clock::duration duree); // Occupation de piste termine
+    void occuperParking(const Parking* parking); // Parking attribu  un avion
+    void libererParking(const Parking* parking); // Parking quitt
+
+    void relever(std::chrono::steady_clock::time_point instant, std::vector<IndicateursAeroport>& aeroports,
+                 std::array<long long, NOMBRE_ETATS>& etats) const; // Indicateurs par aroport (ordre du scnario) et avions par tat
 };
 
 class Logs {
@@ -205,12 +806,17 @@ private:
     std::ofstream fichier_;
     std::mutex mutex_;
     bool premierElement_;
+    std::chrono::steady_clock::time_point debut_; // Instant simul de l'ouverture, origine du champ Temps
+    static inline std::atomic<bool> actif_ = true;
     Logs();
     ~Logs();
 
 public:
     static Logs& getLogs(); 
-    void log(const std::string& acteur, const std::string& action, const std::string& details); // Enregistre une action dans le fichier log
+    // Enregistre une action dans le fichier log, un lment JSON par ligne (dcoupable par lignes pour l'analyse) ;
+    // avion et aeroport sont des champs  part, omis s'ils sont vides
+    void log(const std::string& acteur, const std::string& action, const std::string& details, const std::string& avion = "", const std::string& aeroport = "");
+    static void setActif(bool actif); // Active ou coupe les logs ; coups avant la premire criture, le fichier n'est pas cr
     Logs(const Logs&) = delete;
     void operator=(const Logs) = delete;
 };
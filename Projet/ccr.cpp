@@ -3,25 +3,16 @@
 #include <stdexcept>
 #include <chrono> 
 
-// Structure pour identifier un trajet unique (du départ à l'arrivée)
-struct TrajetKey {
-    std::string depart;
-    std::string arrivee;
-    bool operator<(const TrajetKey& other) const {
-        if (depart != other.depart) return depart < other.depart;
-        return arrivee < other.arrivee;
-    }
-};
-
-// Gestion globale du planning des vols pour éviter la saturation (que trop d'avions aillent vers un même aéroport)
-static std::map<TrajetKey, std::chrono::steady_clock::time_point> planningVols;
-static std::mutex mutexPlanning;
 const auto DELAI_MIN_ENTRE_VOLS = std::chrono::seconds(15); 
+const double SEPARATION_MINIMALE = 20000.0; // Distance minimale entre deux avions proches en altitude (m)
+const double SEPARATION_MINIMALE_CARRE = seuilCarreStrict(SEPARATION_MINIMALE);
 
 CCR::CCR() {}
 
+ReseauAerien& CCR::getReseau() { return reseau_; }
+
 bool CCR::validerPlanDeVol(Aeroport* depart, Aeroport* arrivee) {
-    std::lock_guard<std::mutex> lock(mutexPlanning);
+    std::lock_guard<std::mutex> lock(mutexPlanning_);
     if (!depart || !arrivee) throw std::invalid_argument("Aeroport NULL");
     
     // Refus si l'aéroport d'arrivée est déjà saturé (file d'attente non vide)
@@ -35,79 +26,87 @@ bool CCR::validerPlanDeVol(Aeroport* depart, Aeroport* arrivee) {
     if (!parkingDispo) return false;
 
     // Vérification du délai minimum entre deux vols sur le même trajet
-    TrajetKey key = { depart->nom, arrivee->nom };
-    auto now = std::chrono::steady_clock::now();
-    if (planningVols.find(key) != planningVols.end()) {
-        if (now - planningVols[key] < DELAI_MIN_ENTRE_VOLS) return false; 
+    auto key = std::make_pair(depart->nom, arrivee->nom);
+    auto now = Horloge::getHorloge().maintenant();
+    if (planningVols_.find(key) != planningVols_.end()) {
+        if (now - planningVols_[key] < DELAI_MIN_ENTRE_VOLS) return false; 
     }
     
     // Validation et enregistrement du vol
-    planningVols[key] = now;
+    planningVols_[key] = now;
     return true;
 }
 
-void CCR::prendreEnCharge(Avion* avion) {
-    std::lock_guard<std::mutex> lock(mutexCCR_);
-    if (!avion) throw std::invalid_argument("Avion NULL");
+void CCR::prendreEnCharge(Avion* avion, const Aeroport* depart) {
+    if (!avion || !depart) throw std::invalid_argument("Avion ou aeroport NULL");
 
-    avionsEnCroisiere_.push_back(avion); // Ajout à la liste des avions gérés par le CCR
     avion->setEtat(EtatAvion::EN_ROUTE);
 
-    // Calcul de la trajectoire de croisière
+    // Route de croisière du trajet : calculée au premier vol, partagée ensuite sans copie
     if (avion->getDestination()) {
-        std::vector<Position> route;
-        Position dep = avion->getPosition();
-        Position dest = avion->getDestination()->position;
-        Position vec = dest - dep;
-        
-        // Point intermédiaire pour simuler une montée/descente progressive
-        Position pt1 = dep + (vec * 0.33);
-        pt1.setPosition(pt1.getX(), pt1.getY(), 10000.0); // Altitude de croisière
-        
-        Position pt2 = dest;
-        pt2.setPosition(pt2.getX(), pt2.getY(), 10000.0);
-
-        route.push_back(pt1);
-        route.push_back(pt2);
-        avion->setTrajectoire(route);
+        avion->setTrajectoire(reseau_.getRoute(depart, avion->getDestination()));
+    }
+    prisesEnCharge_.deposer(avion); // Ajouté à la liste du CCR à son prochain cycle, sans attendre mutexCCR_
+}
+
+void CCR::prendreEnCharge(const std::vector<std::pair<Avion*, Aeroport*>>& lot) {
+    std::vector<Avion*> avions;
+    avions.reserve(lot.size());
+    for (const auto& [avion, depart] : lot) {
+        if (!avion || !depart) throw std::invalid_argument("Avion ou aeroport NULL");
+        avion->setEtat(EtatAvion::EN_ROUTE);
+        if (avion->getDestination()) avion->setTrajectoire(reseau_.getRoute(depart, avion->getDestination()));
+        avions.push_back(avion);
+    }
+    prisesEnCharge_.deposerLot(std::move(avions));
+}
+
+void CCR::traiterMessages() {
+    for (Avion* avion : prisesEnCharge_.relever()) {
+        avionsEnCroisiere_.push_back(avion); // Ajout à la liste des avions gérés par le CCR
+        std::cout << "[CCR] Prise en charge " << avion->getNom() << ".\n";
+        Logs::getLogs().log("CCR", "Prise en charge", "Avion " + avion->getNom(), avion->getNom());
     }
-    std::cout << "[CCR] Prise en charge " << avion->getNom() << ".\n";
-    Logs::getLogs().log("CCR", "Prise en charge", "Avion " + avion->getNom());
 }
 
 void CCR::transfererVersApproche(Avion* avion, APP* appCible) {
     if (!avion || !appCible) throw std::invalid_argument("Avion ou APP NULL");
     std::cout << "[CCR] Transfert " << avion->getNom() << " vers APP.\n";
-    
-    appCible->ajouterAvion(avion); // Transfert de responsabilité à l'APP
-    avion->setEtat(EtatAvion::EN_APPROCHE);
-    
-    // Gestion immédiate si urgence, sinon procédure standard
-    if (avion->estEnUrgence()) appCible->gererUrgence(avion);
-    else appCible->assignerTrajectoireApproche(avion);
-    
-    Logs::getLogs().log("CCR", "Transfert vers APP", "Avion " + avion->getNom());
+
+    appCible->deposerTransfert(avion); // L'APP le prend en charge à son prochain relevé, le CCR n'attend pas son verrou
+
+    Logs::getLogs().log("CCR", "Transfert vers APP", "Avion " + avion->getNom(), avion->getNom());
 }
 
 void CCR::gererEspaceAerien() {
     std::lock_guard<std::mutex> lock(mutexCCR_);
+    traiterMessages();
+
+    // Un instantané par avion pour tout le cycle : les comparaisons portent sur des états cohérents
+    std::vector<InstantaneAvion> instantanes;
+    instantanes.reserve(avionsEnCroisiere_.size());
+    for (Avion* avion : avionsEnCroisiere_) instantanes.push_back(avion->getInstantane());
 
     // Détection et résolution des conflits (collisions)
     for (size_t i = 0; i < avionsEnCroisiere_.size(); ++i) {
         for (size_t j = i + 1; j < avionsEnCroisiere_.size(); ++j) {
             Avion* a1 = avionsEnCroisiere_[i];
             Avion* a2 = avionsEnCroisiere_[j];
+            Position& p1 = instantanes[i].position;
+            Position& p2 = instantanes[j].position;
             
             // Si différence d'altitude suffisante, pas de conflit
-            if (std::abs(a1->getPosition().getAltitude() - a2->getPosition().getAltitude()) >= 1000) continue;
+            if (std::abs(p1.getAltitude() - p2.getAltitude()) >= 1000) continue;
 
             // Si trop proches horizontalement, résolution par changement d'altitude
-            if (a1->getPosition().distance(a2->getPosition()) < 20000.0) {
+            if (p1.distanceCarre(p2) < SEPARATION_MINIMALE_CARRE) {
                 std::cout << "[CCR] Alerte collision : " << a1->getNom() << " / " << a2->getNom() << ".\n";
-                Position p1 = a1->getPosition();
-                a1->setPosition({p1.getX(), p1.getY(), p1.getAltitude() + 500});
-                Position p2 = a2->getPosition();
-                a2->setPosition({p2.getX(), p2.getY(), p2.getAltitude() - 500});
+                p1 = a1->getPosition(); // Position à jour au moment de la modifier
+                p1.setPosition(p1.getX(), p1.getY(), p1.getAltitude() + 500);
+                a1->setPosition(p1);
+                p2 = a2->getPosition();
+                p2.setPosition(p2.getX(), p2.getY(), p2.getAltitude() - 500);
+                a2->setPosition(p2);
             }
         }
     }
@@ -115,16 +114,16 @@ void CCR::gererEspaceAerien() {
     // Gestion des transferts vers l'approche (APP)
     for (auto it = avionsEnCroisiere_.begin(); it != avionsEnCroisiere_.end(); ) {
         Avion* avion = *it;
-        Aeroport* dest = avion->getDestination();
+        InstantaneAvion etat = avion->getInstantane();
+        Aeroport* dest = etat.destination;
 
-        if (!dest || avion->getEtat() != EtatAvion::EN_ROUTE) {
+        if (!dest || etat.etat != EtatAvion::EN_ROUTE) {
             ++it;
             continue;
         }
 
-        double dist = avion->getPosition().distance(dest->position);
         // Transfert si proche de la destination ou en urgence
-        if (avion->estEnUrgence() || dist <= dest->rayonControle) {
+        if (etat.estEnUrgence() || etat.position.distanceCarre(dest->position) <= dest->rayonControleCarre) {
             transfererVersApproche(avion, dest->app);
             it = avionsEnCroisiere_.erase(it); // Retrait de la liste CCR
         } else {
@@ -133,7 +132,25 @@ void CCR::gererEspaceAerien() {
     }
 }
 
-Aeroport::Aeroport(std::string n, Position pos, float r) : nom(n), position(pos), rayonControle(r) {
+void CCR::capturer(std::vector<Avion*>& enCroisiere, PlanningVols& planning) const {
+    {
+        std::lock_guard<std::mutex> lock(mutexCCR_);
+        enCroisiere = avionsEnCroisiere_;
+    }
+    std::lock_guard<std::mutex> lock(mutexPlanning_);
+    planning = planningVols_;
+}
+
+void CCR::restaurer(const std::vector<Avion*>& enCroisiere, const PlanningVols& planning) {
+    {
+        std::lock_guard<std::mutex> lock(mutexCCR_);
+        avionsEnCroisiere_ = enCroisiere;
+    }
+    std::lock_guard<std::mutex> lock(mutexPlanning_);
+    planningVols_ = planning;
+}
+
+Aeroport::Aeroport(std::string n, Position pos, float r) : nom(n), position(pos), rayonControle(r), rayonControleCarre(seuilCarreInclus(static_cast<double>(r))), roulagePersonnalise(false) {
     Position posPiste(pos.getX(), pos.getY(), 0);
     // Création des parkings par défaut pour chaque aéroport
     parkings.push_back(Parking(n + "-P1", pos + Position(100, 400, 0)));
@@ -143,6 +160,45 @@ Aeroport::Aeroport(std::string n, Position pos, float r) : nom(n), position(pos)
     parkings.push_back(Parking(n + "-P5", pos + Position(900, 400, 0)));
     
     // Initialisation des contrôleurs (TWR et APP)
-    twr = new TWR(parkings, posPiste, 5000.f);
+    twr = new TWR(n, parkings, roulage, posPiste, 5000.f);
     app = new APP(twr);
+
+    preparerRoulage();
 }
+
+void Aeroport::construireRoulageParDefaut() {
+    // Voie de circulation à +200 m, chaque parking s'y raccorde
+    roulage.vider();
+    Position posVoie = position + Position(0, 200, 0);
+    roulage.ajouterNoeud("VOIE", posVoie);
+    std::string precedent = "VOIE";
+    for (const auto& parking : parkings) {
+        std::string noeud = parking.getNom() + "-V";
+        roulage.ajouterNoeud(noeud, Position(parking.getPosition().getX(), posVoie.getY(), 0));
+        roulage.ajouterArc(precedent, noeud);
+        roulage.relierParking(noeud);
+        precedent = noeud;
+    }
+
+    // Chaque seuil de piste sert à la fois de sortie et de point d'attente
+    std::vector<Piste> pistes = twr->getPistes();
+    for (size_t i = 0; i < pistes.size(); ++i) {
+        std::string noeud = "PISTE-" + pistes[i].getNom();
+        roulage.ajouterNoeud(noeud, pistes[i].getSeuil());
+        roulage.ajouterArc(noeud, "VOIE");
+        roulage.definirSortiePiste(noeud, i);
+        roulage.definirPointAttente(noeud, i);
+    }
+}
+
+void Aeroport::viderRoulage() {
+    parkings.clear();
+    roulage.vider();
+    roulagePersonnalise = true;
+}
+
+void Aeroport::preparerRoulage() {
+    if (parkings.empty()) throw std::runtime_error("Aeroport " + nom + " sans parking");
+    if (!roulagePersonnalise) construireRoulageParDefaut();
+    roulage.precalculerChemins(parkings, twr->getPistes());
+}
\ No newline at end of file
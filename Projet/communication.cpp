@@ -1,6 +1,7 @@
 ﻿#include "avion.hpp"
 #include <filesystem>
 #include <stdexcept>
+#include <cstdio>
 
 // Surcharge de l'opérateur << pour afficher une pos de manière lisible
 std::ostream& operator<<(std::ostream& os, const Position& pos) {
@@ -14,7 +15,24 @@ std::ostream& operator<<(std::ostream& os, const Avion& avion) {
     return os;
 }
 
-Logs::Logs() : premierElement_(true) {
+// Chaîne JSON : guillemets, barres obliques inverses et caractères de contrôle échappés
+static std::string echapperJSON(const std::string& texte) {
+    std::string resultat;
+    resultat.reserve(texte.size() + 2);
+    resultat += '"';
+    for (char c : texte) {
+        if (c == '"' || c == '\\') { resultat += '\\'; resultat += c; }
+        else if (c == '\n') resultat += "\\n";
+        else if (static_cast<unsigned char>(c) < 0x20) resultat += ' ';
+        else resultat += c;
+    }
+    resultat += '"';
+    return resultat;
+}
+
+Logs::Logs() : premierElement_(true), debut_(Horloge::getHorloge().maintenant()) {
+    if (!actif_) return; // Logs coupés dès le départ (simulations en lot) : le fichier existant est conservé
+
     // Calcul du chemin absolu vers le fichier de logs (dans le dossier img du projet)
     std::filesystem::path cheminFichierSource = __FILE__;
     std::filesystem::path dossierProjet = cheminFichierSource.parent_path();
@@ -43,19 +61,25 @@ Logs& Logs::getLogs() {
     return log;
 }
 
-void Logs::log(const std::string& acteur, const std::string& action, const std::string& details) {
+void Logs::setActif(bool actif) { actif_ = actif; }
+
+void Logs::log(const std::string& acteur, const std::string& action, const std::string& details, const std::string& avion, const std::string& aeroport) {
+    if (!actif_) return;
+    PORTEE_ALLOCATIONS("Logs"); // Les chaînes passées en argument restent comptées chez l'appelant
+    double temps = std::chrono::duration<double>(Horloge::getHorloge().maintenant() - debut_).count(); // Secondes simulées
     std::lock_guard<std::mutex> lock(mutex_); 
 
     if (fichier_.is_open()) {
         // virgule entre les éléments (sauf pour le premier)
         if (!premierElement_) fichier_ << ",\n";
 
-        // Écriture structurée de l'event
-        fichier_ << "  {\n";
-        fichier_ << "    \"Controleur\": \"" << acteur << "\",\n";
-        fichier_ << "    \"Action\": \"" << action << "\",\n";
-        fichier_ << "    \"Details\": \"" << details << "\"\n";
-        fichier_ << "  }";
+        // Écriture structurée de l'event, sur une seule ligne
+        char horodatage[32];
+        std::snprintf(horodatage, sizeof(horodatage), "%.3f", temps);
+        fichier_ << "  {\"Temps\": " << horodatage << ", \"Controleur\": " << echapperJSON(acteur);
+        if (!aeroport.empty()) fichier_ << ", \"Aeroport\": " << echapperJSON(aeroport);
+        if (!avion.empty()) fichier_ << ", \"Avion\": " << echapperJSON(avion);
+        fichier_ << ", \"Action\": " << echapperJSON(action) << ", \"Details\": " << echapperJSON(details) << "}";
         premierElement_ = false;
     }
 }
\ No newline at end of file
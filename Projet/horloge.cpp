@@ -0,0 +1,54 @@
+#include "avion.hpp"
+#include <stdexcept>
+#include <thread>
+#include <condition_variable>
+
+const double FACTEUR_MIN = 0.125;
+const double FACTEUR_MAX = 64.0;
+const auto TRANCHE_PAUSE = std::chrono::milliseconds(100); // Une pause longue se fait par tranches pour suivre un changement de facteur
+
+Horloge::Horloge() {
+    auto maintenant = std::chrono::steady_clock::now();
+    repere_.ecrire({ maintenant, maintenant, 1.0 }); // Au départ, temps simulé = temps réel
+}
+
+Horloge& Horloge::getHorloge() {
+    static Horloge instance;
+    return instance;
+}
+
+std::chrono::steady_clock::time_point Horloge::maintenant() const {
+    Repere r = repere_.lire();
+    auto ecoule = std::chrono::steady_clock::now() - r.reel;
+    return r.simule + std::chrono::duration_cast<std::chrono::steady_clock::duration>(ecoule * r.facteur);
+}
+
+double Horloge::getFacteur() const { return repere_.lire().facteur; }
+
+void Horloge::setFacteur(double facteur) {
+    if (facteur < FACTEUR_MIN || facteur > FACTEUR_MAX) throw std::out_of_range("Facteur de compression du temps hors limites");
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto reel = std::chrono::steady_clock::now();
+    Repere r = repere_.lire();
+    auto simule = r.simule + std::chrono::duration_cast<std::chrono::steady_clock::duration>((reel - r.reel) * r.facteur);
+    repere_.ecrire({ reel, simule, facteur });
+}
+
+std::chrono::nanoseconds Horloge::versDureeReelle(std::chrono::nanoseconds dureeSimulee) const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(dureeSimulee / getFacteur());
+}
+
+bool Horloge::pause(std::chrono::milliseconds dureeSimulee, std::stop_token arret) const {
+    auto fin = maintenant() + dureeSimulee;
+    // La demande d'arrêt réveille l'attente aussitôt (rappel enregistré par wait_for), sans attendre la fin de la tranche.
+    // Mutex et condition propres au thread, construits une fois : condition_variable_any alloue à sa construction.
+    thread_local std::mutex mutex;
+    thread_local std::condition_variable_any reveil;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!arret.stop_requested()) {
+        auto reste = fin - maintenant();
+        if (reste <= std::chrono::steady_clock::duration::zero()) return true;
+        reveil.wait_for(lock, arret, std::min<std::chrono::nanoseconds>(versDureeReelle(reste), TRANCHE_PAUSE), []() { return false; });
+    }
+    return false;
+}
\ No newline at end of file
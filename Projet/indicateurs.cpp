@@ -0,0 +1,135 @@
+#include "avion.hpp"
+#include <stdexcept>
+
+Indicateurs::Indicateurs(const std::vector<Aeroport*>& aeroports, std::chrono::steady_clock::time_point debut, std::chrono::seconds fenetre, size_t tranches)
+    : etats_(), debut_(debut), dureeTranche_(), trancheCourante_(0) {
+    if (fenetre.count() <= 0 || tranches == 0) throw std::invalid_argument("Fenetre des indicateurs invalide");
+    dureeTranche_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(fenetre) / static_cast<long long>(tranches);
+    if (dureeTranche_.count() <= 0) throw std::invalid_argument("Tranches des indicateurs trop courtes");
+
+    aeroports_.resize(aeroports.size());
+    for (size_t i = 0; i < aeroports.size(); ++i) {
+        indices_[aeroports[i]] = i;
+        aeroports_[i].tranches.assign(tranches, Tranche());
+        aeroports_[i].pistes = aeroports[i]->twr->getNombrePistes();
+        aeroports_[i].parkings = aeroports[i]->parkings.size();
+        for (const Parking& parking : aeroports[i]->parkings) {
+            indicesParkings_[&parking] = i;
+            if (parking.estOccupe()) ++aeroports_[i].parkingsOccupes; // Parkings d'une sauvegarde restaurée
+        }
+    }
+}
+
+Indicateurs::FenetreAeroport* Indicateurs::trouver(const Aeroport* aeroport) {
+    auto it = indices_.find(aeroport);
+    return it == indices_.end() ? nullptr : &aeroports_[it->second];
+}
+
+void Indicateurs::avancer(std::chrono::steady_clock::time_point instant) const {
+    if (instant < debut_) return;
+    long long numero = (instant - debut_) / dureeTranche_;
+    if (numero <= trancheCourante_) return;
+
+    // Chaque tranche qui entre dans l'anneau remplace la plus ancienne, retirée des totaux ; au-delà d'un tour, tout a expiré
+    for (FenetreAeroport& fenetre : aeroports_) {
+        long long taille = static_cast<long long>(fenetre.tranches.size());
+        if (numero - trancheCourante_ >= taille) {
+            std::fill(fenetre.tranches.begin(), fenetre.tranches.end(), Tranche());
+            fenetre.total = Tranche();
+            continue;
+        }
+        for (long long n = trancheCourante_ + 1; n <= numero; ++n) {
+            Tranche& ancienne = fenetre.tranches[static_cast<size_t>(n % taille)];
+            fenetre.total.arrivees -= ancienne.arrivees;
+            fenetre.total.departs -= ancienne.departs;
+            fenetre.total.attente -= ancienne.attente;
+            fenetre.total.occupationPistes -= ancienne.occupationPistes;
+            ancienne = Tranche();
+        }
+    }
+    trancheCourante_ = numero;
+}
+
+Indicateurs::Tranche& Indicateurs::trancheCourante(FenetreAeroport& fenetre, std::chrono::steady_clock::time_point instant) {
+    avancer(instant);
+    // Un événement horodaté un peu avant le dernier relevé compte dans la tranche courante
+    return fenetre.tranches[static_cast<size_t>(trancheCourante_ % static_cast<long long>(fenetre.tranches.size()))];
+}
+
+void Indicateurs::ajouterAvion(EtatAvion etat) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++etats_[static_cast<size_t>(etat)];
+}
+
+void Indicateurs::changerEtat(EtatAvion avant, EtatAvion apres) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --etats_[static_cast<size_t>(avant)];
+    ++etats_[static_cast<size_t>(apres)];
+}
+
+void Indicateurs::ajouterArrivee(const Aeroport* aeroport, std::chrono::steady_clock::time_point instant, std::chrono::steady_clock::duration attente) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FenetreAeroport* fenetre = trouver(aeroport);
+    if (!fenetre) return;
+    double secondes = std::chrono::duration<double>(attente).count();
+    Tranche& tranche = trancheCourante(*fenetre, instant);
+    ++tranche.arrivees;
+    tranche.attente += secondes;
+    ++fenetre->total.arrivees;
+    fenetre->total.attente += secondes;
+}
+
+void Indicateurs::ajouterDepart(const Aeroport* aeroport, std::chrono::steady_clock::time_point instant) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FenetreAeroport* fenetre = trouver(aeroport);
+    if (!fenetre) return;
+    ++trancheCourante(*fenetre, instant).departs;
+    ++fenetre->total.departs;
+}
+
+void Indicateurs::ajouterOccupationPiste(const Aeroport* aeroport, std::chrono::steady_clock::time_point instant, std::chrono::steady_clock::duration duree) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FenetreAeroport* fenetre = trouver(aeroport);
+    if (!fenetre) return;
+    double secondes = std::chrono::duration<double>(duree).count();
+    trancheCourante(*fenetre, instant).occupationPistes += secondes;
+    fenetre->total.occupationPistes += secondes;
+}
+
+void Indicateurs::occuperParking(const Parking* parking) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = indicesParkings_.find(parking);
+    if (it != indicesParkings_.end()) ++aeroports_[it->second].parkingsOccupes;
+}
+
+void Indicateurs::libererParking(const Parking* parking) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = indicesParkings_.find(parking);
+    if (it != indicesParkings_.end()) --aeroports_[it->second].parkingsOccupes;
+}
+
+void Indicateurs::relever(std::chrono::steady_clock::time_point instant, std::vector<IndicateursAeroport>& aeroports,
+                          std::array<long long, NOMBRE_ETATS>& etats) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    avancer(instant);
+    etats = etats_;
+
+    // Avant que la fenêtre soit pleine, les taux sont rapportés au temps écoulé depuis le début
+    double duree = 0;
+    if (instant > debut_) {
+        auto fenetre = dureeTranche_ * static_cast<long long>(aeroports_.empty() ? 0 : aeroports_[0].tranches.size());
+        duree = std::chrono::duration<double>(std::min<std::chrono::steady_clock::duration>(instant - debut_, fenetre)).count();
+    }
+
+    aeroports.resize(aeroports_.size());
+    for (size_t i = 0; i < aeroports_.size(); ++i) {
+        const FenetreAeroport& fenetre = aeroports_[i];
+        IndicateursAeroport& a = aeroports[i];
+        a.parkingsOccupes = fenetre.parkingsOccupes;
+        a.parkings = fenetre.parkings;
+        a.arriveesHeure = duree > 0 ? static_cast<double>(fenetre.total.arrivees) * 3600.0 / duree : 0;
+        a.departsHeure = duree > 0 ? static_cast<double>(fenetre.total.departs) * 3600.0 / duree : 0;
+        a.attenteMoyenne = fenetre.total.arrivees > 0 ? fenetre.total.attente / static_cast<double>(fenetre.total.arrivees) : 0;
+        a.utilisationPistes = (duree > 0 && fenetre.pistes > 0) ? std::min(1.0, fenetre.total.occupationPistes / (duree * static_cast<double>(fenetre.pistes))) : 0;
+    }
+}
\ No newline at end of file
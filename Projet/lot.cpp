@@ -0,0 +1,220 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <cmath>
+#include <string>
+#include <filesystem>
+#include <stdexcept>
+#include <exception>
+#include <functional>
+#include <algorithm>
+#include <streambuf>
+
+#include "avion.hpp"
+#include "thread.hpp"
+
+// Lanceur de simulations en lot (sans affichage) : K mondes indépendants, chacun avec sa graine,
+// exécutés en parallèle puis résumés par indicateur (moyenne et intervalle de confiance à 95 %).
+// Usage : SimulationLot [--scenario fichier] [--instances n] [--duree s] [--facteur f] [--graine g] [--paralleles n]
+//                       [--allocations 0|1] [--trajectoires dossier] [--help]
+
+static const char* USAGE =
+    "Usage : SimulationLot [options]\n"
+    "  --scenario fichier      Scenario charge par chaque instance (debut.txt)\n"
+    "  --instances n           Nombre de simulations (8)\n"
+    "  --duree s               Temps simule par instance (600)\n"
+    "  --facteur f             Compression du temps, commune a toutes les instances (16)\n"
+    "  --graine g              Graine de la premiere instance, les suivantes incrementent (1)\n"
+    "  --paralleles n          Instances simultanees, 0 : une par coeur (0)\n"
+    "  --allocations 0|1       Allocations par pas simule (build PROFIL_ALLOCATIONS) (0)\n"
+    "  --trajectoires dossier  Archive des trajectoires de chaque instance dans ce dossier\n"
+    "  --help                  Affiche cette aide\n";
+
+struct OptionsLot {
+    std::string scenario = "debut.txt";
+    int instances = 8;
+    double duree = 600.0; // Temps simulé par instance (s)
+    double facteur = 16.0; // Compression du temps, partagée par toutes les instances
+    unsigned int graine = 1; // Graine de la première instance, les suivantes incrémentent
+    int paralleles = 0; // Instances simultanées (0 : un par coeur)
+    bool allocations = false; // Allocations par pas simulé, toutes instances confondues (build PROFIL_ALLOCATIONS)
+    std::string trajectoires; // Dossier des archives de trajectoires, une par instance (vide : aucune)
+    bool aide = false; // --help : usage affiché, aucune simulation
+};
+
+const std::chrono::milliseconds PERIODE_TRAJECTOIRES(1000); // Période simulée des archives de trajectoires
+
+// Flux qui ignore tout ce qu'il reçoit, sans état : utilisable depuis tous les threads à la fois
+class FluxNul : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+// Quantile 0,975 de la loi de Student selon le nombre de degrés de liberté (au-delà de 30, loi normale)
+static double quantileStudent(int degres) {
+    static const double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (degres < 1) return 0;
+    if (degres <= 30) return table[degres - 1];
+    return 1.96;
+}
+
+static OptionsLot lireOptions(int argc, char* argv[]) {
+    OptionsLot options;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--help" || option == "-h") {
+            options.aide = true;
+            return options;
+        }
+        if (i + 1 >= argc) throw std::runtime_error("Valeur manquante pour " + option + "\n" + USAGE);
+        std::string valeur = argv[++i];
+        if (option == "--scenario") options.scenario = valeur;
+        else if (option == "--instances") options.instances = std::stoi(valeur);
+        else if (option == "--duree") options.duree = std::stod(valeur);
+        else if (option == "--facteur") options.facteur = std::stod(valeur);
+        else if (option == "--graine") options.graine = static_cast<unsigned int>(std::stoul(valeur));
+        else if (option == "--paralleles") options.paralleles = std::stoi(valeur);
+        else if (option == "--allocations") options.allocations = (std::stoi(valeur) != 0);
+        else if (option == "--trajectoires") options.trajectoires = valeur;
+        else throw std::runtime_error("Option inconnue : " + option + "\n" + USAGE);
+    }
+    if (options.instances < 1) throw std::runtime_error("Nombre d'instances invalide");
+    if (options.duree <= 0) throw std::runtime_error("Duree invalide");
+    if (options.paralleles < 0) throw std::runtime_error("Nombre d'instances simultanees invalide");
+    if (options.allocations && !ProfilAllocations::estActif()) throw std::runtime_error("--allocations demande le build PROFIL_ALLOCATIONS");
+    if (!options.trajectoires.empty()) std::filesystem::create_directories(options.trajectoires);
+    if (options.paralleles == 0) options.paralleles = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    // Scénario cherché aussi à côté de l'exécutable, comme le simulateur graphique
+    if (!std::filesystem::exists(options.scenario) && argc > 0) {
+        std::filesystem::path voisin = std::filesystem::absolute(argv[0]).parent_path() / options.scenario;
+        if (std::filesystem::exists(voisin)) options.scenario = voisin.string();
+    }
+    return options;
+}
+
+// Une instance : monde complet, démarré puis arrêté au bout de la durée simulée ; dureeArret reçoit le temps réel de l'arrêt (ms)
+static BilanSimulation executerInstance(const OptionsLot& options, unsigned int graine, double& dureeArret) {
+    Simulation simulation(options.scenario, graine);
+    simulation.demarrer();
+    if (!options.trajectoires.empty()) {
+        std::filesystem::path archive = std::filesystem::path(options.trajectoires) / ("trajectoires_" + std::to_string(graine) + ".bin");
+        simulation.archiverTrajectoires(archive.string(), PERIODE_TRAJECTOIRES);
+    }
+    Horloge::getHorloge().pause(std::chrono::milliseconds(static_cast<long long>(options.duree * 1000.0)));
+    BilanSimulation bilan = simulation.getBilan();
+    auto debut = std::chrono::steady_clock::now();
+    simulation.arreter();
+    dureeArret = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - debut).count();
+    return bilan;
+}
+
+// Moyenne, écart-type et demi-largeur de l'intervalle de confiance d'un indicateur sur toutes les instances
+static void afficherIndicateur(const std::string& nom, const std::vector<BilanSimulation>& bilans, std::function<double(const BilanSimulation&)> valeur) {
+    size_t n = bilans.size();
+    double somme = 0, minimum = valeur(bilans[0]), maximum = minimum;
+    for (const auto& b : bilans) {
+        double v = valeur(b);
+        somme += v;
+        minimum = std::min(minimum, v);
+        maximum = std::max(maximum, v);
+    }
+    double moyenne = somme / static_cast<double>(n);
+    double ecarts = 0;
+    for (const auto& b : bilans) ecarts += (valeur(b) - moyenne) * (valeur(b) - moyenne);
+    double ecartType = (n > 1) ? std::sqrt(ecarts / static_cast<double>(n - 1)) : 0.0;
+    double demiLargeur = quantileStudent(static_cast<int>(n) - 1) * ecartType / std::sqrt(static_cast<double>(n));
+
+    std::cout << std::left << std::setw(30) << nom << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << moyenne << "  +/- " << std::setw(10) << demiLargeur
+              << std::setw(12) << ecartType << std::setw(12) << minimum << std::setw(12) << maximum << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        OptionsLot options = lireOptions(argc, argv);
+        if (options.aide) {
+            std::cout << USAGE;
+            return 0;
+        }
+        Horloge::getHorloge().setFacteur(options.facteur);
+        Logs::setActif(false); // Un fichier de logs pour des instances mêlées serait illisible
+
+        std::cout << "--- SIMULATIONS EN LOT ---\n";
+        std::cout << options.instances << " instances de " << options.duree << " s simulees (temps x" << options.facteur << "), "
+                  << options.paralleles << " a la fois, graines " << options.graine << " a " << options.graine + options.instances - 1 << "\n";
+
+        // Les traces des simulations sont coupées pendant les exécutions, seule la progression s'affiche (sur la sortie d'erreur)
+        std::vector<BilanSimulation> bilans(options.instances);
+        std::vector<double> arrets(options.instances, 0.0);
+        std::vector<std::exception_ptr> erreurs(options.instances);
+        std::atomic<int> suivante(0);
+        std::atomic<int> terminees(0);
+        std::mutex mutexProgression;
+        auto debut = std::chrono::steady_clock::now();
+        std::vector<CompteAllocations> allocationsAvant = ProfilAllocations::relever();
+        FluxNul fluxNul;
+        std::streambuf* sortie = std::cout.rdbuf(&fluxNul);
+
+        std::vector<std::thread> executeurs;
+        for (int e = 0; e < std::min(options.paralleles, options.instances); ++e) {
+            executeurs.emplace_back([&]() {
+                for (int i = suivante++; i < options.instances; i = suivante++) {
+                    try {
+                        bilans[i] = executerInstance(options, options.graine + static_cast<unsigned int>(i), arrets[i]);
+                    }
+                    catch (...) {
+                        erreurs[i] = std::current_exception();
+                    }
+                    std::lock_guard<std::mutex> lock(mutexProgression);
+                    std::cerr << "[LOT] Instance " << i << " terminee (" << ++terminees << "/" << options.instances << ")\n";
+                }
+            });
+        }
+        for (auto& t : executeurs) t.join();
+        std::cout.rdbuf(sortie);
+        for (auto& erreur : erreurs) if (erreur) std::rethrow_exception(erreur);
+        auto duree = std::chrono::duration<double>(std::chrono::steady_clock::now() - debut);
+
+        // Détail par instance
+        std::cout << "\nGraine   Atterr.  Decoll.  Attente(s)  Roulage(s)  Pistes(%)  Crashs  Refus\n";
+        for (int i = 0; i < options.instances; ++i) {
+            const BilanSimulation& b = bilans[i];
+            std::cout << std::left << std::setw(8) << options.graine + i << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(8) << b.atterrissages << std::setw(9) << b.decollages << std::setw(12) << b.attenteMoyenne
+                      << std::setw(12) << b.roulageMoyen << std::setw(11) << 100.0 * b.utilisationPistes
+                      << std::setw(8) << b.crashs << std::setw(7) << b.plansRefuses << "\n";
+        }
+
+        // Résumé : intervalle de confiance à 95 % de la moyenne (loi de Student à K-1 degrés de liberté)
+        std::cout << "\n" << std::left << std::setw(30) << "Indicateur" << std::right << std::setw(12) << "Moyenne" << "  IC 95 %      "
+                  << std::setw(11) << "Ecart-type" << std::setw(12) << "Min" << std::setw(12) << "Max" << "\n";
+        afficherIndicateur("Attente par atterrissage (s)", bilans, [](const BilanSimulation& b) { return b.attenteMoyenne; });
+        afficherIndicateur("Duree de roulage (s)", bilans, [](const BilanSimulation& b) { return b.roulageMoyen; });
+        afficherIndicateur("Utilisation des pistes (%)", bilans, [](const BilanSimulation& b) { return 100.0 * b.utilisationPistes; });
+        afficherIndicateur("Crashs", bilans, [](const BilanSimulation& b) { return static_cast<double>(b.crashs); });
+        afficherIndicateur("Plans de vol refuses", bilans, [](const BilanSimulation& b) { return static_cast<double>(b.plansRefuses); });
+        afficherIndicateur("Atterrissages", bilans, [](const BilanSimulation& b) { return static_cast<double>(b.atterrissages); });
+        afficherIndicateur("Decollages", bilans, [](const BilanSimulation& b) { return static_cast<double>(b.decollages); });
+
+        // Allocations de toutes les instances, rapportées au nombre total de pas des avions simulés
+        if (options.allocations) {
+            double pas = options.duree * 1000.0 / PAS_AVION_MS * options.instances;
+            std::cout << "\nAllocations par pas simule (" << std::setprecision(0) << pas << " pas)\n";
+            ProfilAllocations::ecrireRapport(std::cout, allocationsAvant, ProfilAllocations::relever(), pas);
+        }
+        std::cout << "\n" << options.instances << " simulations en " << std::setprecision(1) << duree.count() << " s, arret le plus long "
+                  << *std::max_element(arrets.begin(), arrets.end()) << " ms (pas des avions : " << PAS_AVION_MS << " ms simules)\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Erreur " << e.what() << "\n";
+        return -1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <sstream>
 #include <filesystem>
 #include <stdexcept>
+#include <algorithm>
+#include <memory>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
@@ -31,35 +33,119 @@ void setRepertoire(const char* executablePath) {
     std::filesystem::current_path(path.parent_path());
 }
 
-// Variables globales pour la gestion des threads et des avions
-std::vector<std::thread> threads_infra;
-std::vector<Avion*> flotte;
-std::mutex mutexFlotte;
-
 // Variables globales pour l'interaction utilisateur
 Avion* avionSelectionne = nullptr;
 Aeroport* aeroportVue = nullptr;
 
+const unsigned int THREADS_ENCODAGE = 2; // Threads de relecture et d'encodage des images enregistrées
+const size_t FILE_ENCODAGE = 8; // Captures en attente d'encodage au plus
+const unsigned int TAILLE_TUILE = 256; // Côté des tuiles du fond de carte (px)
+const size_t BUDGET_TUILES = 64 * 1024 * 1024; // Octets de texture du fond de carte au plus
+const float RAYON_CLIC_AEROPORT = 50.f; // Distance maximale d'un clic au symbole d'un aéroport (px)
+
 int main(int argc, char* argv[]) {
     try {
-        // Initialisation de l'aléatoire et du répertoire de travail
-        std::srand(static_cast<unsigned int>(time(NULL)));
+        // Options : --restaurer fichier (départ depuis une sauvegarde), --checkpoint fichier [période en s] (sauvegardes périodiques),
+        // --telemetrie [nom] (publication en mémoire partagée pour les visualiseurs externes),
+        // --enregistrer dossier [période en ms simulées] (images hors écran), --format png|brut, --duree s (arrêt après s secondes simulées),
+        // --sans-fenetre (enregistrement seul, sans écran : demande --enregistrer et --duree),
+        // --allocations [période en s] (allocations par pas simulé et par portée : build PROFIL_ALLOCATIONS),
+        // --carte image (fond de carte, découpé en tuiles au premier lancement à côté de l'image),
+        // --trajectoires fichier [période en ms simulées] (positions de toute la flotte, relues par l'outil Trajectoires)
+        std::string fichierRestauration, fichierSauvegarde, segmentTelemetrie, dossierEnregistrement, fichierCarte, fichierTrajectoires;
+        int periodeSauvegarde = 60;
+        int periodeAllocations = 0;
+        int periodeEnregistrement = 100;
+        int periodeTrajectoires = 1000;
+        int dureeSimulee = 0;
+        FormatEnregistrement format = FormatEnregistrement::PNG;
+        bool sansFenetre = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option == "--restaurer" && i + 1 < argc) fichierRestauration = std::filesystem::absolute(argv[++i]).string();
+            else if (option == "--checkpoint" && i + 1 < argc) {
+                fichierSauvegarde = std::filesystem::absolute(argv[++i]).string();
+                if (i + 1 < argc && argv[i + 1][0] != '-') periodeSauvegarde = std::stoi(argv[++i]);
+                if (periodeSauvegarde <= 0) throw std::runtime_error("Periode de sauvegarde invalide");
+            }
+            else if (option == "--telemetrie") {
+                segmentTelemetrie = "simulation_aero";
+                if (i + 1 < argc && argv[i + 1][0] != '-') segmentTelemetrie = argv[++i];
+            }
+            else if (option == "--enregistrer" && i + 1 < argc) {
+                dossierEnregistrement = std::filesystem::absolute(argv[++i]).string();
+                if (i + 1 < argc && argv[i + 1][0] != '-') periodeEnregistrement = std::stoi(argv[++i]);
+                if (periodeEnregistrement <= 0) throw std::runtime_error("Periode d'enregistrement invalide");
+            }
+            else if (option == "--format" && i + 1 < argc) {
+                std::string nom = argv[++i];
+                if (nom == "png") format = FormatEnregistrement::PNG;
+                else if (nom == "brut") format = FormatEnregistrement::BRUT;
+                else throw std::runtime_error("Format d'enregistrement inconnu : " + nom);
+            }
+            else if (option == "--duree" && i + 1 < argc) {
+                dureeSimulee = std::stoi(argv[++i]);
+                if (dureeSimulee <= 0) throw std::runtime_error("Duree invalide");
+            }
+            else if (option == "--sans-fenetre") sansFenetre = true;
+            else if (option == "--allocations") {
+                periodeAllocations = 10;
+                if (i + 1 < argc && argv[i + 1][0] != '-') periodeAllocations = std::stoi(argv[++i]);
+                if (periodeAllocations <= 0) throw std::runtime_error("Periode de rapport des allocations invalide");
+            }
+            else if (option == "--trajectoires" && i + 1 < argc) {
+                fichierTrajectoires = std::filesystem::absolute(argv[++i]).string();
+                if (i + 1 < argc && argv[i + 1][0] != '-') periodeTrajectoires = std::stoi(argv[++i]);
+                if (periodeTrajectoires <= 0) throw std::runtime_error("Periode d'archivage des trajectoires invalide");
+            }
+            else if (option == "--carte" && i + 1 < argc) fichierCarte = std::filesystem::absolute(argv[++i]).string();
+            else throw std::runtime_error("Option inconnue : " + option);
+        }
+        if (sansFenetre && dossierEnregistrement.empty()) throw std::runtime_error("--sans-fenetre demande --enregistrer");
+        if (sansFenetre && dureeSimulee == 0) throw std::runtime_error("--sans-fenetre demande --duree");
+
+        // Initialisation du répertoire de travail
         if (argc > 0) setRepertoire(argv[0]);
 
         std::cout << "--- SIMULATION ---\n";
 
-        // Création de la fenêtre SFML
-        sf::RenderWindow window(sf::VideoMode({LARGEUR, HAUTEUR}), "Simulation");
-        window.setFramerateLimit(60);
+        // Création de la fenêtre SFML (aucune en enregistrement seul : un contexte OpenGL logiciel suffit)
+        std::optional<sf::RenderWindow> window;
+        if (!sansFenetre) {
+            window.emplace(sf::VideoMode({LARGEUR, HAUTEUR}), "Simulation");
+            window->setFramerateLimit(60);
+        }
+
+        // Cible hors écran de l'enregistrement, même taille que la fenêtre
+        std::optional<sf::RenderTexture> rendu;
+        std::unique_ptr<EnregistreurImages> enregistreur;
+        if (!dossierEnregistrement.empty()) {
+            rendu.emplace(sf::Vector2u(LARGEUR, HAUTEUR));
+            enregistreur = std::make_unique<EnregistreurImages>(dossierEnregistrement, format, THREADS_ENCODAGE, FILE_ENCODAGE);
+        }
 
-        // Configuration des vues (caméras)
-        sf::View vueDefaut = window.getDefaultView();
-        sf::View vueFrance = window.getDefaultView();
+        // Configuration des vues (caméras), celle par défaut est commune à la fenêtre et à l'enregistrement
+        sf::View vueDefaut(sf::FloatRect({ 0.f, 0.f }, { (float)LARGEUR, (float)HAUTEUR }));
+        sf::View vueFrance = vueDefaut;
         float niveauZoomActuel = 1.0f;
 
-        sf::Texture textureCarte, textureAvion;
+        sf::Texture textureAvion;
         sf::Font police;
-        bool TextureMap = textureCarte.loadFromFile("img/carte.jpg");
+
+        // Fond de carte : pyramide de tuiles générée une fois, puis chargée à la demande selon la vue
+        std::unique_ptr<CarteTuiles> carte;
+        try {
+            std::filesystem::path source = fichierCarte.empty() ? "img/carte.jpg" : fichierCarte;
+            std::filesystem::path dossierTuiles = source.parent_path() / (source.stem().string() + "_tuiles");
+            if (!CarteTuiles::estAJour(source, dossierTuiles)) {
+                std::cout << "[CARTE] Decoupage de " << source.string() << " en tuiles...\n";
+                CarteTuiles::generer(source, dossierTuiles, TAILLE_TUILE);
+            }
+            carte = std::make_unique<CarteTuiles>(dossierTuiles, BUDGET_TUILES);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[CARTE] Pas de fond de carte : " << e.what() << "\n";
+        }
 
         // Chargement et traitement de l'image avion (transparence)
         sf::Image imageAvion;
@@ -73,184 +159,217 @@ int main(int argc, char* argv[]) {
         bool Police = police.openFromFile("img/arial.ttf");
         if (!Police) throw std::runtime_error("img/arial.ttf pas trouve");
 
-        sf::Sprite spriteFond(textureCarte);
-        if (TextureMap) adapterFondFenetre(spriteFond, textureCarte);
-
-        CCR ccr;
-        std::vector<Aeroport*> listeAeroports;
-        std::vector<Avion*> avionsPretsAuDepart;
-
-        // Lecture du fichier avec les infos de départ
-        std::ifstream fichier("debut.txt");
-        if (!fichier.is_open()) fichier.open("Projet/debut.txt");
-        if (!fichier.is_open()) throw std::runtime_error("Fichier debut.txt pas trouve");
-
-        std::string ligne, section;
-        while (std::getline(fichier, ligne)) {
-            if (ligne.empty() || ligne[0] == '#') continue;
-            if (ligne.back() == '\r') ligne.pop_back();
-            if (ligne == "[AEROPORTS]") { section = "AEROPORTS"; continue; }
-            if (ligne == "[AVIONS]") { section = "AVIONS"; continue; }
-
-            std::stringstream ss(ligne);
-            if (section == "AEROPORTS") {
-                // Chargement des aéroports
-                std::string nom; double x, y; float r;
-                ss >> nom >> x >> y >> r;
-                if (!nom.empty()) listeAeroports.push_back(new Aeroport(nom, Position(x, y, 0), r));
-            }
-            else if (section == "AVIONS") {
-                // Chargement des avions
-                std::string nom, dep, dest;
-                float v, vs, carb, conso, dur;
-                ss >> nom >> v >> vs >> carb >> conso >> dur >> dep >> dest;
-
-                Aeroport* d = nullptr; Aeroport* a = nullptr;
-                for (auto aero : listeAeroports) {
-                    if (aero->nom == dep) d = aero;
-                    if (aero->nom == dest) a = aero;
-                }
-                if (d && a) {
-                    Position p = d->position;
-                    p.setPosition(p.getX(), p.getY() - 5000, 10000); // Position initiale décalée
-                    Avion* av = new Avion(nom, v, vs, carb, conso, dur, p);
-                    av->setDestination(a);
-                    avionsPretsAuDepart.push_back(av);
-                }
-            }
-        }
-        fichier.close();
-        if (listeAeroports.empty()) throw std::runtime_error("Aucun aeroport charge");
-
-        // lancement des threads
-        threads_infra.emplace_back(routine_ccr, std::ref(ccr));
-        for (auto aero : listeAeroports) {
-            threads_infra.emplace_back(routine_twr, std::ref(*aero->twr));
-            threads_infra.emplace_back(routine_app, std::ref(*aero->app));
+        // Monde de la simulation : scénario, puis éventuellement une sauvegarde qui remplace ses avions
+        std::string scenario = std::filesystem::exists("debut.txt") ? "debut.txt" : "Projet/debut.txt";
+        Simulation simulation(scenario, static_cast<unsigned int>(time(NULL)));
+        if (!fichierRestauration.empty()) {
+            auto debut = std::chrono::steady_clock::now();
+            size_t restaures = simulation.restaurer(fichierRestauration).size();
+            auto duree = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - debut);
+            std::cout << "[SAUVEGARDE] " << restaures << " avions restaures en " << duree.count() << " ms.\n";
         }
 
-        // Génère les avions
-        std::thread trafficGenerator([&, avionsPretsAuDepart]() {
-            for (Avion* avion : avionsPretsAuDepart) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(500 + std::rand() % 1000));
-
-                // Recherche de l'aéroport le plus proche pour le départ
-                Aeroport* depart = nullptr;
-                double distMin = 1e12;
-                for (auto aero : listeAeroports) {
-                    double d = avion->getPosition().distance(aero->position);
-                    if (d < distMin) { distMin = d; depart = aero; }
+        // lancement des threads (contrôleurs, avions restaurés et générateur de trafic)
+        simulation.demarrer();
+        if (!fichierSauvegarde.empty()) simulation.sauvegarderPeriodiquement(fichierSauvegarde, std::chrono::seconds(periodeSauvegarde));
+        if (!segmentTelemetrie.empty()) simulation.publierTelemetrie(segmentTelemetrie);
+        if (!fichierTrajectoires.empty()) simulation.archiverTrajectoires(fichierTrajectoires, std::chrono::milliseconds(periodeTrajectoires));
+        if (periodeAllocations > 0) simulation.rapporterAllocations(std::chrono::seconds(periodeAllocations));
+        const std::vector<Aeroport*>& listeAeroports = simulation.getAeroports();
+
+        sf::VertexArray voiesAeriennes = construireVoiesAeriennes(simulation.getCCR().getReseau());
+        CarteDensite carteDensite(8.f);
+        ModeDensite modeDensite = ModeDensite::AUTOMATIQUE;
+        IndexEcran indexEcran(16.f);
+        std::vector<const AvionEcran*> avionsVisibles;
+        TracesAvions traces(simulation.getNombreAvions(), 120, std::chrono::milliseconds(500)); // 1 min de trace par avion
+        ModeTraces modeTraces = ModeTraces::SELECTION;
+        TableauBord tableauBord;
+        bool afficherTableauBord = true;
+
+        // Dessin d'une image complète, sur la fenêtre ou sur la texture de l'enregistrement
+        auto dessinerImage = [&](sf::RenderTarget& cible, const std::vector<Avion*>& flotte, std::chrono::steady_clock::time_point instant) {
+            PORTEE_ALLOCATIONS("Rendu");
+            cible.clear(sf::Color::White);
+
+            // Dessin du fond, dans la vue courante : les tuiles suivent le zoom
+            cible.setView(vueFrance);
+            if (carte) carte->dessiner(cible);
+
+            // Dessin de la france (aéroports et avions)
+            if (!aeroportVue) {
+                cible.draw(voiesAeriennes);
+                dessinerAeroports(cible, listeAeroports, police, Police);
+            }
+            else dessinerDetailsAeroport(cible, aeroportVue, police, Police, niveauZoomActuel);
+
+            // Dessin des avions
+            {
+                // Vue nationale chargée : une couche de densité à la place de milliers de sprites illisibles
+                bool densite = false;
+                if (niveauZoomActuel >= ZOOM_MIN_DENSITE && modeDensite != ModeDensite::JAMAIS) {
+                    carteDensite.mettreAJour(flotte);
+                    densite = (modeDensite == ModeDensite::TOUJOURS) || carteDensite.getAvionsVisibles() >= SEUIL_AVIONS_DENSITE;
+                    if (densite) carteDensite.dessiner(cible);
                 }
 
-                if (depart && avion->getDestination()) {
-                    ccr.prendreEnCharge(avion);
-                    // Lancement du thread dédié à l'avion
-                    std::thread t(routine_avion, std::ref(*avion), std::ref(*depart), std::ref(*avion->getDestination()), std::ref(ccr), listeAeroports);
-                    t.detach();
-                    {
-                        std::lock_guard<std::mutex> lock(mutexFlotte);
-                        flotte.push_back(avion);
+                // Traces sous les avions
+                traces.echantillonner(flotte);
+                if (modeTraces == ModeTraces::TOUTES) traces.dessiner(cible, flotte, nullptr);
+                else if (modeTraces == ModeTraces::SELECTION && avionSelectionne) traces.dessiner(cible, flotte, avionSelectionne);
+
+                // Seuls les avions dans la vue (avec une marge pour les sprites à cheval sur le bord)
+                sf::Vector2f marge(30.f * niveauZoomActuel, 30.f * niveauZoomActuel);
+                sf::FloatRect zoneVue(vueFrance.getCenter() - vueFrance.getSize() / 2.f - marge, vueFrance.getSize() + marge * 2.f);
+                indexEcran.rechercher(zoneVue, avionsVisibles);
+
+                for (const AvionEcran* a : avionsVisibles) {
+                    if (densite && a->avion != avionSelectionne) continue; // Seul l'avion sélectionné reste dessiné sur la densité
+                    // Le même instantané pour le sprite et la fiche
+                    dessinerAvion(cible, a->avion, a->etat, textureAvion, TextureAvion, police, Police, niveauZoomActuel, avionSelectionne, aeroportVue);
+                    if (a->avion == avionSelectionne && Police) {
+                        dessinerInfo(cible, a->avion, a->etat, police, niveauZoomActuel);
                     }
                 }
             }
-            });
-        trafficGenerator.detach();
+
+            // Indicateurs d'exploitation, en coordonnées de l'écran
+            if (afficherTableauBord && Police && simulation.getIndicateurs()) {
+                tableauBord.mettreAJour(*simulation.getIndicateurs(), instant);
+                cible.setView(vueDefaut);
+                tableauBord.dessiner(cible, listeAeroports, police);
+            }
+        };
+
+        // Enregistrement à intervalle fixe de temps simulé, indépendant de la cadence de la fenêtre
+        auto debutAffichage = Horloge::getHorloge().maintenant();
+        auto prochaineCapture = debutAffichage;
+        const std::chrono::milliseconds periodeCapture(periodeEnregistrement);
+        size_t capturesManquees = 0; // Instants de capture dépassés, affichage trop lent pour la période
 
         // Boucle principale d'affichage
-        while (window.isOpen()) {
-            while (const std::optional event = window.pollEvent()) {
-                if (event->is<sf::Event::Closed>()) window.close();
-                else if (const auto* k = event->getIf<sf::Event::KeyPressed>()) {
-                    if (k->code == sf::Keyboard::Key::Escape) window.close();
+        while (!window || window->isOpen()) {
+            PORTEE_ALLOCATIONS("Affichage");
+            auto maintenant = Horloge::getHorloge().maintenant();
+            if (dureeSimulee > 0 && maintenant - debutAffichage >= std::chrono::seconds(dureeSimulee)) break;
+
+            // Avions lancés à cette image (ils restent valides jusqu'à la fin de la simulation)
+            std::vector<Avion*> flotte = simulation.getFlotte();
+
+            if (window) {
+                // Instantanés de l'image, indexés par position à l'écran : clic et dessin.
+                // Affichage un pas en retard sur la simulation pour toujours interpoler entre deux positions connues
+                {
+                    PORTEE_ALLOCATIONS("Index ecran");
+                    indexEcran.construire(flotte, maintenant - std::chrono::milliseconds(PAS_AVION_MS));
                 }
-                else if (const auto* m = event->getIf<sf::Event::MouseButtonPressed>()) {
-                    if (m->button == sf::Mouse::Button::Left) {
-                        // Gestion du clic souris (sélection avion ou zoom aéroport)
-                        window.setView(vueFrance);
-                        sf::Vector2f mousePos = window.mapPixelToCoords(m->position);
-                        bool clic = false;
-
-                        {
-                            std::lock_guard<std::mutex> lock(mutexFlotte);
-                            for (auto avion : flotte) {
-                                if (!avion || avion->getEtat() == EtatAvion::TERMINE) continue;
-                                sf::Vector2f posAvion = conversion(avion->getPosition());
-                                float dx = mousePos.x - posAvion.x;
-                                float dy = mousePos.y - posAvion.y;
-                                if (std::sqrt(dx * dx + dy * dy) < (30.f * niveauZoomActuel)) {
-                                    avionSelectionne = avion;
-                                    clic = true;
-                                    break;
-                                }
-                            }
+
+                while (const std::optional event = window->pollEvent()) {
+                    if (event->is<sf::Event::Closed>()) window->close();
+                    else if (const auto* k = event->getIf<sf::Event::KeyPressed>()) {
+                        if (k->code == sf::Keyboard::Key::Escape) window->close();
+                        else if (k->code == sf::Keyboard::Key::H) {
+                            // Carte de densité : automatique -> toujours -> jamais
+                            if (modeDensite == ModeDensite::AUTOMATIQUE) modeDensite = ModeDensite::TOUJOURS;
+                            else if (modeDensite == ModeDensite::TOUJOURS) modeDensite = ModeDensite::JAMAIS;
+                            else modeDensite = ModeDensite::AUTOMATIQUE;
                         }
+                        else if (k->code == sf::Keyboard::Key::I) afficherTableauBord = !afficherTableauBord; // Indicateurs d'exploitation
+                        else if (k->code == sf::Keyboard::Key::T) {
+                            // Traces : avion sélectionné -> tous -> aucune
+                            if (modeTraces == ModeTraces::SELECTION) modeTraces = ModeTraces::TOUTES;
+                            else if (modeTraces == ModeTraces::TOUTES) modeTraces = ModeTraces::AUCUNE;
+                            else modeTraces = ModeTraces::SELECTION;
+                        }
+                        else if (k->code == sf::Keyboard::Key::Add || k->code == sf::Keyboard::Key::Equal ||
+                                 k->code == sf::Keyboard::Key::Subtract || k->code == sf::Keyboard::Key::Hyphen) {
+                            // Compression du temps : facteur suivant ou précédent de la liste
+                            bool accelerer = (k->code == sf::Keyboard::Key::Add || k->code == sf::Keyboard::Key::Equal);
+                            double facteur = Horloge::getHorloge().getFacteur();
+                            auto it = std::find(FACTEURS_TEMPS.begin(), FACTEURS_TEMPS.end(), facteur);
+                            size_t i = (it == FACTEURS_TEMPS.end()) ? 2 : static_cast<size_t>(it - FACTEURS_TEMPS.begin());
+                            if (accelerer && i + 1 < FACTEURS_TEMPS.size()) ++i;
+                            else if (!accelerer && i > 0) --i;
+                            Horloge::getHorloge().setFacteur(FACTEURS_TEMPS[i]);
+                            std::cout << "[SIMULATION] Temps x" << FACTEURS_TEMPS[i] << "\n";
+                        }
+                    }
+                    else if (const auto* m = event->getIf<sf::Event::MouseButtonPressed>()) {
+                        if (m->button == sf::Mouse::Button::Left) {
+                            // Gestion du clic souris (sélection avion ou zoom aéroport)
+                            window->setView(vueFrance);
+                            sf::Vector2f mousePos = window->mapPixelToCoords(m->position);
+                            bool clic = false;
 
-                        if (!clic) {
-                            avionSelectionne = nullptr;
-                            if (aeroportVue) {
-                                // Dézoom (retour vue france)
-                                aeroportVue = nullptr;
-                                vueFrance = window.getDefaultView();
-                                niveauZoomActuel = 1.0f;
-                                if (TextureMap) adapterFondFenetre(spriteFond, textureCarte);
+                            // Avion le plus proche du clic, parmi ceux des cellules voisines seulement
+                            if (Avion* choisi = indexEcran.choisir(mousePos, 30.f * niveauZoomActuel)) {
+                                avionSelectionne = choisi;
+                                clic = true;
                             }
-                            else {
-                                // Zoom sur un aéroport
-                                for (auto aero : listeAeroports) {
-                                    sf::Vector2f posAero = conversion(aero->position);
-                                    float dx = mousePos.x - posAero.x;
-                                    float dy = mousePos.y - posAero.y;
-                                    if (std::sqrt(dx * dx + dy * dy) < 50.f) {
-                                        aeroportVue = aero;
-                                        vueFrance.setCenter(posAero);
-                                        niveauZoomActuel = 0.002f;
-                                        vueFrance.setSize({ (float)LARGEUR * niveauZoomActuel, (float)HAUTEUR * niveauZoomActuel });
-                                        break;
+
+                            if (!clic) {
+                                avionSelectionne = nullptr;
+                                if (aeroportVue) {
+                                    // Dézoom (retour vue france)
+                                    aeroportVue = nullptr;
+                                    vueFrance = vueDefaut;
+                                    niveauZoomActuel = 1.0f;
+                                }
+                                else {
+                                    // Zoom sur un aéroport
+                                    static const float rayonClicCarre = seuilCarreStrict(RAYON_CLIC_AEROPORT);
+                                    for (auto aero : listeAeroports) {
+                                        sf::Vector2f posAero = conversion(aero->position);
+                                        float dx = mousePos.x - posAero.x;
+                                        float dy = mousePos.y - posAero.y;
+                                        if (dx * dx + dy * dy < rayonClicCarre) {
+                                            aeroportVue = aero;
+                                            vueFrance.setCenter(posAero);
+                                            niveauZoomActuel = 0.002f;
+                                            vueFrance.setSize({ (float)LARGEUR * niveauZoomActuel, (float)HAUTEUR * niveauZoomActuel });
+                                            break;
+                                        }
                                     }
                                 }
                             }
                         }
                     }
                 }
-            }
-
-            window.clear(sf::Color::White);
 
-            // Dessin du fond
-            window.setView(vueDefaut);
-            if ((TextureMap && !aeroportVue) || (aeroportVue && !TextureMap)) {
-                if (!aeroportVue) window.draw(spriteFond);
+                dessinerImage(*window, flotte, maintenant);
+                window->display();
             }
 
-            // Dessin de la france (aéroports et avions)
-            window.setView(vueFrance);
-            if (!aeroportVue) dessinerAeroports(window, listeAeroports, police, Police);
-            else dessinerDetailsAeroport(window, aeroportVue, police, Police, niveauZoomActuel);
-
-            // Dessin des avions
-            {
-                std::lock_guard<std::mutex> lock(mutexFlotte);
-                for (auto avion : flotte) {
-                    if (avion && avion->getEtat() != EtatAvion::TERMINE) {
-                        dessinerAvion(window, avion, textureAvion, TextureAvion, police, Police, niveauZoomActuel, avionSelectionne, aeroportVue);
-                        if (avion == avionSelectionne && Police) {
-                            dessinerInfo(window, avion, police, niveauZoomActuel);
-                        }
+            if (enregistreur) {
+                PORTEE_ALLOCATIONS("Enregistrement");
+                if (maintenant >= prochaineCapture) {
+                    // Image de l'instant de capture lui-même ; seule la copie de texture est faite ici, la relecture est différée
+                    indexEcran.construire(flotte, prochaineCapture - std::chrono::milliseconds(PAS_AVION_MS));
+                    dessinerImage(*rendu, flotte, prochaineCapture);
+                    rendu->display();
+                    enregistreur->soumettre(rendu->getTexture());
+                    prochaineCapture += periodeCapture;
+                    while (prochaineCapture <= maintenant) {
+                        prochaineCapture += periodeCapture;
+                        ++capturesManquees;
                     }
                 }
+                // Sans fenêtre, rien d'autre à faire avant la prochaine capture
+                if (!window) Horloge::getHorloge().pause(std::chrono::duration_cast<std::chrono::milliseconds>(prochaineCapture - maintenant) + std::chrono::milliseconds(1));
             }
-            window.display();
         }
 
-        // Nettoyage et fermeture
-        {
-            std::lock_guard<std::mutex> lock(mutexFlotte);
-            for (auto avion : flotte) {
-                if (avion) { avion->setEtat(EtatAvion::TERMINE); delete avion; }
-            }
-            flotte.clear();
+        if (enregistreur) {
+            enregistreur->terminer();
+            std::cout << "[ENREGISTREMENT] " << enregistreur->getEcrites() << " images " << LARGEUR << "x" << HAUTEUR << " dans " << dossierEnregistrement
+                      << " (" << enregistreur->getAbandonnees() << " abandonnees file pleine, " << capturesManquees << " instants manques, "
+                      << enregistreur->getEchecs() << " echecs d'ecriture)\n";
         }
-        for (auto aero : listeAeroports) { delete aero->twr; delete aero->app; delete aero; }
+
+        // Fermeture : arrêt et attente de tous les threads avant de libérer le monde
+        avionSelectionne = nullptr;
+        aeroportVue = nullptr;
+        simulation.arreter();
     }
     catch (const std::exception& e) {
         std::cerr << "Erreur " << e.what() << "\n";
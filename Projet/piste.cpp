@@ -0,0 +1,62 @@
+#include "avion.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+Piste::Piste(std::string nom, Position seuil, ModePiste mode, float tempsOccupation)
+    : nom_(nom), seuil_(seuil), mode_(mode),
+    tempsOccupation_(static_cast<long long>(tempsOccupation)),
+    libre_(true), disponibleA_(), debutOccupation_(), occupationObservee_(tempsOccupation_), occupationCumulee_(0), tourActuel_(Tour::DECOLLAGE) {
+    if (tempsOccupation < 0) throw std::invalid_argument("Temps d'occupation de piste negatif");
+}
+
+std::string Piste::getNom() const { return nom_; }
+Position Piste::getSeuil() const { return seuil_; }
+ModePiste Piste::getMode() const { return mode_; }
+bool Piste::accepteArrivees() const { return mode_ != ModePiste::DEPARTS; }
+bool Piste::accepteDeparts() const { return mode_ != ModePiste::ARRIVEES; }
+bool Piste::estLibre() const { return libre_; }
+std::chrono::steady_clock::time_point Piste::getDisponibleA() const { return disponibleA_; }
+std::chrono::milliseconds Piste::getTempsOccupation() const { return tempsOccupation_; }
+Tour Piste::getTour() const { return tourActuel_; }
+void Piste::setTour(Tour tour) { tourActuel_ = tour; }
+std::chrono::steady_clock::time_point Piste::getDebutOccupation() const { return debutOccupation_; }
+std::chrono::milliseconds Piste::getOccupationObservee() const { return occupationObservee_; }
+std::chrono::milliseconds Piste::getOccupationCumulee() const { return occupationCumulee_; }
+
+void Piste::restaurer(bool libre, std::chrono::steady_clock::time_point disponibleA, std::chrono::steady_clock::time_point debutOccupation,
+                      std::chrono::milliseconds occupationObservee, Tour tour) {
+    if (occupationObservee.count() < 0) throw std::invalid_argument("Temps d'occupation de piste negatif");
+    libre_ = libre;
+    disponibleA_ = disponibleA;
+    debutOccupation_ = debutOccupation;
+    occupationObservee_ = occupationObservee;
+    tourActuel_ = tour;
+}
+
+// La piste n'est réutilisable qu'une fois dégagée ET après son temps d'occupation minimal
+bool Piste::estDisponible(std::chrono::steady_clock::time_point maintenant) const {
+    return libre_ && maintenant >= disponibleA_;
+}
+
+void Piste::reserver(std::chrono::steady_clock::time_point maintenant) {
+    libre_ = false;
+    debutOccupation_ = maintenant;
+    disponibleA_ = maintenant + tempsOccupation_;
+}
+
+void Piste::liberer(std::chrono::steady_clock::time_point maintenant) {
+    if (!libre_) {
+        // Moyenne glissante entre l'estimation précédente et la dernière occupation mesurée
+        auto duree = std::chrono::duration_cast<std::chrono::milliseconds>(maintenant - debutOccupation_);
+        occupationObservee_ = (occupationObservee_ + duree) / 2;
+        occupationCumulee_ += duree;
+    }
+    libre_ = true;
+}
+
+std::chrono::milliseconds Piste::getOccupationEstimee() const { return std::max(tempsOccupation_, occupationObservee_); }
+
+std::chrono::steady_clock::time_point Piste::getLiberationEstimee() const {
+    if (libre_) return disponibleA_;
+    return std::max(disponibleA_, debutOccupation_ + getOccupationEstimee());
+}
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <limits>
+
+#include "trajectoires.hpp"
+
+// Relecture d'une archive de trajectoires (--trajectoires du simulateur et du lanceur en lot) :
+// résumé de l'archive, image de la flotte à un instant, ou trajectoire d'un avion entre deux instants (CSV).
+// Usage : Trajectoires archive [--instant s] [--avion nom [--debut s] [--fin s]]
+
+static int64_t enMs(const std::string& secondes) { return static_cast<int64_t>(std::stod(secondes) * 1000.0); }
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string chemin, nomAvion;
+        bool instantDemande = false;
+        int64_t instant = 0, debut = std::numeric_limits<int64_t>::min(), fin = std::numeric_limits<int64_t>::max();
+        for (int i = 1; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option == "--instant" && i + 1 < argc) {
+                instant = enMs(argv[++i]);
+                instantDemande = true;
+            }
+            else if (option == "--avion" && i + 1 < argc) nomAvion = argv[++i];
+            else if (option == "--debut" && i + 1 < argc) debut = enMs(argv[++i]);
+            else if (option == "--fin" && i + 1 < argc) fin = enMs(argv[++i]);
+            else if (option[0] != '-' && chemin.empty()) chemin = option;
+            else throw std::runtime_error("Option inconnue : " + option);
+        }
+        if (chemin.empty()) throw std::runtime_error("Usage : Trajectoires archive [--instant s] [--avion nom [--debut s] [--fin s]]");
+
+        auto ouverture = std::chrono::steady_clock::now();
+        LecteurArchive archive(chemin);
+        auto duree = [](std::chrono::steady_clock::time_point depuis) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - depuis).count();
+        };
+        std::cerr << std::fixed << std::setprecision(1) << "[TRAJECTOIRES] " << archive.getNombreBlocs() << " blocs, " << archive.getNombreAvions()
+                  << " avions, de " << archive.getDebutMs() / 1000.0 << " a " << archive.getFinMs() / 1000.0 << " s, index lu en " << duree(ouverture) << " ms\n";
+
+        if (!nomAvion.empty()) {
+            uint32_t avion = archive.trouverAvion(nomAvion);
+            if (avion == LecteurArchive::AUCUN) throw std::runtime_error("Avion absent de l'archive : " + nomAvion);
+            auto debutLecture = std::chrono::steady_clock::now();
+            std::vector<PointTrajectoire> points = archive.lireTrajectoire(avion, debut, fin);
+            std::cout << "instant;x;y;altitude;etat\n" << std::fixed << std::setprecision(1);
+            for (const PointTrajectoire& p : points) {
+                std::cout << p.instantMs / 1000.0 << ";" << p.x << ";" << p.y << ";" << p.altitude << ";" << nomEtat(p.etat) << "\n";
+            }
+            std::cerr << std::setprecision(1) << "[TRAJECTOIRES] " << points.size() << " positions, " << archive.getBlocsLus() << " blocs decodes en "
+                      << duree(debutLecture) << " ms\n";
+        }
+        else if (instantDemande) {
+            auto debutLecture = std::chrono::steady_clock::now();
+            std::vector<PointTrajectoire> points = archive.lireInstant(instant);
+            std::cout << "avion;x;y;altitude;etat\n" << std::fixed << std::setprecision(1);
+            for (const PointTrajectoire& p : points) {
+                std::cout << archive.getNom(p.avion) << ";" << p.x << ";" << p.y << ";" << p.altitude << ";" << nomEtat(p.etat) << "\n";
+            }
+            std::cerr << std::setprecision(1) << "[TRAJECTOIRES] Image de " << (points.empty() ? 0.0 : points.front().instantMs / 1000.0) << " s : "
+                      << points.size() << " avions, " << archive.getBlocsLus() << " bloc decode en " << duree(debutLecture) << " ms\n";
+        }
+        else {
+            // Résumé : taille de l'archive et présence de chaque avion
+            uint64_t taille = std::filesystem::file_size(chemin);
+            std::cout << std::fixed << std::setprecision(1) << "Archive " << chemin << " : " << taille << " octets, periode " << archive.getPeriodeMs() << " ms\n";
+            std::cout << std::left << std::setw(16) << "Avion" << std::right << std::setw(12) << "Premier (s)" << std::setw(12) << "Dernier (s)" << "\n";
+            for (uint32_t a = 0; a < archive.getNombreAvions(); ++a) {
+                const EntreeAvion& entree = archive.getAvion(a);
+                std::cout << std::left << std::setw(16) << archive.getNom(a) << std::right << std::setw(12) << entree.premierMs / 1000.0
+                          << std::setw(12) << entree.dernierMs / 1000.0 << "\n";
+            }
+        }
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[TRAJECTOIRES] " << e.what() << "\n";
+        return 1;
+    }
+}
\ No newline at end of file
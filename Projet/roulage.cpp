@@ -0,0 +1,192 @@
+﻿#include "avion.hpp"
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+static const size_t AUCUN_NOEUD = std::numeric_limits<size_t>::max();
+
+// Supprime les points intermédiaires alignés (inutile de s'arrêter au milieu d'une ligne droite)
+static void simplifierChemin(std::vector<Position>& chemin) {
+    if (chemin.size() < 3) return;
+    std::vector<Position> resultat;
+    resultat.push_back(chemin.front());
+    for (size_t i = 1; i + 1 < chemin.size(); ++i) {
+        Position a = chemin[i] - resultat.back();
+        Position b = chemin[i + 1] - chemin[i];
+        double produitVectoriel = a.getX() * b.getY() - a.getY() * b.getX();
+        double produitScalaire = a.getX() * b.getX() + a.getY() * b.getY();
+        if (std::abs(produitVectoriel) > 1e-6 || produitScalaire < 0) {
+            resultat.push_back(chemin[i]); // Changement de direction, on garde le point
+        }
+    }
+    resultat.push_back(chemin.back());
+    chemin = resultat;
+}
+
+ReseauRoulage::ReseauRoulage() {}
+
+void ReseauRoulage::vider() {
+    nomsNoeuds_.clear();
+    noeuds_.clear();
+    voisins_.clear();
+    arcs_.clear();
+    noeudsParkings_.clear();
+    sortiesPistes_.clear();
+    pointsAttente_.clear();
+    cheminsVersParking_.clear();
+    cheminsVersPiste_.clear();
+    longueursVersPiste_.clear();
+}
+
+size_t ReseauRoulage::trouverNoeud(const std::string& nom) const {
+    auto it = std::find(nomsNoeuds_.begin(), nomsNoeuds_.end(), nom);
+    if (it == nomsNoeuds_.end()) throw std::invalid_argument("Noeud de roulage inconnu : " + nom);
+    return static_cast<size_t>(it - nomsNoeuds_.begin());
+}
+
+void ReseauRoulage::ajouterNoeud(const std::string& nom, Position pos) {
+    if (std::find(nomsNoeuds_.begin(), nomsNoeuds_.end(), nom) != nomsNoeuds_.end()) {
+        throw std::invalid_argument("Noeud de roulage en double : " + nom);
+    }
+    nomsNoeuds_.push_back(nom);
+    noeuds_.push_back(Position(pos.getX(), pos.getY(), 0));
+    voisins_.emplace_back();
+}
+
+void ReseauRoulage::ajouterArc(const std::string& a, const std::string& b) {
+    size_t ia = trouverNoeud(a);
+    size_t ib = trouverNoeud(b);
+    double longueur = noeuds_[ia].distance(noeuds_[ib]);
+    voisins_[ia].push_back({ ib, longueur });
+    voisins_[ib].push_back({ ia, longueur });
+    arcs_.push_back({ ia, ib });
+}
+
+void ReseauRoulage::definirSortiePiste(const std::string& noeud, size_t indexPiste) {
+    if (sortiesPistes_.size() <= indexPiste) sortiesPistes_.resize(indexPiste + 1, AUCUN_NOEUD);
+    sortiesPistes_[indexPiste] = trouverNoeud(noeud);
+}
+
+void ReseauRoulage::definirPointAttente(const std::string& noeud, size_t indexPiste) {
+    if (pointsAttente_.size() <= indexPiste) pointsAttente_.resize(indexPiste + 1, AUCUN_NOEUD);
+    pointsAttente_[indexPiste] = trouverNoeud(noeud);
+}
+
+void ReseauRoulage::relierParking(const std::string& noeud) { noeudsParkings_.push_back(trouverNoeud(noeud)); }
+
+std::vector<size_t> ReseauRoulage::plusCourtsChemins(size_t source) const {
+    std::vector<double> distances(noeuds_.size(), std::numeric_limits<double>::infinity());
+    std::vector<size_t> predecesseurs(noeuds_.size(), AUCUN_NOEUD);
+
+    // File de priorité (distance, noeud), la plus petite distance en premier
+    using Entree = std::pair<double, size_t>;
+    std::priority_queue<Entree, std::vector<Entree>, std::greater<Entree>> file;
+    distances[source] = 0;
+    file.push({ 0, source });
+
+    while (!file.empty()) {
+        auto [dist, noeud] = file.top();
+        file.pop();
+        if (dist > distances[noeud]) continue; // Entrée périmée
+
+        for (const auto& [voisin, longueur] : voisins_[noeud]) {
+            if (dist + longueur < distances[voisin]) {
+                distances[voisin] = dist + longueur;
+                predecesseurs[voisin] = noeud;
+                file.push({ distances[voisin], voisin });
+            }
+        }
+    }
+    return predecesseurs;
+}
+
+// Chemin du noeud jusqu'à la source d'un parcours de Dijkstra (remontée des prédécesseurs)
+static bool remonterChemin(const std::vector<size_t>& predecesseurs, const std::vector<Position>& noeuds,
+                           size_t depart, size_t source, std::vector<Position>& chemin) {
+    size_t n = depart;
+    for (; n != AUCUN_NOEUD; n = predecesseurs[n]) {
+        chemin.push_back(noeuds[n]);
+        if (n == source) break;
+    }
+    return n == source;
+}
+
+void ReseauRoulage::precalculerChemins(const std::vector<Parking>& parkings, const std::vector<Piste>& pistes) {
+    if (noeudsParkings_.size() != parkings.size()) throw std::runtime_error("Parkings non relies au reseau de roulage");
+    sortiesPistes_.resize(pistes.size(), AUCUN_NOEUD);
+    pointsAttente_.resize(pistes.size(), AUCUN_NOEUD);
+
+    cheminsVersParking_.assign(pistes.size(), std::vector<std::vector<Position>>(parkings.size()));
+    cheminsVersPiste_.assign(pistes.size(), std::vector<std::vector<Position>>(parkings.size()));
+    longueursVersPiste_.assign(pistes.size(), std::vector<double>(parkings.size(), 0.0));
+
+    for (size_t p = 0; p < pistes.size(); ++p) {
+        // Un seul parcours par extrémité de piste suffit pour desservir tous les parkings
+        if (pistes[p].accepteArrivees()) {
+            size_t sortie = sortiesPistes_[p];
+            if (sortie == AUCUN_NOEUD) throw std::runtime_error("Piste " + pistes[p].getNom() + " sans sortie de piste");
+            std::vector<size_t> depuisSortie = plusCourtsChemins(sortie);
+
+            for (size_t i = 0; i < parkings.size(); ++i) {
+                // Sortie de piste -> parking
+                std::vector<Position> arrivee;
+                if (!remonterChemin(depuisSortie, noeuds_, noeudsParkings_[i], sortie, arrivee)) {
+                    throw std::runtime_error("Parking " + parkings[i].getNom() + " inaccessible depuis la piste " + pistes[p].getNom());
+                }
+                std::reverse(arrivee.begin(), arrivee.end());
+                arrivee.push_back(parkings[i].getPosition()); // Entrée parking
+                simplifierChemin(arrivee);
+                cheminsVersParking_[p][i] = arrivee;
+            }
+        }
+
+        if (pistes[p].accepteDeparts()) {
+            size_t attente = pointsAttente_[p];
+            if (attente == AUCUN_NOEUD) throw std::runtime_error("Piste " + pistes[p].getNom() + " sans point d'attente");
+            std::vector<size_t> depuisAttente = plusCourtsChemins(attente);
+
+            for (size_t i = 0; i < parkings.size(); ++i) {
+                // Parking -> point d'attente (déjà dans le bon sens)
+                std::vector<Position> depart;
+                if (!remonterChemin(depuisAttente, noeuds_, noeudsParkings_[i], attente, depart)) {
+                    throw std::runtime_error("Parking " + parkings[i].getNom() + " sans acces a la piste " + pistes[p].getNom());
+                }
+                simplifierChemin(depart);
+
+                double longueur = parkings[i].getPosition().distance(depart.front());
+                for (size_t k = 1; k < depart.size(); ++k) longueur += depart[k - 1].distance(depart[k]);
+
+                cheminsVersPiste_[p][i] = depart;
+                longueursVersPiste_[p][i] = longueur;
+            }
+        }
+    }
+}
+
+const std::vector<Position>& ReseauRoulage::getCheminVersParking(size_t indexPiste, size_t indexParking) const {
+    if (indexPiste >= cheminsVersParking_.size() || indexParking >= cheminsVersParking_[indexPiste].size()) {
+        throw std::out_of_range("Chemin de roulage non calcule");
+    }
+    return cheminsVersParking_[indexPiste][indexParking];
+}
+
+const std::vector<Position>& ReseauRoulage::getCheminVersPiste(size_t indexPiste, size_t indexParking) const {
+    if (indexPiste >= cheminsVersPiste_.size() || indexParking >= cheminsVersPiste_[indexPiste].size()) {
+        throw std::out_of_range("Chemin de roulage non calcule");
+    }
+    return cheminsVersPiste_[indexPiste][indexParking];
+}
+
+double ReseauRoulage::getLongueurVersPiste(size_t indexPiste, size_t indexParking) const {
+    if (indexPiste >= longueursVersPiste_.size() || indexParking >= longueursVersPiste_[indexPiste].size()) {
+        throw std::out_of_range("Chemin de roulage non calcule");
+    }
+    return longueursVersPiste_[indexPiste][indexParking];
+}
+
+std::vector<std::pair<Position, Position>> ReseauRoulage::getArcs() const {
+    std::vector<std::pair<Position, Position>> segments;
+    segments.reserve(arcs_.size());
+    for (const auto& [a, b] : arcs_) segments.push_back({ noeuds_[a], noeuds_[b] });
+    return segments;
+}
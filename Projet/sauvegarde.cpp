@@ -0,0 +1,529 @@
+#include "avion.hpp"
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+
+static const size_t AUCUN = std::numeric_limits<uint32_t>::max(); // Indice absent (pas de destination, pas de parking)
+static const char MAGIE[8] = { 'S', 'I', 'M', 'A', 'E', 'R', 'O', '\0' };
+static const uint32_t BOUTISME = 0x01020304; // Relu 0x04030201 sur une machine de l'autre boutisme
+
+enum class TypeSection : uint32_t { AEROPORTS, PARKINGS, PISTES, AVIONS, POINTS, ARRIVEES, LISTES, PLANNING, CHAINES };
+const uint32_t NOMBRE_SECTIONS = 9;
+
+// Enregistrements du fichier : taille fixe, types à largeur fixe, bourrage explicite (mis à zéro)
+struct EnTeteFichier {
+    char magie[8];
+    uint32_t version;
+    uint32_t boutisme;
+    uint64_t tailleFichier;
+    uint32_t nombreSections; // Table des sections juste après l'en-tête
+    uint32_t premierEnCroisiere; // Dans LISTES : avions gérés par le CCR
+    uint32_t nombreEnCroisiere;
+    uint32_t reserve;
+};
+
+struct SectionFichier {
+    uint32_t type;
+    uint32_t tailleEnregistrement;
+    uint64_t decalage; // Depuis le début du fichier, multiple de 8
+    uint64_t nombre;
+};
+
+struct ChaineFichier { // Dans CHAINES, sans zéro final
+    uint32_t debut;
+    uint32_t longueur;
+};
+
+struct AeroportFichier {
+    ChaineFichier nom;
+    uint32_t premierParking, nombreParkings;
+    uint32_t premierePiste, nombrePistes;
+    uint32_t premiereArrivee, nombreArrivees;
+    uint32_t premierDecollage, nombreDecollages; // Dans LISTES : file de décollage de la tour
+    uint32_t premierDansZone, nombreDansZone; // Dans LISTES : avions gérés par l'APP
+    uint8_t urgenceEnCours;
+    uint8_t reserve[7];
+};
+
+struct PisteFichier {
+    int64_t disponibleA; // Instants en ms relatifs à la capture
+    int64_t debutOccupation;
+    int64_t occupationObservee; // ms
+    uint8_t libre;
+    uint8_t tour;
+    uint8_t reserve[6];
+};
+
+struct AvionFichier {
+    ChaineFichier nom;
+    float vitesse, vitesseSol, carburant, consommation, dureeStationnement;
+    uint32_t etat, typeUrgence;
+    uint32_t destination; // Indice d'aéroport
+    uint32_t aeroportParking, parking; // Indice d'aéroport, puis de parking dans cet aéroport
+    uint32_t premierPoint, nombrePoints; // Points de passage restants
+    uint32_t reserve[2];
+    uint64_t piste;
+    double x, y, altitude;
+};
+
+struct PointFichier {
+    double x, y, altitude;
+};
+
+struct ArriveeFichier {
+    uint32_t avion;
+    uint8_t priorite, phase, pisteFixee, reserve;
+    uint64_t piste;
+    uint64_t ordre;
+    int64_t heureEstimee;
+    int64_t creneau;
+};
+
+struct VolPlanifieFichier {
+    uint32_t depart, arrivee; // Indices d'aéroports
+    int64_t instant;
+};
+
+// Disposition figée par la version du format
+static_assert(sizeof(EnTeteFichier) == 40 && sizeof(SectionFichier) == 24 && sizeof(AeroportFichier) == 56, "Format de sauvegarde modifie");
+static_assert(sizeof(PisteFichier) == 32 && sizeof(AvionFichier) == 96 && sizeof(PointFichier) == 24, "Format de sauvegarde modifie");
+static_assert(sizeof(ArriveeFichier) == 40 && sizeof(VolPlanifieFichier) == 16, "Format de sauvegarde modifie");
+
+static int64_t versFichier(std::chrono::steady_clock::time_point instant, std::chrono::steady_clock::time_point reference) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(instant - reference).count();
+}
+
+static std::chrono::steady_clock::time_point depuisFichier(int64_t ms, std::chrono::steady_clock::time_point reference) {
+    return reference + std::chrono::milliseconds(ms);
+}
+
+template <typename T>
+static void ajouterSection(std::vector<char>& image, std::vector<SectionFichier>& table, TypeSection type, const std::vector<T>& donnees) {
+    static_assert(std::is_trivially_copyable_v<T>, "Enregistrement non copiable octet par octet");
+    image.resize((image.size() + 7) / 8 * 8, 0); // Chaque section commence sur 8 octets
+    table.push_back({ static_cast<uint32_t>(type), static_cast<uint32_t>(sizeof(T)), image.size(), donnees.size() });
+    const char* debut = reinterpret_cast<const char*>(donnees.data());
+    image.insert(image.end(), debut, debut + donnees.size() * sizeof(T));
+}
+
+template <typename T>
+static std::vector<T> lireSection(const std::vector<char>& image, const std::vector<SectionFichier>& table, TypeSection type) {
+    for (const auto& section : table) {
+        if (section.type != static_cast<uint32_t>(type)) continue;
+        if (section.tailleEnregistrement != sizeof(T)) throw std::runtime_error("Sauvegarde : taille d'enregistrement inattendue");
+        if (section.decalage > image.size() || section.nombre > (image.size() - section.decalage) / sizeof(T)) {
+            throw std::runtime_error("Sauvegarde tronquee");
+        }
+        std::vector<T> donnees(section.nombre);
+        std::memcpy(donnees.data(), image.data() + section.decalage, section.nombre * sizeof(T));
+        return donnees;
+    }
+    throw std::runtime_error("Sauvegarde : section manquante");
+}
+
+static void verifier(bool condition) {
+    if (!condition) throw std::runtime_error("Sauvegarde corrompue");
+}
+
+static void verifierPlage(uint32_t premier, uint32_t nombre, size_t taille) {
+    verifier(premier <= taille && nombre <= taille - premier);
+}
+
+Sauvegarde::Sauvegarde(CCR& ccr, const std::vector<Aeroport*>& aeroports) : ccr_(ccr), aeroports_(aeroports) {}
+
+size_t Sauvegarde::indexAeroport(const Aeroport* aeroport) const {
+    auto it = std::find(aeroports_.begin(), aeroports_.end(), aeroport);
+    return (it == aeroports_.end()) ? AUCUN : static_cast<size_t>(it - aeroports_.begin());
+}
+
+Aeroport* Sauvegarde::aeroportLePlusProche(const Position& position) const {
+    Aeroport* proche = nullptr;
+    double distMin = std::numeric_limits<double>::infinity();
+    for (auto aero : aeroports_) {
+        double d = position.distanceCarre(aero->position);
+        if (d < distMin) { distMin = d; proche = aero; }
+    }
+    return proche;
+}
+
+std::vector<char> Sauvegarde::capturer(const std::vector<Avion*>& flotte) const {
+    auto reference = Horloge::getHorloge().maintenant(); // Les instants sont enregistrés relativement à la capture
+
+    // Contrôleurs d'abord, avions ensuite : l'état d'un avion est toujours au moins aussi récent que celui des listes
+    // qui le contiennent, la restauration s'appuie dessus pour réparer les écarts (voir restaurer)
+    struct EtatAeroport {
+        std::vector<Piste> pistes;
+        std::vector<Avion*> fileDecollage;
+        bool urgenceEnCours;
+        std::vector<Avion*> dansZone;
+        std::vector<ArriveeSauvegardee> sequence;
+        std::vector<uint8_t> parkings;
+    };
+    std::vector<EtatAeroport> etats(aeroports_.size());
+    for (size_t i = 0; i < aeroports_.size(); ++i) {
+        Aeroport* aero = aeroports_[i];
+        aero->twr->capturer(etats[i].pistes, etats[i].fileDecollage);
+        etats[i].urgenceEnCours = aero->twr->estUrgenceEnCours();
+        aero->app->capturer(etats[i].dansZone, etats[i].sequence);
+        for (const auto& p : aero->parkings) etats[i].parkings.push_back(p.estOccupe() ? 1 : 0);
+    }
+    std::vector<Avion*> enCroisiere;
+    CCR::PlanningVols planning;
+    ccr_.capturer(enCroisiere, planning);
+
+    std::vector<char> chaines;
+    auto chaine = [&](const std::string& s) {
+        ChaineFichier c{ static_cast<uint32_t>(chaines.size()), static_cast<uint32_t>(s.size()) };
+        chaines.insert(chaines.end(), s.begin(), s.end());
+        return c;
+    };
+
+    // Avions en vie : leur indice dans la sauvegarde remplace les pointeurs
+    std::vector<AvionFichier> avions;
+    std::vector<PointFichier> points;
+    std::unordered_map<const Avion*, uint32_t> indexAvion;
+    std::vector<Position> trajectoire;
+    for (Avion* avion : flotte) {
+        if (!avion) continue;
+        InstantaneAvion etat = avion->capturer(trajectoire);
+        if (etat.etat == EtatAvion::TERMINE) continue;
+
+        AvionFichier a{};
+        a.nom = chaine(avion->getNom());
+        a.vitesse = avion->getVitesse();
+        a.vitesseSol = avion->getVitesseSol();
+        a.carburant = etat.carburant;
+        a.consommation = avion->getConsommation();
+        a.dureeStationnement = avion->getDureeStationnement();
+        a.etat = static_cast<uint32_t>(etat.etat);
+        a.typeUrgence = static_cast<uint32_t>(etat.typeUrgence);
+        a.destination = static_cast<uint32_t>(indexAeroport(etat.destination));
+        a.aeroportParking = a.parking = static_cast<uint32_t>(AUCUN);
+        for (size_t i = 0; i < aeroports_.size() && etat.parking; ++i) {
+            const auto& parkings = aeroports_[i]->parkings;
+            if (etat.parking >= parkings.data() && etat.parking < parkings.data() + parkings.size()) {
+                a.aeroportParking = static_cast<uint32_t>(i);
+                a.parking = static_cast<uint32_t>(etat.parking - parkings.data());
+            }
+        }
+        a.piste = etat.piste;
+        a.x = etat.position.getX();
+        a.y = etat.position.getY();
+        a.altitude = etat.position.getAltitude();
+        a.premierPoint = static_cast<uint32_t>(points.size());
+        a.nombrePoints = static_cast<uint32_t>(trajectoire.size());
+        for (const auto& p : trajectoire) points.push_back({ p.getX(), p.getY(), p.getAltitude() });
+
+        indexAvion[avion] = static_cast<uint32_t>(avions.size());
+        avions.push_back(a);
+    }
+
+    // Listes d'avions des contrôleurs, sans ceux qui ont disparu entre-temps
+    std::vector<uint32_t> listes;
+    auto liste = [&](const std::vector<Avion*>& contenu, uint32_t& premier, uint32_t& nombre) {
+        premier = static_cast<uint32_t>(listes.size());
+        for (Avion* avion : contenu) {
+            auto it = indexAvion.find(avion);
+            if (it != indexAvion.end()) listes.push_back(it->second);
+        }
+        nombre = static_cast<uint32_t>(listes.size()) - premier;
+    };
+
+    std::vector<AeroportFichier> aeroports;
+    std::vector<uint8_t> parkings;
+    std::vector<PisteFichier> pistes;
+    std::vector<ArriveeFichier> arrivees;
+    for (size_t i = 0; i < aeroports_.size(); ++i) {
+        const EtatAeroport& e = etats[i];
+        AeroportFichier f{};
+        f.nom = chaine(aeroports_[i]->nom);
+        f.premierParking = static_cast<uint32_t>(parkings.size());
+        f.nombreParkings = static_cast<uint32_t>(e.parkings.size());
+        parkings.insert(parkings.end(), e.parkings.begin(), e.parkings.end());
+
+        f.premierePiste = static_cast<uint32_t>(pistes.size());
+        f.nombrePistes = static_cast<uint32_t>(e.pistes.size());
+        for (const auto& piste : e.pistes) {
+            PisteFichier p{};
+            p.disponibleA = versFichier(piste.getDisponibleA(), reference);
+            p.debutOccupation = versFichier(piste.getDebutOccupation(), reference);
+            p.occupationObservee = piste.getOccupationObservee().count();
+            p.libre = piste.estLibre() ? 1 : 0;
+            p.tour = static_cast<uint8_t>(piste.getTour());
+            pistes.push_back(p);
+        }
+
+        liste(e.fileDecollage, f.premierDecollage, f.nombreDecollages);
+        liste(e.dansZone, f.premierDansZone, f.nombreDansZone);
+        f.urgenceEnCours = e.urgenceEnCours ? 1 : 0;
+
+        f.premiereArrivee = static_cast<uint32_t>(arrivees.size());
+        for (const auto& s : e.sequence) {
+            auto it = indexAvion.find(s.avion);
+            if (it == indexAvion.end()) continue;
+            ArriveeFichier a{};
+            a.avion = it->second;
+            a.priorite = static_cast<uint8_t>(s.priorite);
+            a.phase = static_cast<uint8_t>(s.phase);
+            a.pisteFixee = s.pisteFixee ? 1 : 0;
+            a.piste = s.piste;
+            a.ordre = s.ordre;
+            a.heureEstimee = versFichier(s.heureEstimee, reference);
+            a.creneau = versFichier(s.creneau, reference);
+            arrivees.push_back(a);
+        }
+        f.nombreArrivees = static_cast<uint32_t>(arrivees.size()) - f.premiereArrivee;
+        aeroports.push_back(f);
+    }
+
+    EnTeteFichier entete{};
+    liste(enCroisiere, entete.premierEnCroisiere, entete.nombreEnCroisiere);
+
+    std::vector<VolPlanifieFichier> vols;
+    for (const auto& [trajet, instant] : planning) {
+        size_t depart = AUCUN, arrivee = AUCUN;
+        for (size_t i = 0; i < aeroports_.size(); ++i) {
+            if (aeroports_[i]->nom == trajet.first) depart = i;
+            if (aeroports_[i]->nom == trajet.second) arrivee = i;
+        }
+        if (depart != AUCUN && arrivee != AUCUN) {
+            vols.push_back({ static_cast<uint32_t>(depart), static_cast<uint32_t>(arrivee), versFichier(instant, reference) });
+        }
+    }
+
+    // Assemblage : en-tête, table des sections, puis les sections
+    std::vector<char> image(sizeof(EnTeteFichier) + NOMBRE_SECTIONS * sizeof(SectionFichier), 0);
+    std::vector<SectionFichier> table;
+    ajouterSection(image, table, TypeSection::AEROPORTS, aeroports);
+    ajouterSection(image, table, TypeSection::PARKINGS, parkings);
+    ajouterSection(image, table, TypeSection::PISTES, pistes);
+    ajouterSection(image, table, TypeSection::AVIONS, avions);
+    ajouterSection(image, table, TypeSection::POINTS, points);
+    ajouterSection(image, table, TypeSection::ARRIVEES, arrivees);
+    ajouterSection(image, table, TypeSection::LISTES, listes);
+    ajouterSection(image, table, TypeSection::PLANNING, vols);
+    ajouterSection(image, table, TypeSection::CHAINES, chaines);
+
+    std::memcpy(entete.magie, MAGIE, sizeof(MAGIE));
+    entete.version = VERSION;
+    entete.boutisme = BOUTISME;
+    entete.tailleFichier = image.size();
+    entete.nombreSections = static_cast<uint32_t>(table.size());
+    std::memcpy(image.data(), &entete, sizeof(entete));
+    std::memcpy(image.data() + sizeof(entete), table.data(), table.size() * sizeof(SectionFichier));
+    return image;
+}
+
+void Sauvegarde::ecrire(const std::string& chemin, const std::vector<char>& image) const {
+    std::string temporaire = chemin + ".tmp";
+    {
+        std::ofstream fichier(temporaire, std::ios::binary | std::ios::trunc);
+        if (!fichier.is_open()) throw std::runtime_error("Impossible d'ecrire la sauvegarde " + temporaire);
+        fichier.write(image.data(), static_cast<std::streamsize>(image.size()));
+        if (!fichier) throw std::runtime_error("Ecriture de la sauvegarde interrompue : " + temporaire);
+    }
+    std::filesystem::rename(temporaire, chemin); // Remplace l'ancienne sauvegarde d'un seul coup
+}
+
+std::vector<Avion*> Sauvegarde::restaurer(const std::string& chemin) {
+    // Lecture en un bloc, puis validation de l'en-tête et des sections
+    std::ifstream fichier(chemin, std::ios::binary | std::ios::ate);
+    if (!fichier.is_open()) throw std::runtime_error("Sauvegarde pas trouvee : " + chemin);
+    std::vector<char> image(static_cast<size_t>(fichier.tellg()));
+    fichier.seekg(0);
+    fichier.read(image.data(), static_cast<std::streamsize>(image.size()));
+    if (!fichier) throw std::runtime_error("Lecture de la sauvegarde impossible : " + chemin);
+
+    if (image.size() < sizeof(EnTeteFichier)) throw std::runtime_error("Sauvegarde tronquee");
+    EnTeteFichier entete;
+    std::memcpy(&entete, image.data(), sizeof(entete));
+    if (std::memcmp(entete.magie, MAGIE, sizeof(MAGIE)) != 0) throw std::runtime_error("Fichier de sauvegarde invalide : " + chemin);
+    if (entete.boutisme != BOUTISME) throw std::runtime_error("Sauvegarde ecrite sur une machine d'un autre boutisme");
+    if (entete.version != VERSION) throw std::runtime_error("Version de sauvegarde non prise en charge : " + std::to_string(entete.version));
+    if (entete.tailleFichier != image.size()) throw std::runtime_error("Sauvegarde tronquee");
+    if (entete.nombreSections > (image.size() - sizeof(entete)) / sizeof(SectionFichier)) throw std::runtime_error("Sauvegarde tronquee");
+    std::vector<SectionFichier> table(entete.nombreSections);
+    std::memcpy(table.data(), image.data() + sizeof(entete), table.size() * sizeof(SectionFichier));
+
+    auto aeroports = lireSection<AeroportFichier>(image, table, TypeSection::AEROPORTS);
+    auto parkings = lireSection<uint8_t>(image, table, TypeSection::PARKINGS);
+    auto pistes = lireSection<PisteFichier>(image, table, TypeSection::PISTES);
+    auto avionsFichier = lireSection<AvionFichier>(image, table, TypeSection::AVIONS);
+    auto points = lireSection<PointFichier>(image, table, TypeSection::POINTS);
+    auto arrivees = lireSection<ArriveeFichier>(image, table, TypeSection::ARRIVEES);
+    auto listes = lireSection<uint32_t>(image, table, TypeSection::LISTES);
+    auto vols = lireSection<VolPlanifieFichier>(image, table, TypeSection::PLANNING);
+    auto chaines = lireSection<char>(image, table, TypeSection::CHAINES);
+
+    auto texte = [&](ChaineFichier c) {
+        verifierPlage(c.debut, c.longueur, chaines.size());
+        return std::string(chaines.data() + c.debut, c.longueur);
+    };
+
+    // La sauvegarde ne contient que l'état dynamique : le scénario chargé doit être celui de la capture
+    if (aeroports.size() != aeroports_.size()) throw std::runtime_error("Sauvegarde d'un autre scenario (nombre d'aeroports)");
+    for (size_t i = 0; i < aeroports.size(); ++i) {
+        const AeroportFichier& f = aeroports[i];
+        if (texte(f.nom) != aeroports_[i]->nom) throw std::runtime_error("Sauvegarde d'un autre scenario (aeroport " + texte(f.nom) + ")");
+        if (f.nombreParkings != aeroports_[i]->parkings.size() || f.nombrePistes != aeroports_[i]->twr->getNombrePistes()) {
+            throw std::runtime_error("Sauvegarde d'un autre scenario (parkings ou pistes de " + aeroports_[i]->nom + ")");
+        }
+        verifierPlage(f.premierParking, f.nombreParkings, parkings.size());
+        verifierPlage(f.premierePiste, f.nombrePistes, pistes.size());
+        verifierPlage(f.premiereArrivee, f.nombreArrivees, arrivees.size());
+        verifierPlage(f.premierDecollage, f.nombreDecollages, listes.size());
+        verifierPlage(f.premierDansZone, f.nombreDansZone, listes.size());
+    }
+    verifierPlage(entete.premierEnCroisiere, entete.nombreEnCroisiere, listes.size());
+
+    // Toutes les sections sont validées avant de toucher aux contrôleurs : une sauvegarde rejetée les laisse intacts
+    for (const AeroportFichier& f : aeroports) {
+        for (uint32_t k = f.premierePiste; k < f.premierePiste + f.nombrePistes; ++k) {
+            verifier(pistes[k].tour <= static_cast<uint8_t>(Tour::ATTERRISSAGE) && pistes[k].occupationObservee >= 0);
+        }
+        for (uint32_t k = f.premiereArrivee; k < f.premiereArrivee + f.nombreArrivees; ++k) {
+            const ArriveeFichier& a = arrivees[k];
+            verifier(a.avion < avionsFichier.size() && a.piste < f.nombrePistes);
+            verifier(a.priorite <= static_cast<uint8_t>(PrioriteArrivee::NORMALE) && a.phase <= static_cast<uint8_t>(PhaseArrivee::ATTENTE_PISTE));
+        }
+    }
+    for (uint32_t indice : listes) verifier(indice < avionsFichier.size()); // Les listes ne contiennent que des indices d'avions
+    for (const auto& v : vols) verifier(v.depart < aeroports_.size() && v.arrivee < aeroports_.size());
+
+    // Une piste d'avion désigne une piste de sa destination à l'arrivée, de son aéroport de départ au départ ; ailleurs
+    // elle peut rester celle d'un autre aéroport (l'APP la borne à la prise en charge), mais toujours d'un aéroport existant
+    size_t maxPistes = 0;
+    for (auto aero : aeroports_) maxPistes = std::max(maxPistes, aero->twr->getNombrePistes());
+    auto pisteArrivee = [](EtatAvion e) { return e == EtatAvion::EN_ATTENTE_ATTERRISSAGE || e == EtatAvion::ATTERRISSAGE || e == EtatAvion::ROULE_VERS_PARKING; };
+    auto pisteDepart = [](EtatAvion e) { return e == EtatAvion::ROULE_VERS_PISTE || e == EtatAvion::EN_ATTENTE_PISTE || e == EtatAvion::DECOLLAGE; };
+
+    auto reference = Horloge::getHorloge().maintenant();
+    std::vector<Avion*> avions;
+    try {
+        // Avions
+        std::vector<Position> trajectoire;
+        for (const auto& a : avionsFichier) {
+            verifier(a.etat <= static_cast<uint32_t>(EtatAvion::TERMINE) && a.typeUrgence <= static_cast<uint32_t>(TypeUrgence::CARBURANT));
+            verifier(a.destination == AUCUN || a.destination < aeroports_.size());
+            verifier(a.aeroportParking == AUCUN || (a.aeroportParking < aeroports_.size() && a.parking < aeroports_[a.aeroportParking]->parkings.size()));
+            verifierPlage(a.premierPoint, a.nombrePoints, points.size());
+            verifier(std::isfinite(a.x) && std::isfinite(a.y) && std::isfinite(a.altitude));
+            verifier(std::isfinite(a.vitesse) && std::isfinite(a.vitesseSol) && std::isfinite(a.carburant) && std::isfinite(a.consommation)
+                     && std::isfinite(a.dureeStationnement));
+
+            Position position(a.x, a.y, a.altitude);
+            EtatAvion etatFichier = static_cast<EtatAvion>(a.etat);
+            verifier(a.piste < maxPistes);
+            if (pisteArrivee(etatFichier)) verifier(a.destination != AUCUN && a.piste < aeroports_[a.destination]->twr->getNombrePistes());
+            if (pisteDepart(etatFichier)) {
+                Aeroport* depart = aeroportLePlusProche(position);
+                verifier(depart && a.piste < depart->twr->getNombrePistes());
+            }
+            avions.push_back(new Avion(texte(a.nom), a.vitesse, a.vitesseSol, a.carburant, a.consommation, a.dureeStationnement, position));
+
+            InstantaneAvion etat{};
+            etat.position = position;
+            etat.etat = static_cast<EtatAvion>(a.etat);
+            etat.carburant = a.carburant;
+            etat.typeUrgence = static_cast<TypeUrgence>(a.typeUrgence);
+            etat.destination = (a.destination == AUCUN) ? nullptr : aeroports_[a.destination];
+            etat.parking = (a.aeroportParking == AUCUN) ? nullptr : &aeroports_[a.aeroportParking]->parkings[a.parking];
+            etat.piste = static_cast<size_t>(a.piste);
+            trajectoire.clear();
+            for (uint32_t k = a.premierPoint; k < a.premierPoint + a.nombrePoints; ++k) {
+                verifier(std::isfinite(points[k].x) && std::isfinite(points[k].y) && std::isfinite(points[k].altitude));
+                trajectoire.push_back(Position(points[k].x, points[k].y, points[k].altitude));
+            }
+            avions.back()->restaurer(etat, trajectoire);
+        }
+
+        auto avionsListe = [&](uint32_t premier, uint32_t nombre) {
+            std::vector<Avion*> contenu;
+            for (uint32_t k = premier; k < premier + nombre; ++k) contenu.push_back(avions[listes[k]]);
+            return contenu;
+        };
+        auto enApproche = [](EtatAvion e) { return e == EtatAvion::EN_APPROCHE || e == EtatAvion::EN_ATTENTE_ATTERRISSAGE; };
+        auto auDepart = [](EtatAvion e) {
+            return e == EtatAvion::EN_ATTENTE_DECOLLAGE || e == EtatAvion::ROULE_VERS_PISTE || e == EtatAvion::EN_ATTENTE_PISTE || e == EtatAvion::DECOLLAGE;
+        };
+
+        // Les boîtes de messages ne sont pas sauvegardées et un avion a pu changer d'état après la capture de son contrôleur :
+        // chaque liste ne garde que les avions dans un état qui la concerne, les autres sont rendus à leur contrôleur ensuite
+        std::unordered_set<const Avion*> suivisAPP, suivisTWR;
+        for (size_t i = 0; i < aeroports.size(); ++i) {
+            const AeroportFichier& f = aeroports[i];
+            Aeroport* aero = aeroports_[i];
+
+            for (uint32_t k = 0; k < f.nombreParkings; ++k) {
+                if (parkings[f.premierParking + k]) aero->parkings[k].occuper();
+                else aero->parkings[k].liberer();
+            }
+
+            std::vector<Piste> pistesTour = aero->twr->getPistes();
+            for (uint32_t k = 0; k < f.nombrePistes; ++k) {
+                const PisteFichier& p = pistes[f.premierePiste + k];
+                pistesTour[k].restaurer(p.libre != 0, depuisFichier(p.disponibleA, reference), depuisFichier(p.debutOccupation, reference),
+                                        std::chrono::milliseconds(p.occupationObservee), static_cast<Tour>(p.tour));
+            }
+            std::vector<Avion*> fileDecollage;
+            for (Avion* avion : avionsListe(f.premierDecollage, f.nombreDecollages)) {
+                if (auDepart(avion->getEtat())) { fileDecollage.push_back(avion); suivisTWR.insert(avion); }
+            }
+            aero->twr->restaurer(pistesTour, fileDecollage, f.urgenceEnCours != 0);
+
+            std::vector<ArriveeSauvegardee> sequence;
+            for (uint32_t k = f.premiereArrivee; k < f.premiereArrivee + f.nombreArrivees; ++k) {
+                const ArriveeFichier& a = arrivees[k];
+                Avion* avion = avions[a.avion];
+                if (!enApproche(avion->getEtat())) continue; // Déjà autorisé par la tour
+                sequence.push_back({ avion, static_cast<PrioriteArrivee>(a.priorite), depuisFichier(a.heureEstimee, reference), a.ordre,
+                                     static_cast<size_t>(a.piste), a.pisteFixee != 0, depuisFichier(a.creneau, reference), static_cast<PhaseArrivee>(a.phase) });
+                suivisAPP.insert(avion);
+            }
+            std::vector<Avion*> dansZone;
+            for (Avion* avion : avionsListe(f.premierDansZone, f.nombreDansZone)) {
+                if (suivisAPP.count(avion)) dansZone.push_back(avion);
+            }
+            aero->app->restaurer(dansZone, sequence);
+        }
+
+        // CCR : avions en croisière qu'aucun APP n'a pris en charge, dans l'ordre sauvegardé puis ceux qui attendaient dans sa boîte
+        std::vector<Avion*> enCroisiere;
+        std::unordered_set<const Avion*> suivisCCR;
+        auto ajouterCroisiere = [&](Avion* avion) {
+            if (avion->getEtat() == EtatAvion::EN_ROUTE && !suivisAPP.count(avion) && suivisCCR.insert(avion).second) enCroisiere.push_back(avion);
+        };
+        for (Avion* avion : avionsListe(entete.premierEnCroisiere, entete.nombreEnCroisiere)) ajouterCroisiere(avion);
+        for (Avion* avion : avions) ajouterCroisiere(avion);
+
+        CCR::PlanningVols planning;
+        for (const auto& v : vols) {
+            planning[{ aeroports_[v.depart]->nom, aeroports_[v.arrivee]->nom }] = depuisFichier(v.instant, reference);
+        }
+        ccr_.restaurer(enCroisiere, planning);
+
+        // Avions qui étaient encore dans une boîte de l'APP ou de la tour à la capture
+        for (Avion* avion : avions) {
+            EtatAvion e = avion->getEtat();
+            if (enApproche(e) && !suivisAPP.count(avion) && avion->getDestination()) {
+                avion->getDestination()->app->deposerTransfert(avion);
+            }
+            else if (auDepart(e) && !suivisTWR.count(avion)) {
+                // Aéroport de départ : le plus proche de l'avion
+                Aeroport* depart = aeroportLePlusProche(avion->getPosition());
+                if (depart) {
+                    depart->twr->enregistrerPourDecollage(avion);
+                    avion->setEtat(e); // L'enregistrement remet l'avion en attente au parking
+                }
+            }
+        }
+    }
+    catch (...) {
+        for (Avion* avion : avions) delete avion;
+        throw;
+    }
+    return avions;
+}
@@ -2,6 +2,12 @@
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <fstream>
+#include <iostream>
 
 // constantes d'affichage
 const unsigned int LARGEUR = 1100;
@@ -10,6 +16,12 @@ float ECHELLE = 0.00068f;
 float DECALAGE_GAUCHE = 600.0f;
 float DECALAGE_DROITE = 280.0f;
 const float PI = 3.14159265f;
+const size_t SEUIL_AVIONS_DENSITE = 2000;
+const float ZOOM_MIN_DENSITE = 0.5f;
+const std::array<double, 7> FACTEURS_TEMPS = { 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0 };
+const float SATURATION_DENSITE = 64.f; // Nombre d'avions par cellule pour la couleur la plus intense
+const int AUCUNE_CELLULE = -1;
+const size_t ENVOIS_TUILES_PAR_IMAGE = 4; // Tuiles dcodes envoyes  la carte graphique par image au plus
 
 // Pour convertir les coordonnes du monde en coordonnes relles
 sf::Vector2f conversion(Position pos) {
@@ -19,19 +31,18 @@ sf::Vector2f conversion(Position pos) {
     );
 }
 
-// Adapte l'image de fond  la taille de la fentre
-void adapterFondFenetre(sf::Sprite& sprite, const sf::Texture& texture) {
-    sf::Vector2u size = texture.getSize();
-    if (size.x > 0 && size.y > 0) {
-        sprite.setTexture(texture);
-        sprite.setScale({ 1.f, 1.f });
-        // Calcul du ratio pour remplir la fentre
-        sprite.setScale({ (float)LARGEUR / size.x, (float)HAUTEUR / size.y });
+// Construit les lignes des voies ariennes en coordonnes cran
+sf::VertexArray construireVoiesAeriennes(const ReseauAerien& reseau) {
+    sf::VertexArray voies(sf::PrimitiveType::Lines);
+    for (const auto& [a, b] : reseau.getSegments()) {
+        voies.append({ conversion(a), sf::Color(90, 90, 160, 90) });
+        voies.append({ conversion(b), sf::Color(90, 90, 160, 90) });
     }
+    return voies;
 }
 
 // Affiche les aroports sur la carte 
-void dessinerAeroports(sf::RenderWindow& window, const std::vector<Aeroport*>& aeroports, const sf::Font& police, bool Police) {
+void dessinerAeroports(sf::RenderTarget& cible, const std::vector<Aeroport*>& aeroports, const sf::Font& police, bool Police) {
     for (auto aero : aeroports) {
         sf::Vector2f p = conversion(aero->position);
 
@@ -40,7 +51,7 @@ void dessinerAeroports(sf::RenderWindow& window, const std::vector<Aeroport*>& a
         point.setFillColor(sf::Color::Red);
         point.setOrigin({ 5.f, 5.f });
         point.setPosition(p);
-        window.draw(point);
+        cible.draw(point);
 
         // Zone de contrle arien (cercle transparent)
         float rayonVisuel = aero->rayonControle * ECHELLE;
@@ -50,33 +61,51 @@ void dessinerAeroports(sf::RenderWindow& window, const std::vector<Aeroport*>& a
         zone.setOutlineThickness(1.f);
         zone.setOrigin({ rayonVisuel, rayonVisuel });
         zone.setPosition(p);
-        window.draw(zone);
+        cible.draw(zone);
 
         // Affichage du nom si la police est charge
         if (Police) {
             sf::Text text(police, aero->nom, 12);
             text.setPosition({ p.x + 10.f, p.y - 10.f });
             text.setFillColor(sf::Color::White);
-            window.draw(text);
+            cible.draw(text);
         }
     }
 }
 
 // Affiche les dtails d'un aroport (piste, parkings) lors du zoom
-void dessinerDetailsAeroport(sf::RenderWindow& window, Aeroport* aero, const sf::Font& police, bool Police, float zoom) {
-    // Dessin de la piste
-    Position posPiste = aero->twr->getPositionPiste();
-    Position posVisuellePiste = posPiste + Position(750, 0, 0);
-    sf::Vector2f pPiste = conversion(posVisuellePiste);
-
-    sf::Vector2f taillePiste = { 1500.f * ECHELLE, 60.f * ECHELLE };
-    sf::RectangleShape rectPiste(taillePiste);
-    rectPiste.setOrigin({ taillePiste.x / 2.f, taillePiste.y / 2.f });
-    rectPiste.setPosition(pPiste);
-    rectPiste.setFillColor(sf::Color(80, 80, 80));
-    rectPiste.setOutlineColor(sf::Color::Black);
-    rectPiste.setOutlineThickness(1.f * zoom);
-    window.draw(rectPiste);
+void dessinerDetailsAeroport(sf::RenderTarget& cible, Aeroport* aero, const sf::Font& police, bool Police, float zoom) {
+    // Dessin des pistes (contour rouge = occupe)
+    for (const auto& piste : aero->twr->getPistes()) {
+        Position posVisuellePiste = piste.getSeuil() + Position(750, 0, 0);
+        sf::Vector2f pPiste = conversion(posVisuellePiste);
+
+        sf::Vector2f taillePiste = { 1500.f * ECHELLE, 60.f * ECHELLE };
+        sf::RectangleShape rectPiste(taillePiste);
+        rectPiste.setOrigin({ taillePiste.x / 2.f, taillePiste.y / 2.f });
+        rectPiste.setPosition(pPiste);
+        rectPiste.setFillColor(sf::Color(80, 80, 80));
+        rectPiste.setOutlineColor(piste.estLibre() ? sf::Color::Black : sf::Color::Red);
+        rectPiste.setOutlineThickness(1.f * zoom);
+        cible.draw(rectPiste);
+
+        // Nom de la piste
+        if (Police) {
+            sf::Text txtPiste(police, piste.getNom(), 8);
+            txtPiste.setScale({ zoom, zoom });
+            txtPiste.setPosition(conversion(piste.getSeuil()) + sf::Vector2f(0.f, taillePiste.y));
+            txtPiste.setFillColor(sf::Color::Black);
+            cible.draw(txtPiste);
+        }
+    }
+
+    // Dessin des voies de circulation (rseau de roulage)
+    sf::VertexArray voies(sf::PrimitiveType::Lines);
+    for (const auto& [a, b] : aero->roulage.getArcs()) {
+        voies.append({ conversion(a), sf::Color(230, 190, 0) });
+        voies.append({ conversion(b), sf::Color(230, 190, 0) });
+    }
+    cible.draw(voies);
 
     // Dessin des parkings (Vert = Libre, Rouge = Occup)
     for (const auto& parking : aero->parkings) {
@@ -95,7 +124,7 @@ void dessinerDetailsAeroport(sf::RenderWindow& window, Aeroport* aero, const sf:
             rectParking.setOutlineColor(sf::Color::Green);
         }
         rectParking.setOutlineThickness(1.f * zoom);
-        window.draw(rectParking);
+        cible.draw(rectParking);
 
         // Nom du parking
         if (Police) {
@@ -103,14 +132,14 @@ void dessinerDetailsAeroport(sf::RenderWindow& window, Aeroport* aero, const sf:
             txtPkg.setScale({ zoom, zoom });
             txtPkg.setPosition({ pParking.x - tailleParking / 2, pParking.y - tailleParking });
             txtPkg.setFillColor(sf::Color::Black);
-            window.draw(txtPkg);
+            cible.draw(txtPkg);
         }
     }
 }
 
 // Affiche un avion avec rotation et couleur selon statut
-void dessinerAvion(sf::RenderWindow& window, Avion* avion, const sf::Texture& texture, bool hasTexture, const sf::Font& police, bool Police, float zoom, Avion* selection, Aeroport* vue) {
-    sf::Vector2f screenPos = conversion(avion->getPosition());
+void dessinerAvion(sf::RenderTarget& cible, Avion* avion, const InstantaneAvion& etat, const sf::Texture& texture, bool hasTexture, const sf::Font& police, bool Police, float zoom, Avion* selection, Aeroport* vue) {
+    sf::Vector2f screenPos = conversion(etat.position);
 
     if (hasTexture) {
         sf::Sprite spriteAvion(texture);
@@ -125,12 +154,11 @@ void dessinerAvion(sf::RenderWindow& window, Avion* avion, const sf::Texture& te
 
         // Calcul de l'orientation de l'avion selon sa trajectoire
         float angleDeg = 0.0f;
-        auto traj = avion->getTrajectoire();
-        if (!traj.empty()) {
-            Position cible = traj.front();
-            sf::Vector2f posCibleEcran = conversion(cible);
-            float dx = posCibleEcran.x - screenPos.x;
-            float dy = posCibleEcran.y - screenPos.y;
+        if (!etat.trajectoireTerminee) {
+            Position suivant = etat.prochainPoint;
+            sf::Vector2f posSuivantEcran = conversion(suivant);
+            float dx = posSuivantEcran.x - screenPos.x;
+            float dy = posSuivantEcran.y - screenPos.y;
             if (std::abs(dx) > 0.1f || std::abs(dy) > 0.1f) {
                 angleDeg = std::atan2(dy, dx) * 180.f / PI + 90.f; 
             }
@@ -138,21 +166,19 @@ void dessinerAvion(sf::RenderWindow& window, Avion* avion, const sf::Texture& te
         spriteAvion.setRotation(sf::degrees(angleDeg));
 
         // Couleur selon le statut
-        if (avion->estEnUrgence()) spriteAvion.setColor(sf::Color::Red);
+        if (etat.estEnUrgence()) spriteAvion.setColor(sf::Color::Red);
         else if (avion == selection) spriteAvion.setColor(sf::Color::Green);
         else spriteAvion.setColor(sf::Color::White);
 
-        // Affichage si dans la vue (optimisation)
-        if (vue == nullptr || avion->getPosition().distance(vue->position) < 10000.0f) {
-            window.draw(spriteAvion);
-            // Affichage du nom en vue zoome
-            if (Police && vue != nullptr) {
-                sf::Text nom(police, avion->getNom(), 8);
-                nom.setScale({ zoom, zoom });
-                nom.setPosition({ screenPos.x + 10.f * zoom, screenPos.y - 10.f * zoom });
-                nom.setFillColor(sf::Color::Black);
-                window.draw(nom);
-            }
+        // Les avions hors de la vue ne sont pas transmis (IndexEcran)
+        cible.draw(spriteAvion);
+        // Affichage du nom en vue zoome
+        if (Police && vue != nullptr) {
+            sf::Text nom(police, avion->getNom(), 8);
+            nom.setScale({ zoom, zoom });
+            nom.setPosition({ screenPos.x + 10.f * zoom, screenPos.y - 10.f * zoom });
+            nom.setFillColor(sf::Color::Black);
+            cible.draw(nom);
         }
     } else {
         // Affichage d'un point si l'image d'avion est manquante
@@ -161,16 +187,16 @@ void dessinerAvion(sf::RenderWindow& window, Avion* avion, const sf::Texture& te
         rond.setOrigin({ rayonBase, rayonBase });
         rond.setPosition(screenPos);
         rond.setScale({ zoom, zoom });
-        if (avion->estEnUrgence()) rond.setFillColor(sf::Color::Red);
+        if (etat.estEnUrgence()) rond.setFillColor(sf::Color::Red);
         else if (avion == selection) rond.setFillColor(sf::Color::Green);
         else rond.setFillColor(sf::Color::Cyan);
-        window.draw(rond);
+        cible.draw(rond);
     }
 }
 
 // Affiche la fentre d'informations pour l'avion slectionn
-void dessinerInfo(sf::RenderWindow& window, Avion* avion, const sf::Font& police, float zoom) {
-    sf::Vector2f screenPos = conversion(avion->getPosition());
+void dessinerInfo(sf::RenderTarget& cible, Avion* avion, const InstantaneAvion& etat, const sf::Font& police, float zoom) {
+    sf::Vector2f screenPos = conversion(etat.position);
     sf::Vector2f tailleBox = { 240.f, 140.f };
     
     // Fond semi-transparent
@@ -180,46 +206,609 @@ void dessinerInfo(sf::RenderWindow& window, Avion* avion, const sf::Font& police
     infoBox.setOutlineThickness(1.f);
     infoBox.setScale({ zoom, zoom });
     infoBox.setPosition(screenPos + sf::Vector2f(20.f * zoom, -60.f * zoom));
-    window.draw(infoBox);
+    cible.draw(infoBox);
 
     // Construction du texte d'information
     std::stringstream ss;
     ss << "VOL: " << avion->getNom() << "\n"
-       << "Dest: " << (avion->getDestination() ? avion->getDestination()->nom : "N/A") << "\n"
-       << "Alt: " << (int)avion->getPosition().getAltitude() << " m\n"
-       << "Fuel: " << (int)avion->getCarburant() << " L\n";
+       << "Dest: " << (etat.destination ? etat.destination->nom : "N/A") << "\n"
+       << "Alt: " << (int)etat.position.getAltitude() << " m\n"
+       << "Fuel: " << (int)etat.carburant << " L\n";
 
     // Vitesse affiche selon l'tat (Sol vs Vol)
     float vit = 0.f;
-    EtatAvion e = avion->getEtat();
+    EtatAvion e = etat.etat;
     if (e == EtatAvion::ROULE_VERS_PISTE || e == EtatAvion::ROULE_VERS_PARKING) vit = avion->getVitesseSol();
     else if (e != EtatAvion::STATIONNE && e != EtatAvion::EN_ATTENTE_DECOLLAGE && e != EtatAvion::EN_ATTENTE_PISTE) vit = avion->getVitesse() / 2.f;
     
     ss << "Vit: " << (int)vit << " km/h\n";
     
-    if (avion->estEnUrgence()) ss << "URGENCE ACTIVE\n";
+    if (etat.estEnUrgence()) ss << "URGENCE ACTIVE\n";
     
-    // Traduction de l'tat en texte lisible
-    std::string etatStr = "Inconnu";
-    switch (e) {
-        case EtatAvion::STATIONNE: etatStr = "Stationne"; break;
-        case EtatAvion::EN_ATTENTE_DECOLLAGE: etatStr = "Attente Decollage"; break;
-        case EtatAvion::ROULE_VERS_PISTE: etatStr = "Roule vers Piste"; break;
-        case EtatAvion::EN_ATTENTE_PISTE: etatStr = "Seuil Piste"; break;
-        case EtatAvion::DECOLLAGE: etatStr = "Decollage"; break;
-        case EtatAvion::EN_ROUTE: etatStr = "En Croisiere"; break;
-        case EtatAvion::EN_APPROCHE: etatStr = "Approche"; break;
-        case EtatAvion::EN_ATTENTE_ATTERRISSAGE: etatStr = "Circuit Attente"; break;
-        case EtatAvion::ATTERRISSAGE: etatStr = "Atterrissage"; break;
-        case EtatAvion::ROULE_VERS_PARKING: etatStr = "Roule vers Parking"; break;
-        case EtatAvion::TERMINE: etatStr = "Termine"; break;
-        default: break;
-    }
-    ss << "Etat: " << etatStr;
+    ss << "Etat: " << nomEtat(e);
 
     sf::Text text(police, ss.str(), 14);
     text.setScale({ zoom, zoom });
     text.setPosition(infoBox.getPosition() + sf::Vector2f(10.f * zoom, 10.f * zoom));
-    text.setFillColor(avion->estEnUrgence() ? sf::Color::Red : sf::Color::White);
-    window.draw(text);
-}
\ No newline at end of file
+    text.setFillColor(etat.estEnUrgence() ? sf::Color::Red : sf::Color::White);
+    cible.draw(text);
+}
+
+CarteDensite::CarteDensite(float tailleCellule)
+    : colonnes_(0), lignes_(0), tailleCellule_(tailleCellule), avionsVisibles_(0), modifiee_(true) {
+    if (tailleCellule < 1.f) throw std::invalid_argument("Taille de cellule de densite trop petite");
+    colonnes_ = static_cast<unsigned int>(std::ceil(LARGEUR / tailleCellule));
+    lignes_ = static_cast<unsigned int>(std::ceil(HAUTEUR / tailleCellule));
+    comptes_.assign(colonnes_ * lignes_, 0);
+    pixels_.assign(colonnes_ * lignes_ * 4, 0); // Transparent
+    if (!texture_.resize({ colonnes_, lignes_ })) throw std::runtime_error("Texture de densite non creee");
+    texture_.setSmooth(true); // Lissage entre cellules voisines
+}
+
+int CarteDensite::trouverCellule(sf::Vector2f ecran) const {
+    if (ecran.x < 0.f || ecran.y < 0.f) return AUCUNE_CELLULE;
+    unsigned int colonne = static_cast<unsigned int>(ecran.x / tailleCellule_);
+    unsigned int ligne = static_cast<unsigned int>(ecran.y / tailleCellule_);
+    if (colonne >= colonnes_ || ligne >= lignes_) return AUCUNE_CELLULE;
+    return static_cast<int>(ligne * colonnes_ + colonne);
+}
+
+void CarteDensite::colorerCellule(int cellule) {
+    std::uint8_t* pixel = &pixels_[static_cast<size_t>(cellule) * 4];
+    unsigned int n = comptes_[cellule];
+    if (n == 0) {
+        pixel[3] = 0; // Cellule vide : la carte reste visible
+        return;
+    }
+    // Intensit logarithmique (quelques avions restent visibles  ct des cellules satures), du bleu au jaune puis au rouge
+    float t = std::min(1.f, std::log2(1.f + n) / std::log2(1.f + SATURATION_DENSITE));
+    pixel[0] = static_cast<std::uint8_t>(255.f * std::min(1.f, 2.f * t));
+    pixel[1] = static_cast<std::uint8_t>(255.f * (t < 0.5f ? 2.f * t : 2.f * (1.f - t)));
+    pixel[2] = static_cast<std::uint8_t>(255.f * std::max(0.f, 1.f - 2.f * t));
+    pixel[3] = static_cast<std::uint8_t>(90.f + 140.f * t);
+}
+
+void CarteDensite::mettreAJour(const std::vector<Avion*>& flotte) {
+    if (celluleAvion_.size() < flotte.size()) celluleAvion_.resize(flotte.size(), AUCUNE_CELLULE);
+    avionsVisibles_ = 0;
+
+    for (size_t i = 0; i < flotte.size(); ++i) {
+        int cellule = AUCUNE_CELLULE;
+        if (flotte[i]) {
+            InstantaneAvion etat = flotte[i]->getInstantane();
+            if (etat.etat != EtatAvion::TERMINE) cellule = trouverCellule(conversion(etat.position));
+        }
+        if (cellule != AUCUNE_CELLULE) avionsVisibles_++;
+
+        int ancienne = celluleAvion_[i];
+        if (cellule == ancienne) continue; // Toujours dans la mme cellule : rien  recolorer
+        if (ancienne != AUCUNE_CELLULE) {
+            comptes_[ancienne]--;
+            colorerCellule(ancienne);
+        }
+        if (cellule != AUCUNE_CELLULE) {
+            comptes_[cellule]++;
+            colorerCellule(cellule);
+        }
+        celluleAvion_[i] = cellule;
+        modifiee_ = true;
+    }
+}
+
+size_t CarteDensite::getAvionsVisibles() const { return avionsVisibles_; }
+
+void CarteDensite::dessiner(sf::RenderTarget& cible) {
+    if (modifiee_) {
+        texture_.update(pixels_.data()); // Un seul envoi par image, quelle que soit la taille de la flotte
+        modifiee_ = false;
+    }
+    sf::Sprite couche(texture_);
+    couche.setScale({ tailleCellule_, tailleCellule_ });
+    cible.draw(couche);
+}
+
+TableauBord::TableauBord() : etats_() {}
+
+void TableauBord::mettreAJour(const Indicateurs& indicateurs, std::chrono::steady_clock::time_point instant) {
+    indicateurs.relever(instant, aeroports_, etats_);
+}
+
+void TableauBord::dessiner(sf::RenderTarget& cible, const std::vector<Aeroport*>& aeroports, const sf::Font& police) const {
+    const unsigned int taille = 13;
+    const float interligne = 16.f;
+    const size_t lignes = std::min(aeroports.size(), aeroports_.size());
+
+    // Avions par tat (hors avions termins), sur deux lignes
+    std::stringstream flotte;
+    for (size_t e = 0; e + 1 < Indicateurs::NOMBRE_ETATS; ++e) {
+        flotte << nomEtat(static_cast<EtatAvion>(e)) << " " << etats_[e] << ((e == 4) ? "\n" : "   ");
+    }
+
+    // Une colonne par indicateur, une ligne par aroport : un texte par colonne
+    const char* titres[] = { "Aeroport", "Arr/h", "Dep/h", "Attente", "Pistes", "Parkings" };
+    const float abscisses[] = { 0.f, 130.f, 190.f, 250.f, 320.f, 385.f };
+    std::stringstream colonnes[6];
+    for (size_t c = 0; c < 6; ++c) colonnes[c] << titres[c] << "\n";
+    for (size_t i = 0; i < lignes; ++i) {
+        const IndicateursAeroport& a = aeroports_[i];
+        colonnes[0] << aeroports[i]->nom << "\n";
+        colonnes[1] << std::fixed << std::setprecision(0) << a.arriveesHeure << "\n";
+        colonnes[2] << std::fixed << std::setprecision(0) << a.departsHeure << "\n";
+        colonnes[3] << std::fixed << std::setprecision(0) << a.attenteMoyenne << " s\n";
+        colonnes[4] << std::fixed << std::setprecision(0) << 100.0 * a.utilisationPistes << " %\n";
+        colonnes[5] << a.parkingsOccupes << "/" << a.parkings << "\n";
+    }
+
+    sf::Vector2f origine(10.f, 10.f);
+    sf::RectangleShape fond({ 560.f, 3 * interligne + (static_cast<float>(lignes) + 1) * interligne + 20.f });
+    fond.setPosition(origine);
+    fond.setFillColor(sf::Color(0, 0, 0, 180));
+    cible.draw(fond);
+
+    sf::Text texte(police, flotte.str(), taille);
+    texte.setFillColor(sf::Color(200, 220, 255));
+    texte.setPosition(origine + sf::Vector2f(10.f, 8.f));
+    cible.draw(texte);
+
+    texte.setFillColor(sf::Color::White);
+    texte.setLineSpacing(interligne / police.getLineSpacing(taille));
+    for (size_t c = 0; c < 6; ++c) {
+        texte.setString(colonnes[c].str());
+        texte.setPosition(origine + sf::Vector2f(10.f + abscisses[c], 8.f + 3 * interligne));
+        cible.draw(texte);
+    }
+}
+
+TracesAvions::TracesAvions(size_t maxAvions, size_t pointsParAvion, std::chrono::milliseconds intervalle)
+    : capacite_(pointsParAvion), intervalle_(intervalle),
+    points_(maxAvions * pointsParAvion), prochain_(maxAvions, 0), nombre_(maxAvions, 0),
+    dernierEchantillon_(), sommets_(sf::PrimitiveType::LineStrip) {
+    if (pointsParAvion < 2) throw std::invalid_argument("Une trace contient au moins deux points");
+    if (intervalle.count() <= 0) throw std::invalid_argument("Intervalle d'echantillonnage des traces invalide");
+}
+
+void TracesAvions::echantillonner(const std::vector<Avion*>& flotte) {
+    auto maintenant = Horloge::getHorloge().maintenant();
+    if (maintenant - dernierEchantillon_ < intervalle_) return;
+    dernierEchantillon_ = maintenant;
+
+    // Au-del de la taille de l'arne, les avions n'ont pas de trace
+    size_t n = std::min(flotte.size(), prochain_.size());
+    for (size_t i = 0; i < n; ++i) {
+        if (!flotte[i]) continue;
+        InstantaneAvion etat = flotte[i]->getInstantane();
+        if (etat.etat == EtatAvion::TERMINE) continue;
+        points_[i * capacite_ + prochain_[i]] = etat.position; // Ecrase le plus ancien une fois le tampon plein
+        prochain_[i] = (prochain_[i] + 1) % capacite_;
+        nombre_[i] = std::min(nombre_[i] + 1, capacite_);
+    }
+}
+
+void TracesAvions::ajouterTrace(size_t emplacement, Position actuelle) {
+    size_t n = nombre_[emplacement];
+    if (n == 0) return;
+    const Position* tampon = &points_[emplacement * capacite_];
+    size_t premier = (prochain_[emplacement] + capacite_ - n) % capacite_;
+
+    // Sommet transparent : la ligne brise ne relie pas la trace prcdente  celle-ci
+    sommets_.append({ conversion(tampon[premier]), sf::Color::Transparent });
+    for (size_t k = 0; k < n; ++k) {
+        // Plus le point est ancien, plus il est transparent
+        auto alpha = static_cast<std::uint8_t>(40 + 180 * (k + 1) / n);
+        sommets_.append({ conversion(tampon[(premier + k) % capacite_]), sf::Color(255, 140, 0, alpha) });
+    }
+    sommets_.append({ conversion(actuelle), sf::Color(255, 140, 0, 220) }); // Jusqu' l'avion lui-mme
+    sommets_.append({ conversion(actuelle), sf::Color::Transparent });
+}
+
+void TracesAvions::dessiner(sf::RenderTarget& cible, const std::vector<Avion*>& flotte, const Avion* seul) {
+    sommets_.clear(); // Garde la capacit dj alloue
+    size_t n = std::min(flotte.size(), prochain_.size());
+    for (size_t i = 0; i < n; ++i) {
+        if (!flotte[i] || (seul && flotte[i] != seul)) continue;
+        InstantaneAvion etat = flotte[i]->getInstantane();
+        if (etat.etat != EtatAvion::TERMINE) ajouterTrace(i, etat.position);
+    }
+    if (sommets_.getVertexCount() > 0) cible.draw(sommets_);
+}
+
+IndexEcran::IndexEcran(float tailleCellule) : colonnes_(0), lignes_(0), tailleCellule_(tailleCellule) {
+    if (tailleCellule < 1.f) throw std::invalid_argument("Taille de cellule d'index trop petite");
+    colonnes_ = static_cast<unsigned int>(std::ceil(LARGEUR / tailleCellule));
+    lignes_ = static_cast<unsigned int>(std::ceil(HAUTEUR / tailleCellule));
+    debutCellule_.assign(colonnes_ * lignes_ + 1, 0);
+}
+
+unsigned int IndexEcran::colonne(float x) const {
+    if (!(x > 0.f)) return 0; // Ngatif ou NaN
+    return std::min(static_cast<unsigned int>(x / tailleCellule_), colonnes_ - 1);
+}
+
+unsigned int IndexEcran::ligne(float y) const {
+    if (!(y > 0.f)) return 0;
+    return std::min(static_cast<unsigned int>(y / tailleCellule_), lignes_ - 1);
+}
+
+void IndexEcran::construire(const std::vector<Avion*>& flotte, std::chrono::steady_clock::time_point instant) {
+    tampon_.clear();
+    cellules_.clear();
+    std::fill(debutCellule_.begin(), debutCellule_.end(), 0);
+
+    for (Avion* avion : flotte) {
+        if (!avion) continue;
+        InstantaneAvion etat = avion->getInstantane();
+        if (etat.etat == EtatAvion::TERMINE) continue;
+        etat.position = etat.interpoler(instant);
+        sf::Vector2f ecran = conversion(etat.position);
+        size_t cellule = ligne(ecran.y) * colonnes_ + colonne(ecran.x);
+        tampon_.push_back({ avion, etat, ecran });
+        cellules_.push_back(cellule);
+        debutCellule_[cellule + 1]++;
+    }
+
+    // Tri par comptage : cumul des effectifs puis placement de chaque avion dans sa cellule
+    for (size_t c = 1; c < debutCellule_.size(); ++c) debutCellule_[c] += debutCellule_[c - 1];
+    avions_.resize(tampon_.size());
+    std::vector<size_t> place(debutCellule_.begin(), debutCellule_.end() - 1);
+    for (size_t i = 0; i < tampon_.size(); ++i) avions_[place[cellules_[i]]++] = tampon_[i];
+}
+
+void IndexEcran::rechercher(sf::FloatRect zone, std::vector<const AvionEcran*>& resultat) const {
+    resultat.clear();
+    unsigned int c0 = colonne(zone.position.x), c1 = colonne(zone.position.x + zone.size.x);
+    unsigned int l0 = ligne(zone.position.y), l1 = ligne(zone.position.y + zone.size.y);
+    for (unsigned int l = l0; l <= l1; ++l) {
+        for (size_t i = debutCellule_[l * colonnes_ + c0]; i < debutCellule_[l * colonnes_ + c1 + 1]; ++i) {
+            // Les cellules d'une ligne sont contigus ; test exact pour les cellules du bord de la zone
+            if (zone.contains(avions_[i].ecran)) resultat.push_back(&avions_[i]);
+        }
+    }
+}
+
+Avion* IndexEcran::choisir(sf::Vector2f point, float rayon) const {
+    std::vector<const AvionEcran*> candidats;
+    rechercher(sf::FloatRect({ point.x - rayon, point.y - rayon }, { 2.f * rayon, 2.f * rayon }), candidats);
+
+    Avion* meilleur = nullptr;
+    float meilleureDistance = rayon * rayon;
+    for (const AvionEcran* candidat : candidats) {
+        float dx = candidat->ecran.x - point.x;
+        float dy = candidat->ecran.y - point.y;
+        if (dx * dx + dy * dy < meilleureDistance) {
+            meilleureDistance = dx * dx + dy * dy;
+            meilleur = candidat->avion;
+        }
+    }
+    return meilleur;
+}
+
+size_t IndexEcran::getNombreAvions() const { return avions_.size(); }
+
+// Rduction de moiti d'un niveau de la pyramide (moyenne de chaque bloc 2x2, bord impair rpt)
+static sf::Image reduireMoitie(const sf::Image& source) {
+    sf::Vector2u taille = source.getSize();
+    sf::Vector2u reduite((taille.x + 1) / 2, (taille.y + 1) / 2);
+    const std::uint8_t* pixels = source.getPixelsPtr();
+    std::vector<std::uint8_t> resultat(static_cast<size_t>(reduite.x) * reduite.y * 4);
+    for (unsigned int y = 0; y < reduite.y; ++y) {
+        unsigned int y0 = 2 * y, y1 = std::min(2 * y + 1, taille.y - 1);
+        for (unsigned int x = 0; x < reduite.x; ++x) {
+            unsigned int x0 = 2 * x, x1 = std::min(2 * x + 1, taille.x - 1);
+            for (unsigned int c = 0; c < 4; ++c) {
+                unsigned int somme = pixels[(static_cast<size_t>(y0) * taille.x + x0) * 4 + c] + pixels[(static_cast<size_t>(y0) * taille.x + x1) * 4 + c]
+                                   + pixels[(static_cast<size_t>(y1) * taille.x + x0) * 4 + c] + pixels[(static_cast<size_t>(y1) * taille.x + x1) * 4 + c];
+                resultat[(static_cast<size_t>(y) * reduite.x + x) * 4 + c] = static_cast<std::uint8_t>((somme + 2) / 4);
+            }
+        }
+    }
+    sf::Image image;
+    image.resize(reduite, resultat.data());
+    return image;
+}
+
+CarteTuiles::CarteTuiles(const std::filesystem::path& dossier, size_t budget)
+    : dossier_(dossier), largeur_(0), hauteur_(0), tailleTuile_(0), niveaux_(0), budget_(budget), octets_(0), image_(0), arret_(false) {
+    std::ifstream index(dossier_ / "pyramide.txt");
+    if (!(index >> largeur_ >> hauteur_ >> tailleTuile_ >> niveaux_) || largeur_ == 0 || hauteur_ == 0 || tailleTuile_ == 0 || niveaux_ == 0) {
+        throw std::runtime_error("Index de pyramide invalide dans " + dossier_.string());
+    }
+
+    // Sommet charg tout de suite : il y a toujours un fond  dessiner, mme avant le premier chargement
+    sf::Image sommet;
+    if (!sommet.loadFromFile(chemin(cle(niveaux_ - 1, 0, 0)))) throw std::runtime_error("Tuile du sommet illisible dans " + dossier_.string());
+    ajouter(cle(niveaux_ - 1, 0, 0), sommet);
+
+    chargeur_ = std::thread(&CarteTuiles::charger, this);
+}
+
+CarteTuiles::~CarteTuiles() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        arret_ = true;
+    }
+    disponible_.notify_all();
+    if (chargeur_.joinable()) chargeur_.join();
+}
+
+bool CarteTuiles::estAJour(const std::filesystem::path& source, const std::filesystem::path& dossier) {
+    std::error_code erreur;
+    auto index = std::filesystem::last_write_time(dossier / "pyramide.txt", erreur);
+    if (erreur) return false;
+    auto image = std::filesystem::last_write_time(source, erreur);
+    return !erreur && index >= image;
+}
+
+void CarteTuiles::generer(const std::filesystem::path& source, const std::filesystem::path& dossier, unsigned int tailleTuile) {
+    if (tailleTuile == 0) throw std::invalid_argument("Taille de tuile nulle");
+    sf::Image niveau;
+    if (!niveau.loadFromFile(source)) throw std::runtime_error("Carte illisible : " + source.string());
+    sf::Vector2u taille = niveau.getSize();
+
+    // Un niveau en mmoire  la fois (plus le suivant pendant la rduction)
+    unsigned int niveaux = 0;
+    while (true) {
+        std::filesystem::path dossierNiveau = dossier / std::to_string(niveaux);
+        std::filesystem::create_directories(dossierNiveau);
+        sf::Vector2u t = niveau.getSize();
+        for (unsigned int y = 0; y < t.y; y += tailleTuile) {
+            for (unsigned int x = 0; x < t.x; x += tailleTuile) {
+                sf::Vector2u dimensions(std::min(tailleTuile, t.x - x), std::min(tailleTuile, t.y - y));
+                sf::Image tuile(dimensions);
+                if (!tuile.copy(niveau, { 0, 0 }, sf::IntRect(sf::Vector2i(x, y), sf::Vector2i(dimensions)))) throw std::runtime_error("Decoupage de la carte impossible");
+                std::filesystem::path fichier = dossierNiveau / (std::to_string(x / tailleTuile) + "_" + std::to_string(y / tailleTuile) + ".png");
+                if (!tuile.saveToFile(fichier)) throw std::runtime_error("Ecriture impossible : " + fichier.string());
+            }
+        }
+        ++niveaux;
+        if (t.x <= tailleTuile && t.y <= tailleTuile) break;
+        niveau = reduireMoitie(niveau);
+    }
+
+    // Index crit en dernier : une gnration interrompue est refaite au lancement suivant
+    std::ofstream index(dossier / "pyramide.txt", std::ios::trunc);
+    index << taille.x << " " << taille.y << " " << tailleTuile << " " << niveaux << "\n";
+    if (!index) throw std::runtime_error("Ecriture impossible : " + (dossier / "pyramide.txt").string());
+}
+
+std::uint64_t CarteTuiles::cle(unsigned int niveau, unsigned int x, unsigned int y) {
+    return (static_cast<std::uint64_t>(niveau) << 48) | (static_cast<std::uint64_t>(y) << 24) | x;
+}
+
+std::filesystem::path CarteTuiles::chemin(std::uint64_t c) const {
+    unsigned int niveau = static_cast<unsigned int>(c >> 48);
+    unsigned int y = static_cast<unsigned int>((c >> 24) & 0xFFFFFF), x = static_cast<unsigned int>(c & 0xFFFFFF);
+    return dossier_ / std::to_string(niveau) / (std::to_string(x) + "_" + std::to_string(y) + ".png");
+}
+
+sf::Vector2u CarteTuiles::tuilesNiveau(unsigned int niveau) const {
+    // Dimensions du niveau : ceil(source / 2^niveau), comme les rductions successives de generer
+    unsigned int largeur = ((largeur_ - 1) >> niveau) + 1, hauteur = ((hauteur_ - 1) >> niveau) + 1;
+    return { (largeur + tailleTuile_ - 1) / tailleTuile_, (hauteur + tailleTuile_ - 1) / tailleTuile_ };
+}
+
+const CarteTuiles::Tuile* CarteTuiles::utiliser(std::uint64_t c) {
+    auto it = tuiles_.find(c);
+    if (it == tuiles_.end()) return nullptr;
+    Tuile& tuile = it->second;
+    tuile.image = image_;
+    lru_.splice(lru_.begin(), lru_, tuile.lru);
+    return &tuile;
+}
+
+void CarteTuiles::ajouter(std::uint64_t c, const sf::Image& image) {
+    if (tuiles_.count(c)) return; // Dcode deux fois (redemande pendant son chargement)
+    Tuile& tuile = tuiles_[c];
+    if (!tuile.texture.loadFromImage(image)) {
+        tuiles_.erase(c);
+        return;
+    }
+    tuile.texture.setSmooth(true);
+    tuile.octets = static_cast<size_t>(image.getSize().x) * image.getSize().y * 4;
+    tuile.image = image_;
+    lru_.push_front(c);
+    tuile.lru = lru_.begin();
+    bool sommet = (c >> 48) == niveaux_ - 1;
+    if (!sommet) octets_ += tuile.octets;
+
+    // Eviction par la fin de la liste ; les tuiles de l'image en cours et le sommet restent
+    while (octets_ > budget_ && !lru_.empty()) {
+        std::uint64_t ancienne = lru_.back();
+        auto it = tuiles_.find(ancienne);
+        if (it->second.image == image_) break;
+        lru_.pop_back();
+        if ((ancienne >> 48) == niveaux_ - 1) {
+            lru_.push_front(ancienne);
+            it->second.lru = lru_.begin();
+            continue;
+        }
+        octets_ -= it->second.octets;
+        tuiles_.erase(it);
+    }
+}
+
+void CarteTuiles::dessinerTuile(sf::RenderTarget& cible, std::uint64_t c, const Tuile& tuile) const {
+    unsigned int niveau = static_cast<unsigned int>(c >> 48);
+    unsigned int y = static_cast<unsigned int>((c >> 24) & 0xFFFFFF), x = static_cast<unsigned int>(c & 0xFFFFFF);
+    float echelleX = static_cast<float>(1u << niveau) * static_cast<float>(LARGEUR) / static_cast<float>(largeur_);
+    float echelleY = static_cast<float>(1u << niveau) * static_cast<float>(HAUTEUR) / static_cast<float>(hauteur_);
+    sf::Sprite sprite(tuile.texture);
+    sprite.setScale({ echelleX, echelleY });
+    sprite.setPosition({ static_cast<float>(x * tailleTuile_) * echelleX, static_cast<float>(y * tailleTuile_) * echelleY });
+    cible.draw(sprite);
+}
+
+void CarteTuiles::dessiner(sf::RenderTarget& cible) {
+    ++image_;
+
+    // Tuiles dcodes depuis l'image prcdente : quelques envois par image au plus, pour ne pas la ralentir
+    std::vector<std::pair<std::uint64_t, sf::Image>> chargees;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t nombre = std::min(chargees_.size(), ENVOIS_TUILES_PAR_IMAGE);
+        chargees.assign(std::make_move_iterator(chargees_.begin()), std::make_move_iterator(chargees_.begin() + nombre));
+        chargees_.erase(chargees_.begin(), chargees_.begin() + nombre);
+    }
+    for (const auto& [c, image] : chargees) ajouter(c, image);
+
+    // Niveau : environ un pixel source par pixel cran
+    const sf::View& vue = cible.getView();
+    double sourceParPixel = static_cast<double>(vue.getSize().x) / cible.getSize().x * largeur_ / LARGEUR;
+    unsigned int niveau = 0;
+    while (niveau + 1 < niveaux_ && sourceParPixel >= 2.0) {
+        sourceParPixel /= 2.0;
+        ++niveau;
+    }
+
+    // Tuiles du niveau qui recoupent la vue
+    sf::Vector2f coin = vue.getCenter() - vue.getSize() / 2.f;
+    double pixelsX = static_cast<double>(largeur_) / LARGEUR / (1u << niveau) / tailleTuile_; // Tuiles par unit de la vue
+    double pixelsY = static_cast<double>(hauteur_) / HAUTEUR / (1u << niveau) / tailleTuile_;
+    sf::Vector2u nombre = tuilesNiveau(niveau);
+    auto borne = [](double v, unsigned int n) { return static_cast<unsigned int>(std::clamp(v, 0.0, static_cast<double>(n - 1))); };
+    unsigned int x0 = borne(std::floor(coin.x * pixelsX), nombre.x), x1 = borne(std::floor((coin.x + vue.getSize().x) * pixelsX), nombre.x);
+    unsigned int y0 = borne(std::floor(coin.y * pixelsY), nombre.y), y1 = borne(std::floor((coin.y + vue.getSize().y) * pixelsY), nombre.y);
+
+    // Secours d'abord (parente la plus proche en cache, une fois chacune), puis les tuiles prsentes par-dessus
+    manquantes_.clear();
+    secours_.clear();
+    for (unsigned int y = y0; y <= y1; ++y) {
+        for (unsigned int x = x0; x <= x1; ++x) {
+            if (utiliser(cle(niveau, x, y))) continue;
+            manquantes_.push_back(cle(niveau, x, y));
+            for (unsigned int n = niveau + 1, px = x / 2, py = y / 2; n < niveaux_; ++n, px /= 2, py /= 2) {
+                if (!utiliser(cle(n, px, py))) continue;
+                if (std::find(secours_.begin(), secours_.end(), cle(n, px, py)) == secours_.end()) secours_.push_back(cle(n, px, py));
+                break;
+            }
+        }
+    }
+    std::sort(secours_.begin(), secours_.end(), std::greater<std::uint64_t>()); // Les plus grossires dessous
+    for (std::uint64_t c : secours_) dessinerTuile(cible, c, tuiles_.at(c));
+    for (unsigned int y = y0; y <= y1; ++y) {
+        for (unsigned int x = x0; x <= x1; ++x) {
+            auto it = tuiles_.find(cle(niveau, x, y));
+            if (it != tuiles_.end()) dessinerTuile(cible, it->first, it->second);
+        }
+    }
+
+    // Les demandes prcdentes sont remplaces : seule la vue courante compte. Le centre de la vue est charg en premier.
+    sf::Vector2f centre = vue.getCenter();
+    std::sort(manquantes_.begin(), manquantes_.end(), [&](std::uint64_t a, std::uint64_t b) {
+        auto distance = [&](std::uint64_t c) {
+            double dx = ((c & 0xFFFFFF) + 0.5) / pixelsX - centre.x, dy = (((c >> 24) & 0xFFFFFF) + 0.5) / pixelsY - centre.y;
+            return dx * dx + dy * dy;
+        };
+        return distance(a) > distance(b);
+    });
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        demandes_.swap(manquantes_);
+    }
+    if (!demandes_.empty()) disponible_.notify_one();
+}
+
+void CarteTuiles::charger() {
+    std::vector<std::uint64_t> echecs; // Tuiles illisibles, plus redemandes
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        disponible_.wait(lock, [this]() { return arret_ || !demandes_.empty(); });
+        if (arret_) return;
+        std::uint64_t c = demandes_.back();
+        demandes_.pop_back();
+        bool dejaChargee = std::any_of(chargees_.begin(), chargees_.end(), [c](const auto& t) { return t.first == c; });
+        if (dejaChargee || std::find(echecs.begin(), echecs.end(), c) != echecs.end()) continue;
+
+        // Dcodage hors du verrou : l'affichage peut remplacer les demandes pendant ce temps
+        lock.unlock();
+        sf::Image image;
+        bool lue = image.loadFromFile(chemin(c));
+        lock.lock();
+        if (lue) chargees_.emplace_back(c, std::move(image));
+        else {
+            echecs.push_back(c);
+            std::cerr << "[CARTE] Tuile illisible " << chemin(c).string() << "\n";
+        }
+    }
+}
+
+size_t CarteTuiles::getOctets() const { return octets_; }
+size_t CarteTuiles::getNombreTuiles() const { return tuiles_.size(); }
+
+EnregistreurImages::EnregistreurImages(const std::filesystem::path& dossier, FormatEnregistrement format, unsigned int threads, size_t capacite)
+    : dossier_(dossier), format_(format), capacite_(std::max<size_t>(capacite, 1)), arret_(false),
+    acceptees_(0), ecrites_(0), abandonnees_(0), echecs_(0) {
+    std::filesystem::create_directories(dossier_);
+    if (format_ == FormatEnregistrement::BRUT) {
+        video_.open(dossier_ / "video.rgba", std::ios::binary | std::ios::trunc);
+        if (!video_.is_open()) throw std::runtime_error("Impossible de creer " + (dossier_ / "video.rgba").string());
+    }
+    for (unsigned int i = 0; i < std::max(threads, 1u); ++i) threads_.emplace_back(&EnregistreurImages::encoder, this);
+}
+
+EnregistreurImages::~EnregistreurImages() { terminer(); }
+
+void EnregistreurImages::terminer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        arret_ = true;
+    }
+    disponible_.notify_all();
+    for (auto& t : threads_) t.join();
+    threads_.clear();
+}
+
+bool EnregistreurImages::soumettre(const sf::Texture& image) {
+    {
+        // Seul le thread du rendu ajoute des captures : la place libre constate ne peut que grandir d'ici l'ajout
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_.size() >= capacite_) {
+            ++abandonnees_;
+            return false;
+        }
+    }
+    Capture capture{ acceptees_++, sf::Texture(image) }; // Copie sur le GPU, sans relecture des pixels
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_.push_back(std::move(capture));
+    }
+    disponible_.notify_one();
+    return true;
+}
+
+void EnregistreurImages::encoder() {
+    PORTEE_ALLOCATIONS("Encodage");
+    sf::Context contexte; // Contexte partag avec celui du rendu : la texture copie y est lisible
+    while (true) {
+        std::optional<Capture> capture;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            disponible_.wait(lock, [this]() { return arret_ || !file_.empty(); });
+            if (file_.empty()) return; // Arrt demand et file vide
+            capture.emplace(std::move(file_.front()));
+            file_.pop_front();
+        }
+
+        sf::Image image = capture->texture.copyToImage();
+        bool ecrite = false;
+        if (format_ == FormatEnregistrement::PNG) {
+            char nom[32];
+            std::snprintf(nom, sizeof(nom), "image_%06zu.png", capture->numero);
+            ecrite = image.saveToFile(dossier_ / nom);
+        }
+        else {
+            std::streamsize taille = static_cast<std::streamsize>(image.getSize().x) * image.getSize().y * 4;
+            std::lock_guard<std::mutex> lock(mutexVideo_);
+            video_.seekp(static_cast<std::streamoff>(capture->numero) * taille);
+            video_.write(reinterpret_cast<const char*>(image.getPixelsPtr()), taille);
+            video_.flush();
+            ecrite = video_.good();
+            video_.clear();
+        }
+        if (ecrite) ++ecrites_;
+        else ++echecs_;
+    }
+}
+
+size_t EnregistreurImages::getEcrites() const { return ecrites_; }
+size_t EnregistreurImages::getAbandonnees() const { return abandonnees_; }
+size_t EnregistreurImages::getEchecs() const { return echecs_; }
\ No newline at end of file
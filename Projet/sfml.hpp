@@ -1,6 +1,11 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include "avion.hpp"
+#include <cstdint>
+#include <array>
+#include <deque>
+#include <list>
+#include <filesystem>
 
 // Constantes
 extern const unsigned int LARGEUR; // Largeur de la fentre
@@ -8,13 +13,209 @@ extern const unsigned int HAUTEUR; // Hauteur de la fen
 extern float ECHELLE; // Facteur d'chelle pour convertir les km en pixels
 extern float DECALAGE_GAUCHE; // Dcalage horizontal pour centrer la carte
 extern float DECALAGE_DROITE; // Dcalage vertical pour centrer la carte
+extern const size_t SEUIL_AVIONS_DENSITE; // Nombre d'avions visibles  partir duquel la carte de densit remplace les sprites
+extern const float ZOOM_MIN_DENSITE; // Niveau de zoom en dessous duquel les avions sont toujours dessins un par un
+extern const std::array<double, 7> FACTEURS_TEMPS; // Compressions du temps proposes au clavier (+ et -)
+
+enum class ModeDensite { // Affichage de la carte de densit (touche H)
+    AUTOMATIQUE, // Selon le nombre d'avions visibles et le zoom
+    TOUJOURS,
+    JAMAIS
+};
+
+struct AvionEcran { // Avion vu par l'affichage pendant une image
+    Avion* avion;
+    InstantaneAvion etat;
+    sf::Vector2f ecran; // Position convertie en coordonnes de la vue nationale
+};
+
+// Index spatial reconstruit  chaque image : grille uniforme sur l'cran, avions tris par cellule (tri par comptage).
+// Sert au clic (avion le plus proche) et  ne dessiner que les avions dans la vue courante.
+class IndexEcran {
+private:
+    unsigned int colonnes_, lignes_;
+    float tailleCellule_;
+    std::vector<AvionEcran> avions_; // Tris par cellule
+    std::vector<size_t> debutCellule_; // Indice du premier avion de chaque cellule dans avions_ (+ une sentinelle)
+    std::vector<AvionEcran> tampon_; // Rutilis  chaque reconstruction
+    std::vector<size_t> cellules_;
+
+    unsigned int colonne(float x) const; // Borne  la grille (les avions hors cran vont dans les cellules du bord)
+    unsigned int ligne(float y) const;
+
+public:
+    IndexEcran(float tailleCellule);
+    void construire(const std::vector<Avion*>& flotte, std::chrono::steady_clock::time_point instant); // Un instantan par avion, position interpole  l'instant simul donn ; les avions termins sont ignors
+    void rechercher(sf::FloatRect zone, std::vector<const AvionEcran*>& resultat) const; // Avions dont la position est dans la zone
+    Avion* choisir(sf::Vector2f point, float rayon) const; // Avion le plus proche du point dans le rayon, sinon nullptr
+    size_t getNombreAvions() const; // Avions indexs
+};
+
+enum class ModeTraces { // Traces des positions passes (touche T)
+    SELECTION, // Avion slectionn uniquement
+    TOUTES,
+    AUCUNE
+};
+
+// Traces des avions : pour chaque avion, tampon circulaire de ses dernires positions chantillonnes.
+// Tous les tampons sont dans une seule arne alloue au dmarrage : la mmoire ne dpend pas de la dure de simulation.
+class TracesAvions {
+private:
+    size_t capacite_; // Points par avion
+    std::chrono::milliseconds intervalle_; // Entre deux chantillons
+    std::vector<Position> points_; // Arne : capacite_ points conscutifs par avion, dans l'ordre de la flotte
+    std::vector<size_t> prochain_; // Par avion : case du prochain chantillon dans son tampon
+    std::vector<size_t> nombre_; // Par avion : chantillons prsents (au plus capacite_)
+    std::chrono::steady_clock::time_point dernierEchantillon_;
+    sf::VertexArray sommets_; // Rutilis d'une image  l'autre
+
+    void ajouterTrace(size_t emplacement, Position actuelle); // Ajoute la trace d'un avion  sommets_
+
+public:
+    TracesAvions(size_t maxAvions, size_t pointsParAvion, std::chrono::milliseconds intervalle);
+    void echantillonner(const std::vector<Avion*>& flotte); // Enregistre la position de chaque avion, au plus une fois par intervalle
+    void dessiner(sf::RenderTarget& cible, const std::vector<Avion*>& flotte, const Avion* seul); // Une seule ligne brise pour toutes les traces (seul : uniquement cet avion)
+};
+
+// Carte de densit du trafic en vue nationale : nombre d'avions par cellule d'cran, une texture d'un pixel par cellule.
+// Mise  jour incrmentale : seules les cellules quittes ou rejointes par un avion depuis le tick prcdent sont recolores.
+class CarteDensite {
+private:
+    unsigned int colonnes_, lignes_;
+    float tailleCellule_; // Ct d'une cellule en pixels cran
+    std::vector<unsigned int> comptes_;
+    std::vector<int> celluleAvion_; // Cellule de chaque avion de la flotte au tick prcdent (la flotte ne fait que grandir)
+    std::vector<std::uint8_t> pixels_; // RGBA, un pixel par cellule
+    size_t avionsVisibles_;
+    bool modifiee_; // Pixels  renvoyer  la texture
+    sf::Texture texture_;
+
+    int trouverCellule(sf::Vector2f ecran) const; // -1 hors de la carte
+    void colorerCellule(int cellule); // Couleur selon le nombre d'avions
+
+public:
+    CarteDensite(float tailleCellule);
+    void mettreAJour(const std::vector<Avion*>& flotte); // Dplace chaque avion de son ancienne cellule vers la nouvelle
+    size_t getAvionsVisibles() const; // Avions en vol ou au sol sur la carte au dernier tick
+    void dessiner(sf::RenderTarget& cible); // Affiche la couche (vue nationale)
+};
+
+// Indicateurs d'exploitation en surimpression (touche I) : un relev des indicateurs tenus  jour par la simulation par image,
+// cot proportionnel au nombre d'aroports et indpendant de la taille de la flotte
+class TableauBord {
+private:
+    std::vector<IndicateursAeroport> aeroports_; // Rutilis  chaque relev
+    std::array<long long, Indicateurs::NOMBRE_ETATS> etats_;
+
+public:
+    TableauBord();
+    void mettreAJour(const Indicateurs& indicateurs, std::chrono::steady_clock::time_point instant); // Relev  l'instant simul
+    void dessiner(sf::RenderTarget& cible, const std::vector<Aeroport*>& aeroports, const sf::Font& police) const; // Affiche le panneau (vue par dfaut)
+};
+
+// Fond de carte en pyramide de tuiles : niveau 0  la rsolution de l'image source, chaque niveau suivant deux fois plus petit,
+// jusqu' une seule tuile. Le niveau dessin suit le zoom ; les tuiles sont dcodes par un thread ddi et gardes en textures
+// dans un cache LRU de taille borne. Une tuile pas encore charge est remplace par la plus proche de ses parentes en cache.
+// La carte couvre la vue par dfaut (0, 0, LARGEUR, HAUTEUR), comme l'ancienne image de fond tire.
+class CarteTuiles {
+private:
+    struct Tuile {
+        sf::Texture texture;
+        size_t octets;
+        std::list<std::uint64_t>::iterator lru;
+        unsigned long long image; // Dernire image o la tuile a servi
+    };
+
+    std::filesystem::path dossier_;
+    unsigned int largeur_, hauteur_; // Image source (px)
+    unsigned int tailleTuile_;
+    unsigned int niveaux_;
+    size_t budget_; // Octets de texture au plus (hors tuile du sommet, toujours garde)
+    size_t octets_;
+    std::unordered_map<std::uint64_t, Tuile> tuiles_;
+    std::list<std::uint64_t> lru_; // Plus rcemment utilises en tte
+    unsigned long long image_; // Numro de l'image en cours de dessin
+    std::vector<std::uint64_t> manquantes_; // Rutiliss  chaque image
+    std::vector<std::uint64_t> secours_;
+
+    std::mutex mutex_; // Protge demandes_, chargees_ et arret_
+    std::condition_variable disponible_;
+    std::vector<std::uint64_t> demandes_; // Tuiles manquantes de la dernire image, la plus prioritaire en dernier
+    std::vector<std::pair<std::uint64_t, sf::Image>> chargees_; // Dcodes, en attente d'envoi  la carte graphique
+    bool arret_;
+    std::thread chargeur_;
+
+    static std::uint64_t cle(unsigned int niveau, unsigned int x, unsigned int y);
+    std::filesystem::path chemin(std::uint64_t cle) const;
+    sf::Vector2u tuilesNiveau(unsigned int niveau) const; // Nombre de tuiles en largeur et en hauteur
+    const Tuile* utiliser(std::uint64_t cle); // Tuile en cache marque utilise, sinon nullptr
+    void ajouter(std::uint64_t cle, const sf::Image& image); // Envoi  la carte graphique puis viction des moins rcemment utilises
+    void dessinerTuile(sf::RenderTarget& cible, std::uint64_t cle, const Tuile& tuile) const;
+    void charger(); // Boucle du thread de dcodage
+
+public:
+    CarteTuiles(const std::filesystem::path& dossier, size_t budget); // Lit l'index de la pyramide et charge la tuile du sommet
+    ~CarteTuiles(); // Arrte le thread de dcodage
+    CarteTuiles(const CarteTuiles&) = delete;
+    void operator=(const CarteTuiles&) = delete;
+
+    static bool estAJour(const std::filesystem::path& source, const std::filesystem::path& dossier); // Pyramide prsente et plus rcente que l'image
+    static void generer(const std::filesystem::path& source, const std::filesystem::path& dossier, unsigned int tailleTuile); // Dcoupe l'image (une seule fois)
+
+    void dessiner(sf::RenderTarget& cible); // Tuiles de la vue courante de la cible au niveau adapt au zoom, demande les manquantes
+    size_t getOctets() const; // Textures en cache
+    size_t getNombreTuiles() const;
+};
+
+enum class FormatEnregistrement { // Sortie de l'enregistrement hors cran
+    PNG, // Une image PNG numrote par capture
+    BRUT // Un seul fichier video.rgba, images RGBA conscutives (lisible par ffmpeg -f rawvideo -pix_fmt rgba)
+};
+
+// Enregistrement des images rendues hors cran (sf::RenderTexture). Le thread d'affichage ne fait qu'une copie de texture
+// sur le GPU ; la relecture des pixels et l'encodage se font dans des threads ddis, chacun avec son contexte OpenGL.
+// File borne : si l'encodage prend du retard, les nouvelles images sont abandonnes plutt que de bloquer l'affichage.
+class EnregistreurImages {
+private:
+    struct Capture {
+        size_t numero; // Rang parmi les images acceptes : nom du PNG ou place dans la vido
+        sf::Texture texture;
+    };
+
+    std::filesystem::path dossier_;
+    FormatEnregistrement format_;
+    size_t capacite_;
+    std::deque<Capture> file_;
+    std::mutex mutex_; // Protge file_ et arret_
+    std::condition_variable disponible_;
+    bool arret_;
+    std::vector<std::thread> threads_;
+    std::ofstream video_; // Format BRUT : chaque image crite  sa place, quel que soit le thread qui la termine
+    std::mutex mutexVideo_;
+    size_t acceptees_; // Thread d'affichage uniquement
+    std::atomic<size_t> ecrites_, abandonnees_, echecs_;
+
+    void encoder(); // Boucle d'un thread : relecture puis criture des captures de la file
+
+public:
+    EnregistreurImages(const std::filesystem::path& dossier, FormatEnregistrement format, unsigned int threads, size_t capacite);
+    ~EnregistreurImages(); // Appelle terminer
+    EnregistreurImages(const EnregistreurImages&) = delete;
+    void operator=(const EnregistreurImages&) = delete;
+
+    bool soumettre(const sf::Texture& image); // Copie l'image pour l'encodage (thread du rendu) ; false si la file est pleine
+    void terminer(); // Encode les captures en file puis arrte les threads (sans effet si dj fait)
+    size_t getEcrites() const; // Images crites sur disque
+    size_t getAbandonnees() const; // Images refuses, file pleine
+    size_t getEchecs() const; // Images dont l'criture a chou
+};
 
 // Fonctions utilitaires
 sf::Vector2f conversion(Position pos); // Pour convertir en 2d
-void adapterFondFenetre(sf::Sprite& sprite, const sf::Texture& texture); // Redimensionne l'image de fond
 
 // Fonctions de dessin
-void dessinerAeroports(sf::RenderWindow& window, const std::vector<Aeroport*>& aeroports, const sf::Font& police, bool Police); // Affiche les aroports sur la carte globale
-void dessinerDetailsAeroport(sf::RenderWindow& window, Aeroport* aero, const sf::Font& police, bool Police, float zoom); // Affiche les dtails (piste, parkings) en vue zoome
-void dessinerAvion(sf::RenderWindow& window, Avion* avion, const sf::Texture& texture, bool hasTexture, const sf::Font& police, bool Police, float zoom, Avion* selection, Aeroport* vue); // Affiche un avion (sprite ou point)
-void dessinerInfo(sf::RenderWindow& window, Avion* avion, const sf::Font& police, float zoom); // Affiche les infos de l'avion slectionn
\ No newline at end of file
+sf::VertexArray construireVoiesAeriennes(const ReseauAerien& reseau); // Segments du rseau arien (construits une fois, le rseau ne change plus)
+void dessinerAeroports(sf::RenderTarget& cible, const std::vector<Aeroport*>& aeroports, const sf::Font& police, bool Police); // Affiche les aroports sur la carte globale
+void dessinerDetailsAeroport(sf::RenderTarget& cible, Aeroport* aero, const sf::Font& police, bool Police, float zoom); // Affiche les dtails (piste, parkings) en vue zoome
+void dessinerAvion(sf::RenderTarget& cible, Avion* avion, const InstantaneAvion& etat, const sf::Texture& texture, bool hasTexture, const sf::Font& police, bool Police, float zoom, Avion* selection, Aeroport* vue); // Affiche un avion (sprite ou point)
+void dessinerInfo(sf::RenderTarget& cible, Avion* avion, const InstantaneAvion& etat, const sf::Font& police, float zoom); // Affiche les infos de l'avion slectionn
\ No newline at end of file
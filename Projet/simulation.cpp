@@ -0,0 +1,546 @@
+#include "thread.hpp"
+#include "telemetrie.hpp"
+#include "trajectoires.hpp"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+#include <cmath>
+#include <cctype>
+#include <limits>
+#include <iterator>
+
+const double MARGE_VENT = 100000.0; // Marge du vent généré autour des zones de contrôle (m)
+const std::chrono::milliseconds PERIODE_TRAFIC(100); // Intervalle simulé entre deux lots de départs
+const std::chrono::seconds FENETRE_INDICATEURS(600); // Fenêtre glissante des indicateurs en direct (temps simulé)
+const size_t TRANCHES_INDICATEURS = 60; // Tranches de 10 s
+
+// Profil JOURNEE : creux de nuit, pointes du matin et de fin d'après-midi (coefficients ramenés à une moyenne de 1 au chargement)
+const std::array<double, 24> PROFIL_JOURNEE = { 0.1, 0.05, 0.05, 0.05, 0.1, 0.3, 0.9, 1.7, 1.9, 1.6, 1.3, 1.2,
+                                                1.2, 1.2, 1.1, 1.2, 1.5, 1.8, 1.9, 1.6, 1.2, 0.8, 0.5, 0.25 };
+
+Simulation::Simulation(const std::string& scenario, unsigned int graine)
+    : dureeJournee_(86400), limiteGeneres_(10000), generes_(0), arret_(), aleatoire_(graine), debut_(), demarree_(false) {
+    try {
+        chargerScenario(scenario);
+    }
+    catch (...) {
+        liberer();
+        throw;
+    }
+}
+
+Simulation::~Simulation() {
+    arreter();
+    liberer();
+}
+
+void Simulation::liberer() {
+    // Chaque avion appartient à une seule liste (scénario, sauvegarde ou générés), la flotte ne fait que les référencer
+    for (const auto& depart : programme_) delete depart.avion;
+    for (Avion* avion : avionsRestaures_) delete avion;
+    for (Avion* avion : avionsGeneres_) delete avion;
+    flotte_.clear();
+    programme_.clear();
+    avionsRestaures_.clear();
+    avionsGeneres_.clear();
+    for (auto aero : aeroports_) { delete aero->twr; delete aero->app; delete aero; }
+    aeroports_.clear();
+}
+
+void Simulation::chargerScenario(const std::string& chemin) {
+    // Lecture du fichier avec les infos de départ
+    std::ifstream fichier(chemin);
+    if (!fichier.is_open()) throw std::runtime_error("Fichier " + chemin + " pas trouve");
+
+    std::string ligne, section;
+    std::vector<Aeroport*> pistesChargees; // Aéroports dont les pistes viennent du scénario
+    float vitesseVentGenere = -1.f; // Vent généré une fois les aéroports connus (il couvre leur zone)
+    unsigned int graineVent = 0;
+    while (std::getline(fichier, ligne)) {
+        if (ligne.empty() || ligne[0] == '#') continue;
+        if (ligne.back() == '\r') ligne.pop_back();
+        if (ligne == "[AEROPORTS]") { section = "AEROPORTS"; continue; }
+        if (ligne == "[AVIONS]") { section = "AVIONS"; continue; }
+        if (ligne == "[PISTES]") { section = "PISTES"; continue; }
+        if (ligne == "[ROULAGE]") { section = "ROULAGE"; continue; }
+        if (ligne == "[BALISES]") { section = "BALISES"; continue; }
+        if (ligne == "[VOIES_AERIENNES]") { section = "VOIES_AERIENNES"; continue; }
+        if (ligne == "[VENT]") { section = "VENT"; continue; }
+        if (ligne == "[TRAFIC]") { section = "TRAFIC"; continue; }
+
+        std::stringstream ss(ligne);
+        if (section == "AEROPORTS") {
+            // Chargement des aéroports
+            std::string nom; double x, y; float r;
+            int maxDeparts = 0; // Optionnel : avions en roulage ou au point d'attente par piste
+            ss >> nom >> x >> y >> r >> maxDeparts;
+            if (!nom.empty()) {
+                aeroports_.push_back(new Aeroport(nom, Position(x, y, 0), r));
+                ccr_.getReseau().ajouterBalise(nom, Position(x, y, 0)); // Extrémité possible des voies aériennes
+                if (maxDeparts > 0) aeroports_.back()->twr->setMaxDepartsEnCours(static_cast<size_t>(maxDeparts));
+            }
+        }
+        else if (section == "AVIONS") {
+            // Chargement des avions
+            std::string nom, dep, dest;
+            float v, vs, carb, conso, dur;
+            double heure = -1; // Optionnel : heure de départ (s simulées depuis le démarrage)
+            ss >> nom >> v >> vs >> carb >> conso >> dur >> dep >> dest;
+            if (!(ss >> heure)) heure = -1;
+
+            Aeroport* d = trouverAeroport(dep);
+            Aeroport* a = trouverAeroport(dest);
+            if (d && a) {
+                Position p = d->position;
+                p.setPosition(p.getX(), p.getY() - 5000, 10000); // Position initiale décalée
+                Avion* av = new Avion(nom, v, vs, carb, conso, dur, p);
+                av->setDestination(a);
+                programme_.push_back({ std::chrono::milliseconds(static_cast<long long>(heure * 1000)), av, d });
+            }
+        }
+        else if (section == "TRAFIC") {
+            // Départs générés : PROFIL Aeroport Taux [CONSTANT|JOURNEE|24 coefficients], MODELE, JOURNEE, LIMITE
+            std::string type;
+            ss >> type;
+            if (type == "PROFIL") {
+                std::string nomAero, forme;
+                double taux = -1;
+                ss >> nomAero >> taux;
+                Aeroport* aero = trouverAeroport(nomAero);
+                if (!aero) throw std::runtime_error("Trafic : aeroport inconnu " + nomAero);
+                if (taux < 0) throw std::runtime_error("Trafic : taux horaire invalide pour " + nomAero);
+                if (aeroports_.size() < 2) throw std::runtime_error("Trafic : au moins deux aeroports sont necessaires");
+
+                ProfilTrafic profil{ aero, taux, {} };
+                profil.heures.fill(1.0);
+                ss >> forme;
+                if (forme == "JOURNEE") profil.heures = PROFIL_JOURNEE;
+                else if (!forme.empty() && forme != "CONSTANT") {
+                    std::stringstream premier(forme);
+                    if (!(premier >> profil.heures[0])) throw std::runtime_error("Trafic : profil inconnu " + forme);
+                    for (size_t h = 1; h < profil.heures.size(); ++h) {
+                        if (!(ss >> profil.heures[h])) throw std::runtime_error("Trafic : 24 coefficients horaires attendus pour " + nomAero);
+                    }
+                }
+                double somme = 0;
+                for (double c : profil.heures) {
+                    if (c < 0) throw std::runtime_error("Trafic : coefficient horaire negatif pour " + nomAero);
+                    somme += c;
+                }
+                if (somme <= 0) throw std::runtime_error("Trafic : profil horaire nul pour " + nomAero);
+                for (double& c : profil.heures) c *= profil.heures.size() / somme;
+                profils_.push_back(profil);
+            }
+            else if (type == "MODELE") {
+                if (!(ss >> modele_.vitesse >> modele_.vitesseSol >> modele_.carburant >> modele_.conso >> modele_.dureeStationnement)) {
+                    throw std::runtime_error("Trafic : MODELE vitesse vitesseSol carburant conso duree attendu");
+                }
+            }
+            else if (type == "JOURNEE") {
+                if (!(ss >> dureeJournee_) || dureeJournee_ <= 0) throw std::runtime_error("Trafic : duree de journee invalide");
+            }
+            else if (type == "LIMITE") {
+                if (!(ss >> limiteGeneres_)) throw std::runtime_error("Trafic : nombre d'avions maximal invalide");
+            }
+            else if (!type.empty()) throw std::runtime_error("Trafic : type inconnu " + type);
+        }
+        else if (section == "PISTES") {
+            // Chargement des pistes (seuil relatif à l'aéroport)
+            std::string nomAero, nom, mode;
+            double dx, dy;
+            float temps = -1.f; // Optionnel : temps d'occupation par défaut de la tour
+            ss >> nomAero >> nom >> dx >> dy >> mode >> temps;
+
+            Aeroport* aero = nullptr;
+            for (auto a : aeroports_) {
+                if (a->nom == nomAero) aero = a;
+            }
+            if (!aero) continue;
+
+            // Les pistes du scénario remplacent la piste par défaut
+            if (std::find(pistesChargees.begin(), pistesChargees.end(), aero) == pistesChargees.end()) {
+                aero->twr->viderPistes();
+                pistesChargees.push_back(aero);
+            }
+
+            ModePiste modePiste = ModePiste::MIXTE;
+            if (mode == "ARRIVEES") modePiste = ModePiste::ARRIVEES;
+            else if (mode == "DEPARTS") modePiste = ModePiste::DEPARTS;
+            else if (mode != "MIXTE") throw std::runtime_error("Mode de piste inconnu : " + mode);
+            aero->twr->ajouterPiste(nom, aero->position + Position(dx, dy, 0), modePiste, temps);
+        }
+        else if (section == "BALISES") {
+            // Chargement des points de report du réseau aérien
+            std::string nom; double x, y;
+            ss >> nom >> x >> y;
+            if (!nom.empty()) ccr_.getReseau().ajouterBalise(nom, Position(x, y, 0));
+        }
+        else if (section == "VOIES_AERIENNES") {
+            // Voies aériennes entre balises ou aéroports
+            std::string a, b;
+            ss >> a >> b;
+            if (!a.empty()) ccr_.getReseau().ajouterSegment(a, b);
+        }
+        else if (section == "VENT") {
+            // Champ de vent : grille d'un fichier (chemin relatif au scénario) ou générée
+            std::string type;
+            ss >> type;
+            if (type == "FICHIER") {
+                std::string nom;
+                ss >> nom;
+                std::filesystem::path fichierVent = std::filesystem::path(chemin).parent_path() / nom;
+                champVent_ = std::make_unique<ChampVent>(ChampVent::charger(fichierVent.string()));
+            }
+            else if (type == "PROCEDURAL") {
+                if (!(ss >> vitesseVentGenere >> graineVent) || vitesseVentGenere < 0) throw std::runtime_error("Vent : PROCEDURAL vitesse graine attendu");
+            }
+            else if (!type.empty()) throw std::runtime_error("Type de vent inconnu : " + type);
+        }
+        else if (section == "ROULAGE") {
+            // Chargement des réseaux de roulage (positions relatives à l'aéroport)
+            std::string nomAero, type;
+            ss >> nomAero >> type;
+
+            Aeroport* aero = nullptr;
+            for (auto a : aeroports_) {
+                if (a->nom == nomAero) aero = a;
+            }
+            if (!aero) continue;
+
+            // Le réseau du scénario remplace les parkings et le réseau par défaut
+            if (!aero->roulagePersonnalise) aero->viderRoulage();
+
+            if (type == "NOEUD") {
+                std::string nom; double dx, dy;
+                ss >> nom >> dx >> dy;
+                aero->roulage.ajouterNoeud(nom, aero->position + Position(dx, dy, 0));
+            }
+            else if (type == "ARC") {
+                std::string a, b;
+                ss >> a >> b;
+                aero->roulage.ajouterArc(a, b);
+            }
+            else if (type == "PARKING") {
+                std::string nom, noeud; double dx, dy;
+                ss >> nom >> dx >> dy >> noeud;
+                aero->parkings.push_back(Parking(nom, aero->position + Position(dx, dy, 0)));
+                aero->roulage.relierParking(noeud);
+            }
+            else if (type == "SORTIE") {
+                std::string noeud, piste;
+                ss >> noeud >> piste; // Piste optionnelle (première piste par défaut)
+                aero->roulage.definirSortiePiste(noeud, piste.empty() ? 0 : aero->twr->getIndexPiste(piste));
+            }
+            else if (type == "ATTENTE") {
+                std::string noeud, piste;
+                ss >> noeud >> piste;
+                aero->roulage.definirPointAttente(noeud, piste.empty() ? 0 : aero->twr->getIndexPiste(piste));
+            }
+        }
+    }
+    fichier.close();
+    if (aeroports_.empty()) throw std::runtime_error("Aucun aeroport charge");
+
+    if (vitesseVentGenere >= 0) {
+        double xMin = 1e12, yMin = 1e12, xMax = -1e12, yMax = -1e12;
+        for (auto aero : aeroports_) {
+            double marge = aero->rayonControle + MARGE_VENT;
+            xMin = std::min(xMin, aero->position.getX() - marge);
+            yMin = std::min(yMin, aero->position.getY() - marge);
+            xMax = std::max(xMax, aero->position.getX() + marge);
+            yMax = std::max(yMax, aero->position.getY() + marge);
+        }
+        champVent_ = std::make_unique<ChampVent>(ChampVent::generer(xMin, yMin, xMax, yMax, vitesseVentGenere, graineVent));
+    }
+
+    // Avions sans heure de départ : écart de 0,5 à 1,5 s avec le précédent, dans l'ordre du fichier
+    std::uniform_int_distribution<> delai(500, 1499);
+    std::chrono::milliseconds cumul(0);
+    for (auto& depart : programme_) {
+        if (depart.instant.count() >= 0) continue;
+        cumul += std::chrono::milliseconds(delai(aleatoire_));
+        depart.instant = cumul;
+    }
+    std::stable_sort(programme_.begin(), programme_.end(), [](const DepartProgramme& a, const DepartProgramme& b) { return a.instant < b.instant; });
+
+    // Précalcul des chemins de roulage une fois les pistes et réseaux du scénario chargés
+    for (auto aero : aeroports_) aero->preparerRoulage();
+}
+
+Aeroport* Simulation::aeroportLePlusProche(const Avion* avion) const {
+    Aeroport* proche = nullptr;
+    double distMin = std::numeric_limits<double>::infinity();
+    for (auto aero : aeroports_) {
+        double d = avion->getPosition().distanceCarre(aero->position);
+        if (d < distMin) { distMin = d; proche = aero; }
+    }
+    return proche;
+}
+
+Aeroport* Simulation::trouverAeroport(const std::string& nom) const {
+    for (auto aero : aeroports_) {
+        if (aero->nom == nom) return aero;
+    }
+    return nullptr;
+}
+
+std::vector<Avion*> Simulation::restaurer(const std::string& chemin) {
+    if (demarree_) throw std::logic_error("Restauration d'une simulation deja demarree");
+    Sauvegarde sauvegarde(ccr_, aeroports_);
+    std::vector<Avion*> avions = sauvegarde.restaurer(chemin);
+
+    // Les avions de la sauvegarde remplacent ceux du scénario
+    for (const auto& depart : programme_) delete depart.avion;
+    programme_.clear();
+    for (Avion* avion : avionsRestaures_) delete avion;
+    avionsRestaures_ = avions;
+    return avions;
+}
+
+void Simulation::lancerAvions(const std::vector<std::pair<Avion*, Aeroport*>>& lot) {
+    {
+        std::lock_guard<std::mutex> lock(mutexFlotte_);
+        flotte_.reserve(flotte_.size() + lot.size());
+        for (const auto& entree : lot) flotte_.push_back(entree.first);
+    }
+
+    // Un thread par avion : routine_avion dort dans ses pauses (sol, croisière analytique), un pool borné demanderait de la
+    // rendre reprenable pas à pas. Les threads sont créés hors du verrou pour ne pas bloquer les lecteurs de la flotte
+    std::vector<std::jthread> threads;
+    threads.reserve(lot.size());
+    for (const auto& [avion, depart] : lot) {
+        if (!depart || !avion->getDestination()) continue; // Affiché mais immobile, comme un avion sans destination du scénario
+        threads.emplace_back(routine_avion, std::ref(*avion), std::ref(*depart), std::ref(*avion->getDestination()), std::ref(ccr_), aeroports_,
+                             std::ref(statistiques_), std::ref(*indicateurs_), static_cast<unsigned int>(aleatoire_()), arret_.get_token());
+    }
+    std::lock_guard<std::mutex> lock(mutexFlotte_);
+    std::move(threads.begin(), threads.end(), std::back_inserter(threadsAvions_));
+}
+
+Avion* Simulation::creerAvionGenere(const ProfilTrafic& profil) {
+    // Destination tirée parmi les autres aéroports
+    std::uniform_int_distribution<size_t> choix(0, aeroports_.size() - 2);
+    Aeroport* destination = aeroports_[choix(aleatoire_)];
+    if (destination == profil.aeroport) destination = aeroports_.back();
+
+    std::string nom = profil.aeroport->nom.substr(0, 3);
+    for (char& c : nom) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    nom += std::to_string(generes_ + 1);
+
+    Position p = profil.aeroport->position;
+    p.setPosition(p.getX(), p.getY() - 5000, 10000); // Même décalage que les avions du scénario
+    Avion* avion = new Avion(nom, modele_.vitesse, modele_.vitesseSol, modele_.carburant, modele_.conso, modele_.dureeStationnement, p);
+    avion->setDestination(destination);
+    avionsGeneres_.push_back(avion);
+    return avion;
+}
+
+void Simulation::genererTrafic() {
+    PORTEE_ALLOCATIONS("Trafic");
+    std::stop_token arret = arret_.get_token();
+    size_t prochain = 0; // Premier départ programmé pas encore lancé
+    auto precedent = debut_;
+    std::vector<std::pair<Avion*, Aeroport*>> lot;
+    while (prochain < programme_.size() || (!profils_.empty() && generes_ < limiteGeneres_)) {
+        if (!Horloge::getHorloge().pause(PERIODE_TRAFIC, arret)) break;
+        auto maintenant = Horloge::getHorloge().maintenant();
+        auto ecoule = std::chrono::duration_cast<std::chrono::milliseconds>(maintenant - debut_);
+        lot.clear();
+
+        // Départs programmés dont l'heure est passée
+        while (prochain < programme_.size() && programme_[prochain].instant <= ecoule) {
+            lot.emplace_back(programme_[prochain].avion, programme_[prochain].depart);
+            ++prochain;
+        }
+
+        // Départs générés : nombre tiré selon une loi de Poisson sur la durée réellement écoulée, au taux de l'heure courante
+        double duree = std::chrono::duration<double>(maintenant - precedent).count();
+        double instantJournee = std::fmod(std::chrono::duration<double>(ecoule).count(), dureeJournee_);
+        size_t heure = std::min<size_t>(static_cast<size_t>(instantJournee / dureeJournee_ * 24), 23);
+        for (const auto& profil : profils_) {
+            double moyenne = profil.tauxHoraire / 3600.0 * profil.heures[heure] * duree;
+            if (moyenne <= 0) continue;
+            long long nombre = std::poisson_distribution<long long>(moyenne)(aleatoire_);
+            for (long long i = 0; i < nombre && generes_ < limiteGeneres_; ++i) {
+                lot.emplace_back(creerAvionGenere(profil), profil.aeroport);
+                ++generes_;
+            }
+        }
+        precedent = maintenant;
+        if (lot.empty()) continue;
+
+        // Une seule prise en charge par le CCR et un seul ajout à la flotte pour tout le lot
+        ccr_.prendreEnCharge(lot);
+        lancerAvions(lot);
+    }
+}
+
+void Simulation::demarrer() {
+    if (demarree_) throw std::logic_error("Simulation deja demarree");
+    demarree_ = true;
+    debut_ = Horloge::getHorloge().maintenant();
+    indicateurs_ = std::make_unique<Indicateurs>(aeroports_, debut_, FENETRE_INDICATEURS, TRANCHES_INDICATEURS);
+    for (auto aero : aeroports_) aero->twr->setIndicateurs(indicateurs_.get(), aero);
+
+    threadsInfra_.emplace_back(routine_ccr, std::ref(ccr_), arret_.get_token());
+    for (auto aero : aeroports_) {
+        threadsInfra_.emplace_back(routine_twr, std::ref(*aero->twr), arret_.get_token());
+        threadsInfra_.emplace_back(routine_app, std::ref(*aero->app), arret_.get_token());
+    }
+
+    // Relevé du vent pour toute la flotte en un seul lot, à chaque pas des avions
+    if (champVent_) {
+        threadsInfra_.emplace_back([this, arret = arret_.get_token()]() {
+            PORTEE_ALLOCATIONS("Vent");
+            std::vector<Position> positions;
+            std::vector<Vent> vents;
+            while (!arret.stop_requested()) {
+                std::vector<Avion*> flotte = getFlotte();
+                positions.clear();
+                for (Avion* avion : flotte) positions.push_back(avion->getPosition());
+                champVent_->echantillonner(positions, Horloge::getHorloge().maintenant(), vents);
+                for (size_t i = 0; i < flotte.size(); ++i) flotte[i]->setVent(vents[i]);
+                simuler_pause(PAS_AVION_MS, arret);
+            }
+        });
+    }
+
+    // Avions restaurés : chacun reprend dans l'état sauvegardé, sans nouvelle prise en charge
+    std::vector<std::pair<Avion*, Aeroport*>> restaures;
+    for (Avion* avion : avionsRestaures_) restaures.emplace_back(avion, aeroportLePlusProche(avion));
+    lancerAvions(restaures);
+
+    threadsInfra_.emplace_back(&Simulation::genererTrafic, this);
+}
+
+void Simulation::sauvegarderPeriodiquement(const std::string& chemin, std::chrono::seconds periode) {
+    if (!demarree_) throw std::logic_error("Sauvegardes d'une simulation non demarree");
+
+    // La capture ne verrouille chaque contrôleur et chaque avion qu'un instant
+    threadsInfra_.emplace_back([this, chemin, periode, arret = arret_.get_token()]() {
+        PORTEE_ALLOCATIONS("Sauvegarde");
+        Sauvegarde sauvegarde(ccr_, aeroports_);
+        auto prochaine = std::chrono::steady_clock::now() + periode;
+        while (attendre_jusqua(prochaine, arret)) {
+            prochaine += periode;
+            try {
+                auto debut = std::chrono::steady_clock::now();
+                std::vector<char> image = sauvegarde.capturer(getFlotte());
+                auto capture = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - debut);
+                sauvegarde.ecrire(chemin, image);
+                Logs::getLogs().log("SAUVEGARDE", "Ecriture", std::to_string(image.size()) + " octets, capture en " + std::to_string(capture.count()) + " ms");
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[SAUVEGARDE] " << e.what() << "\n";
+            }
+        }
+    });
+}
+
+void Simulation::publierTelemetrie(const std::string& nom) {
+    if (!demarree_) throw std::logic_error("Telemetrie d'une simulation non demarree");
+    if (telemetrie_) throw std::logic_error("Telemetrie deja publiee");
+    telemetrie_ = std::make_unique<Telemetrie>(nom, getNombreAvions(), aeroports_.size());
+
+    // Une image par pas des avions ; les lecteurs ne sont jamais attendus
+    threadsInfra_.emplace_back([this, arret = arret_.get_token()]() {
+        PORTEE_ALLOCATIONS("Telemetrie");
+        while (!arret.stop_requested()) {
+            telemetrie_->publier(getFlotte(), aeroports_, Horloge::getHorloge().maintenant() - debut_);
+            simuler_pause(PAS_AVION_MS, arret);
+        }
+    });
+}
+
+void Simulation::archiverTrajectoires(const std::string& chemin, std::chrono::milliseconds periode) {
+    if (!demarree_) throw std::logic_error("Archive des trajectoires d'une simulation non demarree");
+    if (periode.count() <= 0) throw std::invalid_argument("Periode d'archivage invalide");
+    auto archive = std::make_unique<ArchiveTrajectoires>(chemin, static_cast<uint32_t>(periode.count())); // Fichier créé ici : une erreur remonte à l'appelant
+
+    // Une image par période simulée, plus une à l'instant de l'arrêt ; l'index est écrit ensuite
+    threadsInfra_.emplace_back([this, chemin, periode, archive = std::move(archive), arret = arret_.get_token()]() {
+        PORTEE_ALLOCATIONS("Trajectoires");
+        try {
+            do {
+                archive->ajouter(getFlotte(), Horloge::getHorloge().maintenant() - debut_);
+            } while (simuler_pause(static_cast<int>(periode.count()), arret));
+            archive->ajouter(getFlotte(), Horloge::getHorloge().maintenant() - debut_); // L'archive se termine à l'arrêt
+            archive->fermer();
+            Logs::getLogs().log("TRAJECTOIRES", "Archive", std::to_string(archive->getNombreLignes()) + " positions, " + std::to_string(archive->getTaille()) + " octets");
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[TRAJECTOIRES] " << chemin << " : " << e.what() << "\n";
+        }
+    });
+}
+
+void Simulation::rapporterAllocations(std::chrono::seconds periode) {
+    if (!demarree_) throw std::logic_error("Rapport d'allocations d'une simulation non demarree");
+    if (!ProfilAllocations::estActif()) throw std::logic_error("Rapport d'allocations sans le build PROFIL_ALLOCATIONS");
+
+    // Ecarts entre deux relevés, rapportés au nombre de pas des avions simulés pendant la période
+    threadsInfra_.emplace_back([this, periode, arret = arret_.get_token()]() {
+        PORTEE_ALLOCATIONS("Rapport");
+        auto prochaine = std::chrono::steady_clock::now() + periode;
+        auto instant = Horloge::getHorloge().maintenant();
+        std::vector<CompteAllocations> precedent = ProfilAllocations::relever();
+        while (attendre_jusqua(prochaine, arret)) {
+            prochaine += periode;
+            std::vector<CompteAllocations> releve = ProfilAllocations::relever();
+            auto maintenant = Horloge::getHorloge().maintenant();
+            double pas = std::chrono::duration<double, std::milli>(maintenant - instant).count() / PAS_AVION_MS;
+            std::ostringstream rapport;
+            rapport << "[ALLOCATIONS] " << std::fixed << std::setprecision(0) << pas << " pas simules, " << getFlotte().size() << " avions\n";
+            ProfilAllocations::ecrireRapport(rapport, precedent, releve, pas);
+            std::cout << rapport.str();
+            precedent = std::move(releve);
+            instant = maintenant;
+        }
+    });
+}
+
+void Simulation::arreter() {
+    if (!arret_.request_stop()) return;
+
+    // La demande réveille toutes les pauses et attentes en cours : chaque thread finit au plus son pas en cours.
+    // Contrôleurs et générateur d'abord : plus aucun avion lancé ni autorisé
+    for (auto& t : threadsInfra_) if (t.joinable()) t.join();
+
+    std::lock_guard<std::mutex> lock(mutexFlotte_);
+    for (auto& t : threadsAvions_) if (t.joinable()) t.join();
+}
+
+CCR& Simulation::getCCR() { return ccr_; }
+const std::vector<Aeroport*>& Simulation::getAeroports() const { return aeroports_; }
+
+std::vector<Avion*> Simulation::getFlotte() const {
+    std::lock_guard<std::mutex> lock(mutexFlotte_);
+    return flotte_;
+}
+
+const Indicateurs* Simulation::getIndicateurs() const { return indicateurs_.get(); }
+
+size_t Simulation::getNombreAvions() const {
+    return programme_.size() + avionsRestaures_.size() + (profils_.empty() ? 0 : limiteGeneres_);
+}
+
+BilanSimulation Simulation::getBilan() const {
+    BilanSimulation bilan = statistiques_.getBilan();
+    if (!demarree_) return bilan;
+    bilan.duree = std::chrono::duration<double>(Horloge::getHorloge().maintenant() - debut_).count();
+
+    // Utilisation des pistes : occupation cumulée rapportée au temps disponible de toutes les pistes
+    double occupation = 0;
+    size_t nombrePistes = 0;
+    for (auto aero : aeroports_) {
+        for (const Piste& piste : aero->twr->getPistes()) {
+            occupation += std::chrono::duration<double>(piste.getOccupationCumulee()).count();
+            ++nombrePistes;
+        }
+    }
+    if (nombrePistes > 0 && bilan.duree > 0) bilan.utilisationPistes = occupation / (bilan.duree * static_cast<double>(nombrePistes));
+    return bilan;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "avion.hpp"
+
+static double enSecondes(long long ms) { return static_cast<double>(ms) / 1000.0; }
+
+Statistiques::Statistiques()
+    : atterrissages_(0), attenteMs_(0), decollages_(0), roulages_(0), roulageMs_(0), crashs_(0), plansRefuses_(0) {}
+
+void Statistiques::ajouterAtterrissage(std::chrono::steady_clock::duration attente) {
+    attenteMs_ += std::chrono::duration_cast<std::chrono::milliseconds>(attente).count();
+    ++atterrissages_;
+}
+
+void Statistiques::ajouterDecollage() { ++decollages_; }
+
+void Statistiques::ajouterRoulage(std::chrono::steady_clock::duration duree) {
+    roulageMs_ += std::chrono::duration_cast<std::chrono::milliseconds>(duree).count();
+    ++roulages_;
+}
+
+void Statistiques::ajouterCrash() { ++crashs_; }
+void Statistiques::ajouterPlanRefuse() { ++plansRefuses_; }
+
+BilanSimulation Statistiques::getBilan() const {
+    BilanSimulation bilan;
+    bilan.atterrissages = atterrissages_;
+    bilan.decollages = decollages_;
+    bilan.roulages = roulages_;
+    bilan.crashs = crashs_;
+    bilan.plansRefuses = plansRefuses_;
+    if (bilan.atterrissages > 0) bilan.attenteMoyenne = enSecondes(attenteMs_) / static_cast<double>(bilan.atterrissages);
+    if (bilan.roulages > 0) bilan.roulageMoyen = enSecondes(roulageMs_) / static_cast<double>(bilan.roulages);
+    return bilan;
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+#include "telemetrie.hpp"
+
+// Visualiseur texte de la télémétrie : s'attache au segment publié par le simulateur (--telemetrie),
+// affiche la dernière image à intervalle régulier et se rattache si le simulateur redémarre.
+// Usage : Telemetre [nom] [--periode ms] [--une-fois]
+
+static const auto DELAI_ABANDON = std::chrono::seconds(3); // Sans nouvelle image pendant ce délai, le segment est considéré abandonné
+
+static void afficher(const ImageTelemetrie& image) {
+    size_t parEtat[NOMBRE_ETATS_AVION] = {};
+    size_t urgences = 0;
+    for (const auto& a : image.avions) {
+        if (a.etat < NOMBRE_ETATS_AVION) ++parEtat[a.etat];
+        if (a.typeUrgence != 0) ++urgences;
+    }
+
+    std::cout << "Image " << image.entete.tick << "  t = " << std::fixed << std::setprecision(1) << image.entete.instantMs / 1000.0
+              << " s  (x" << image.entete.facteur << ")  " << image.avions.size() << " avions, " << urgences << " en urgence\n";
+    for (size_t e = 0; e < NOMBRE_ETATS_AVION; ++e) {
+        if (parEtat[e] > 0) std::cout << "  " << std::left << std::setw(20) << nomEtat(static_cast<EtatAvion>(e)) << std::right << std::setw(5) << parEtat[e] << "\n";
+    }
+    std::cout << "  " << std::left << std::setw(16) << "Aeroport" << std::right << std::setw(8) << "Zone" << std::setw(10) << "Attente"
+              << std::setw(10) << "Pistes" << "\n";
+    for (const auto& c : image.controleurs) {
+        std::cout << "  " << std::left << std::setw(16) << c.nom << std::right << std::setw(8) << c.avionsDansZone << std::setw(10) << c.avionsEnAttente
+                  << std::setw(6) << c.pistesOccupees << "/" << c.nombrePistes << (c.urgence ? "  URGENCE" : "") << "\n";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string nom = "simulation_aero";
+        int periode = 1000;
+        bool uneFois = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option == "--periode" && i + 1 < argc) periode = std::stoi(argv[++i]);
+            else if (option == "--une-fois") uneFois = true;
+            else if (option[0] != '-') nom = option;
+            else throw std::runtime_error("Option inconnue : " + option);
+        }
+        if (periode <= 0) throw std::runtime_error("Periode invalide");
+
+        std::unique_ptr<LecteurTelemetrie> lecteur;
+        ImageTelemetrie image;
+        uint64_t dernierTick = 0;
+        auto derniereImage = std::chrono::steady_clock::now();
+
+        while (true) {
+            if (!lecteur) {
+                try {
+                    lecteur = std::make_unique<LecteurTelemetrie>(nom);
+                    dernierTick = 0;
+                    derniereImage = std::chrono::steady_clock::now();
+                    std::cerr << "[TELEMETRIE] Attache a " << nom << "\n";
+                }
+                catch (const std::exception& e) {
+                    if (uneFois) throw;
+                    std::cerr << "[TELEMETRIE] " << e.what() << ", nouvel essai\n";
+                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                    continue;
+                }
+            }
+
+            if (lecteur->lire(image) && image.entete.tick != dernierTick) {
+                dernierTick = image.entete.tick;
+                derniereImage = std::chrono::steady_clock::now();
+                afficher(image);
+                if (uneFois) break;
+            }
+            else if (std::chrono::steady_clock::now() - derniereImage > DELAI_ABANDON) {
+                // Simulateur arrêté ou remplacé : on se détache pour reprendre le prochain segment
+                std::cerr << "[TELEMETRIE] Plus d'image depuis " << DELAI_ABANDON.count() << " s, detachement\n";
+                lecteur.reset();
+                continue;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(periode));
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Erreur " << e.what() << "\n";
+        return -1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "telemetrie.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#endif
+
+static const char MAGIE_TELEMETRIE[8] = "SIMTELE";
+static const size_t DEBUT_CASES = sizeof(EnTeteTelemetrie);
+static const size_t DEBUT_IMAGE = sizeof(uint64_t); // Après la séquence de la case
+static const size_t DEBUT_AVIONS = DEBUT_IMAGE + sizeof(EnTeteCase);
+static const int ESSAIS_LECTURE = 4;
+static const std::chrono::milliseconds DELAI_CREATION(100); // Avant de relire un segment trouvé incomplet
+
+// Les segments POSIX portables sont nommés "/nom"
+static std::string nomSegment(const std::string& nom) {
+    return (!nom.empty() && nom[0] == '/') ? nom : "/" + nom;
+}
+
+static std::atomic_ref<uint64_t> mot(const char* adresse) {
+    return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(const_cast<char*>(adresse)));
+}
+
+// Copies mot par mot en atomiques relâchés, comme VerrouSequence : une lecture chevauchée par l'écrivain reste définie
+static void ecrireMots(char* destination, const void* source, size_t octets) {
+    const char* s = static_cast<const char*>(source);
+    for (size_t i = 0; i < octets; i += sizeof(uint64_t)) {
+        uint64_t valeur;
+        std::memcpy(&valeur, s + i, sizeof(uint64_t));
+        mot(destination + i).store(valeur, std::memory_order_relaxed);
+    }
+}
+
+static void lireMots(void* destination, const char* source, size_t octets) {
+    char* d = static_cast<char*>(destination);
+    for (size_t i = 0; i < octets; i += sizeof(uint64_t)) {
+        uint64_t valeur = mot(source + i).load(std::memory_order_relaxed);
+        std::memcpy(d + i, &valeur, sizeof(uint64_t));
+    }
+}
+
+#ifndef _WIN32
+// Segment existant sans écrivain vivant : PID absent (création interrompue avant son écriture) ou processus disparu.
+// Le créateur garde un verrou exclusif (flock) jusqu'à l'écriture du PID : la lecture attend une création en cours.
+// Un segment trop court ou sans PID peut avoir été ouvert juste avant ce verrou, il n'est abandonné qu'à la seconde lecture.
+static bool segmentAbandonne(const std::string& nom, uint64_t& processus) {
+    for (int essai = 0; essai < 2; ++essai) {
+        if (essai > 0) std::this_thread::sleep_for(DELAI_CREATION);
+        processus = 0;
+        int fd = shm_open(nom.c_str(), O_RDONLY, 0);
+        if (fd < 0) return errno == ENOENT; // Disparu entre-temps : la création peut être retentée
+        struct stat infos;
+        if (flock(fd, LOCK_SH) != 0 || fstat(fd, &infos) != 0 || infos.st_size < static_cast<off_t>(sizeof(EnTeteTelemetrie))) {
+            close(fd);
+            continue;
+        }
+        void* memoire = mmap(nullptr, sizeof(EnTeteTelemetrie), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // Libère aussi le verrou
+        if (memoire == MAP_FAILED) return false;
+        processus = mot(reinterpret_cast<const char*>(&static_cast<const EnTeteTelemetrie*>(memoire)->processus)).load(std::memory_order_acquire);
+        munmap(memoire, sizeof(EnTeteTelemetrie));
+        if (processus != 0) return kill(static_cast<pid_t>(processus), 0) != 0 && errno == ESRCH; // EPERM : le processus existe sous un autre utilisateur
+    }
+    return true;
+}
+#endif
+
+static void copierNom(char (&destination)[16], const std::string& nom) {
+    std::memset(destination, 0, sizeof(destination));
+    std::memcpy(destination, nom.data(), std::min(nom.size(), sizeof(destination) - 1));
+}
+
+Telemetrie::Telemetrie(const std::string& nom, size_t maxAvions, size_t maxControleurs)
+    : nom_(nomSegment(nom)), memoire_(nullptr), taille_(0),
+    maxAvions_(static_cast<uint32_t>(maxAvions)), maxControleurs_(static_cast<uint32_t>(maxControleurs)), tick_(0) {
+#ifdef _WIN32
+    throw std::runtime_error("Telemetrie : memoire partagee POSIX indisponible sur cette plateforme");
+#else
+    uint64_t tailleCase = DEBUT_AVIONS + sizeof(AvionTelemetrie) * maxAvions_ + sizeof(ControleurTelemetrie) * maxControleurs_;
+    taille_ = DEBUT_CASES + tailleCase * NOMBRE_CASES;
+
+    // Un segment du même nom n'est retiré que si son simulateur a disparu : un simulateur actif et ses lecteurs le gardent
+    int fd = shm_open(nom_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        uint64_t processus = 0;
+        if (!segmentAbandonne(nom_, processus)) {
+            throw std::runtime_error("Telemetrie : le segment " + nom_ + " est publie par un autre simulateur (PID " + std::to_string(processus) + ")");
+        }
+        shm_unlink(nom_.c_str()); // Segment laissé par un simulateur interrompu
+        fd = shm_open(nom_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0) throw std::runtime_error("Telemetrie : creation du segment " + nom_ + " impossible");
+    flock(fd, LOCK_EX); // Jusqu'à l'écriture du PID, relâché à la fermeture
+    if (ftruncate(fd, static_cast<off_t>(taille_)) != 0) {
+        close(fd);
+        shm_unlink(nom_.c_str());
+        throw std::runtime_error("Telemetrie : dimensionnement du segment " + nom_ + " impossible");
+    }
+    void* memoire = mmap(nullptr, taille_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memoire == MAP_FAILED) {
+        close(fd);
+        shm_unlink(nom_.c_str());
+        throw std::runtime_error("Telemetrie : projection du segment " + nom_ + " impossible");
+    }
+    memoire_ = static_cast<char*>(memoire);
+
+    // Segment remis à zéro par ftruncate : séquences et dernier tick nuls. Le PID d'abord, la signature en dernier
+    EnTeteTelemetrie* entete = reinterpret_cast<EnTeteTelemetrie*>(memoire_);
+    mot(reinterpret_cast<const char*>(&entete->processus)).store(static_cast<uint64_t>(getpid()), std::memory_order_release);
+    close(fd);
+    entete->version = VERSION;
+    entete->nombreCases = NOMBRE_CASES;
+    entete->maxAvions = maxAvions_;
+    entete->maxControleurs = maxControleurs_;
+    entete->tailleCase = tailleCase;
+    entete->tailleTotale = taille_;
+    uint64_t magie;
+    std::memcpy(&magie, MAGIE_TELEMETRIE, sizeof(magie));
+    mot(entete->magie).store(magie, std::memory_order_release);
+#endif
+}
+
+Telemetrie::~Telemetrie() {
+#ifndef _WIN32
+    if (memoire_) munmap(memoire_, taille_);
+    shm_unlink(nom_.c_str());
+#endif
+}
+
+void Telemetrie::publier(const std::vector<Avion*>& flotte, const std::vector<Aeroport*>& aeroports, std::chrono::steady_clock::duration instant) {
+    // Image préparée hors du segment : la case n'est ouverte que le temps de la copie
+    avions_.clear();
+    for (Avion* avion : flotte) {
+        if (avions_.size() >= maxAvions_) break;
+        InstantaneAvion etat = avion->getInstantane();
+        AvionTelemetrie a{};
+        copierNom(a.nom, avion->getNom());
+        a.x = etat.position.getX();
+        a.y = etat.position.getY();
+        a.altitude = etat.position.getAltitude();
+        a.carburant = etat.carburant;
+        a.etat = static_cast<uint8_t>(etat.etat);
+        a.typeUrgence = static_cast<uint8_t>(etat.typeUrgence);
+        auto it = std::find(aeroports.begin(), aeroports.end(), etat.destination);
+        a.destination = (it == aeroports.end()) ? -1 : static_cast<int32_t>(it - aeroports.begin());
+        a.piste = (a.destination < 0) ? -1 : static_cast<int32_t>(etat.piste);
+        avions_.push_back(a);
+    }
+    controleurs_.clear();
+    for (Aeroport* aero : aeroports) {
+        if (controleurs_.size() >= maxControleurs_) break;
+        ControleurTelemetrie c{};
+        copierNom(c.nom, aero->nom);
+        c.avionsDansZone = static_cast<uint32_t>(aero->app->getNombreAvionsDansZone());
+        c.avionsEnAttente = static_cast<uint32_t>(aero->app->getNombreAvionsEnAttente());
+        for (const Piste& piste : aero->twr->getPistes()) {
+            if (!piste.estLibre()) ++c.pistesOccupees;
+            ++c.nombrePistes;
+        }
+        c.urgence = aero->twr->estUrgenceEnCours() ? 1 : 0;
+        controleurs_.push_back(c);
+    }
+    if (!memoire_) return;
+
+    EnTeteCase entete{};
+    entete.tick = ++tick_;
+    entete.instantMs = std::chrono::duration_cast<std::chrono::milliseconds>(instant).count();
+    entete.facteur = Horloge::getHorloge().getFacteur();
+    entete.nombreAvions = static_cast<uint32_t>(avions_.size());
+    entete.nombreControleurs = static_cast<uint32_t>(controleurs_.size());
+
+    // Séquence impaire pendant l'écriture, puis 2 * tick + 2 : un lecteur sait quelle image il a copiée
+    char* base = memoire_ + DEBUT_CASES + (tick_ % NOMBRE_CASES) * reinterpret_cast<EnTeteTelemetrie*>(memoire_)->tailleCase;
+    mot(base).store(2 * tick_ + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ecrireMots(base + DEBUT_IMAGE, &entete, sizeof(entete));
+    ecrireMots(base + DEBUT_AVIONS, avions_.data(), avions_.size() * sizeof(AvionTelemetrie));
+    ecrireMots(base + DEBUT_AVIONS + maxAvions_ * sizeof(AvionTelemetrie), controleurs_.data(), controleurs_.size() * sizeof(ControleurTelemetrie));
+    mot(base).store(2 * tick_ + 2, std::memory_order_release);
+    mot(reinterpret_cast<char*>(&reinterpret_cast<EnTeteTelemetrie*>(memoire_)->dernierTick)).store(tick_, std::memory_order_release);
+}
+
+LecteurTelemetrie::LecteurTelemetrie(const std::string& nom) : memoire_(nullptr), taille_(0) {
+#ifdef _WIN32
+    throw std::runtime_error("Telemetrie : memoire partagee POSIX indisponible sur cette plateforme");
+#else
+    std::string segment = nomSegment(nom);
+    int fd = shm_open(segment.c_str(), O_RDONLY, 0);
+    if (fd < 0) throw std::runtime_error("Telemetrie : segment " + segment + " introuvable");
+    struct stat infos;
+    if (fstat(fd, &infos) != 0 || static_cast<size_t>(infos.st_size) < sizeof(EnTeteTelemetrie)) {
+        close(fd);
+        throw std::runtime_error("Telemetrie : segment " + segment + " pas encore pret");
+    }
+    taille_ = static_cast<size_t>(infos.st_size);
+    void* memoire = mmap(nullptr, taille_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memoire == MAP_FAILED) throw std::runtime_error("Telemetrie : projection du segment " + segment + " impossible");
+    memoire_ = static_cast<const char*>(memoire);
+
+    const EnTeteTelemetrie* entete = reinterpret_cast<const EnTeteTelemetrie*>(memoire_);
+    uint64_t magie = mot(entete->magie).load(std::memory_order_acquire);
+    std::string erreur;
+    if (std::memcmp(&magie, MAGIE_TELEMETRIE, sizeof(magie)) != 0) erreur = "pas encore pret ou inconnu";
+    else if (entete->version != Telemetrie::VERSION) erreur = "de version " + std::to_string(entete->version) + " non geree";
+    else if (entete->nombreCases == 0 || entete->tailleTotale > taille_ ||
+             entete->tailleCase < DEBUT_AVIONS + sizeof(AvionTelemetrie) * entete->maxAvions + sizeof(ControleurTelemetrie) * entete->maxControleurs ||
+             DEBUT_CASES + entete->tailleCase * entete->nombreCases > entete->tailleTotale) erreur = "corrompu";
+    if (!erreur.empty()) {
+        munmap(const_cast<char*>(memoire_), taille_);
+        throw std::runtime_error("Telemetrie : segment " + segment + " " + erreur);
+    }
+#endif
+}
+
+LecteurTelemetrie::~LecteurTelemetrie() {
+#ifndef _WIN32
+    if (memoire_) munmap(const_cast<char*>(memoire_), taille_);
+#endif
+}
+
+uint64_t LecteurTelemetrie::getDernierTick() const {
+    return mot(reinterpret_cast<const char*>(&reinterpret_cast<const EnTeteTelemetrie*>(memoire_)->dernierTick)).load(std::memory_order_acquire);
+}
+
+bool LecteurTelemetrie::lire(ImageTelemetrie& image) const {
+    const EnTeteTelemetrie* entete = reinterpret_cast<const EnTeteTelemetrie*>(memoire_);
+    for (int essai = 0; essai < ESSAIS_LECTURE; ++essai) {
+        uint64_t tick = getDernierTick();
+        if (tick == 0) return false; // Rien de publié
+
+        const char* base = memoire_ + DEBUT_CASES + (tick % entete->nombreCases) * entete->tailleCase;
+        uint64_t attendu = 2 * tick + 2;
+        if (mot(base).load(std::memory_order_acquire) != attendu) continue; // Case déjà reprise par l'écrivain
+
+        lireMots(&image.entete, base + DEBUT_IMAGE, sizeof(EnTeteCase));
+        image.avions.resize(std::min(image.entete.nombreAvions, entete->maxAvions));
+        image.controleurs.resize(std::min(image.entete.nombreControleurs, entete->maxControleurs));
+        lireMots(image.avions.data(), base + DEBUT_AVIONS, image.avions.size() * sizeof(AvionTelemetrie));
+        lireMots(image.controleurs.data(), base + DEBUT_AVIONS + entete->maxAvions * sizeof(AvionTelemetrie),
+                 image.controleurs.size() * sizeof(ControleurTelemetrie));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mot(base).load(std::memory_order_relaxed) == attendu) return true; // Copie cohérente
+    }
+    return false;
+}
\ No newline at end of file
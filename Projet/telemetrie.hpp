@@ -0,0 +1,103 @@
+#pragma once
+#include "avion.hpp"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+// Flux de télémétrie en mémoire partagée (POSIX shm) : le simulateur écrit, d'autres processus lisent.
+// Anneau de NOMBRE_CASES images à verrou de séquence : l'écrivain ne se bloque jamais et ignore ses lecteurs,
+// un lecteur trop lent pour une case recommence sur la plus récente.
+// Disposition du segment : EnTeteTelemetrie, puis les cases (séquence, EnTeteCase, avions, contrôleurs), toutes de même taille.
+
+struct EnTeteTelemetrie {
+    char magie[8]; // "SIMTELE" : écrite en dernier, un segment en cours de création n'est pas reconnu
+    uint32_t version;
+    uint32_t nombreCases;
+    uint32_t maxAvions;
+    uint32_t maxControleurs;
+    uint64_t tailleCase; // Octets par case, séquence comprise
+    uint64_t tailleTotale;
+    uint64_t dernierTick; // Dernière image complète (0 : aucune), lu et écrit atomiquement
+    uint64_t processus; // PID de l'écrivain, écrit avant tout le reste : seul un segment dont l'écrivain a disparu est remplacé
+};
+
+struct EnTeteCase {
+    uint64_t tick; // Numéro de l'image, à partir de 1
+    int64_t instantMs; // Temps simulé depuis le démarrage de la simulation
+    double facteur; // Compression du temps au moment de l'image
+    uint32_t nombreAvions;
+    uint32_t nombreControleurs;
+};
+
+struct AvionTelemetrie {
+    char nom[16]; // Tronqué, toujours terminé par un zéro
+    double x, y, altitude;
+    float carburant;
+    uint8_t etat; // EtatAvion
+    uint8_t typeUrgence; // TypeUrgence
+    uint8_t reserve[2];
+    int32_t destination; // Indice du contrôleur de l'aéroport de destination (-1 : aucune)
+    int32_t piste; // Piste assignée (-1 : aucune)
+    uint32_t reserve2[2];
+};
+
+struct ControleurTelemetrie { // Un aéroport : son APP et sa TWR
+    char nom[16];
+    uint32_t avionsDansZone; // Gérés par l'APP
+    uint32_t avionsEnAttente; // En circuit d'attente
+    uint32_t pistesOccupees;
+    uint32_t nombrePistes;
+    uint8_t urgence; // Urgence en cours à la tour
+    uint8_t reserve[7];
+};
+
+static_assert(sizeof(EnTeteTelemetrie) == 56 && sizeof(EnTeteCase) == 32, "Format de telemetrie modifie");
+static_assert(sizeof(AvionTelemetrie) == 64 && sizeof(ControleurTelemetrie) == 40, "Format de telemetrie modifie");
+
+struct ImageTelemetrie { // Copie cohérente d'une case, côté lecteur
+    EnTeteCase entete;
+    std::vector<AvionTelemetrie> avions;
+    std::vector<ControleurTelemetrie> controleurs;
+};
+
+// Côté simulateur : crée le segment et y publie une image par appel
+class Telemetrie {
+private:
+    std::string nom_;
+    char* memoire_;
+    size_t taille_;
+    uint32_t maxAvions_;
+    uint32_t maxControleurs_;
+    uint64_t tick_;
+    std::vector<AvionTelemetrie> avions_; // Image en préparation, recopiée mot par mot dans la case
+    std::vector<ControleurTelemetrie> controleurs_;
+
+public:
+    static const uint32_t VERSION = 2;
+    static const uint32_t NOMBRE_CASES = 8;
+
+    Telemetrie(const std::string& nom, size_t maxAvions, size_t maxControleurs); // Crée le segment (remplace un segment orphelin du même nom, refuse celui d'un simulateur actif)
+    ~Telemetrie(); // Retire le segment : les lecteurs attachés gardent leur projection jusqu'à leur détachement
+    Telemetrie(const Telemetrie&) = delete;
+    void operator=(const Telemetrie&) = delete;
+
+    void publier(const std::vector<Avion*>& flotte, const std::vector<Aeroport*>& aeroports,
+                 std::chrono::steady_clock::duration instant); // Écrit l'image suivante (un seul thread écrivain)
+};
+
+// Côté lecteur : s'attache en lecture seule à un segment existant
+class LecteurTelemetrie {
+private:
+    const char* memoire_;
+    size_t taille_;
+
+public:
+    LecteurTelemetrie(const std::string& nom); // Lance une exception si le segment n'existe pas ou n'est pas reconnu
+    ~LecteurTelemetrie(); // Se détache sans effet sur l'écrivain
+    LecteurTelemetrie(const LecteurTelemetrie&) = delete;
+    void operator=(const LecteurTelemetrie&) = delete;
+
+    uint64_t getDernierTick() const; // Numéro de la dernière image publiée
+    bool lire(ImageTelemetrie& image) const; // Copie la dernière image (faux si aucune ou écrivain trop rapide)
+};
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "avion.hpp"
+
+// Tests de Position : les distances et les comparaisons au carré doivent donner exactement les résultats
+// des anciennes versions avec racine (position.cpp avant l'en-tête seul). Code de sortie 1 au premier écart.
+
+static int echecs = 0;
+
+static void verifier(bool condition, const std::string& message) {
+    if (!condition && ++echecs <= 20) std::cerr << "[ECHEC] " << message << "\n";
+}
+
+static bool memesBits(double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; }
+
+// Anciennes versions, recopiées telles quelles
+static double distanceAncienne(const Position& a, const Position& b) {
+    Position diff = a - b;
+    return std::sqrt(diff.getX() * diff.getX() + diff.getY() * diff.getY() + diff.getAltitude() * diff.getAltitude());
+}
+
+static const Aeroport* plusProcheAncien(const Position& p, const std::vector<Aeroport*>& aeroports) {
+    const Aeroport* proche = nullptr;
+    double distMin = 1e12;
+    for (auto aero : aeroports) {
+        double d = p.distance(aero->position);
+        if (d < distMin) { distMin = d; proche = aero; }
+    }
+    return proche;
+}
+
+static const Aeroport* plusProcheNouveau(const Position& p, const std::vector<Aeroport*>& aeroports) {
+    const Aeroport* proche = nullptr;
+    double distMin = std::numeric_limits<double>::infinity();
+    for (auto aero : aeroports) {
+        double d = p.distanceCarre(aero->position);
+        if (d < distMin) { distMin = d; proche = aero; }
+    }
+    return proche;
+}
+
+// Opérateurs évalués à la compilation
+static_assert(Position(1, 2, 3) + Position(4, 5, 6) == Position(5, 7, 9), "operator+ constexpr");
+static_assert(Position(4, 5, 6) - Position(1, 2, 3) == Position(3, 3, 3), "operator- constexpr");
+static_assert(Position(1, -2, 3) * 2.0 == Position(2, -4, 6), "operator* constexpr");
+static_assert(!(Position(0, 0, 0) == Position(0, 0, 0.002)) && Position(0, 0, 0) == Position(0, 0, 0.0005), "operator== a 1 mm");
+static_assert(Position(3, 4, 12).normeCarre() == 169.0, "normeCarre constexpr");
+static_assert(Position(1, 1, 1).distanceCarre(Position(4, 5, 13)) == 169.0, "distanceCarre constexpr");
+static_assert(Position(0, 0, 100).distanceHorizontaleCarre(Position(3, 4, -50)) == 25.0, "distanceHorizontaleCarre ignore l'altitude");
+
+// Comparaisons d'un carré aux seuils contre les mêmes comparaisons après racine, autour de seuil * seuil
+template <typename Reel>
+static void testerSeuil(Reel seuil, int ulps) {
+    Reel strict = seuilCarreStrict(seuil), inclus = seuilCarreInclus(seuil);
+    Reel x = seuil * seuil;
+    for (int i = 0; i < ulps; ++i) x = std::nextafter(x, Reel(0));
+    for (int i = 0; i <= 2 * ulps; ++i, x = std::nextafter(x, std::numeric_limits<Reel>::infinity())) {
+        verifier((x < strict) == (std::sqrt(x) < seuil), "strict " + std::to_string(seuil) + " pour " + std::to_string(x));
+        verifier((x <= inclus) == (std::sqrt(x) <= seuil), "inclus " + std::to_string(seuil) + " pour " + std::to_string(x));
+    }
+}
+
+int main() {
+    std::mt19937_64 aleatoire(12345);
+    std::uniform_real_distribution<double> coordonnee(-1.5e6, 1.5e6), altitude(0, 12000);
+    auto tirer = [&]() { return Position(coordonnee(aleatoire), coordonnee(aleatoire), altitude(aleatoire)); };
+
+    // distance() et distanceHorizontale() identiques au bit près aux anciennes formules
+    for (int i = 0; i < 200000; ++i) {
+        Position a = tirer(), b = tirer();
+        verifier(memesBits(a.distance(b), distanceAncienne(a, b)), "distance differente de l'ancienne formule");
+        verifier(memesBits(a.distanceCarre(b), (a - b).normeCarre()), "distanceCarre differente de normeCarre");
+        Position a0(a.getX(), a.getY(), 0), b0(b.getX(), b.getY(), 0);
+        verifier(memesBits(a.distanceHorizontaleCarre(b), a0.distanceCarre(b0)), "distanceHorizontaleCarre differente");
+        verifier(memesBits(a.distanceHorizontale(b), distanceAncienne(a0, b0)), "distanceHorizontale differente de l'ancienne formule");
+        verifier(memesBits((a - b).norme(), distanceAncienne(a, b)), "norme differente de l'ancienne formule");
+    }
+
+    // Seuils des appelants : séparation du CCR (<), rayons de contrôle du scénario (<=), clic sur un aéroport (<, float)
+    std::vector<double> seuils = { 20000.0, 1.0, 0.1, 3e5 };
+    std::vector<double> rayons = { 50000.0, 80000.0, static_cast<double>(45000.5f), static_cast<double>(0.3f) };
+    for (double s : seuils) testerSeuil(s, 64);
+    for (double r : rayons) testerSeuil(r, 64);
+    testerSeuil(50.f, 64);
+    for (int i = 0; i < 2000; ++i) testerSeuil(std::uniform_real_distribution<double>(1, 2e5)(aleatoire), 4);
+
+    // Comparaisons complètes, comme aux appels : distance exactement au seuil, puis à quelques ulps de part et d'autre
+    for (double s : seuils) {
+        double strict = seuilCarreStrict(s), inclus = seuilCarreInclus(s);
+        std::vector<std::pair<Position, Position>> paires = {
+            { Position(0, 0, 0), Position(s, 0, 0) },
+            { Position(-s / 2, 0, 0), Position(s / 2, 0, 0) },
+            { Position(100, 200, 3000), Position(100 + s * 0.6, 200 + s * 0.8, 3000) }, // Triangle 3-4-5
+            { Position(0, 0, 0), Position(0, 0, s) },
+        };
+        for (auto [a, b] : paires) {
+            double x = b.getX();
+            for (int i = 0; i < 16; ++i) x = std::nextafter(x, -std::numeric_limits<double>::infinity());
+            for (int i = 0; i <= 32; ++i, x = std::nextafter(x, std::numeric_limits<double>::infinity())) {
+                Position c(x, b.getY(), b.getAltitude());
+                verifier((a.distanceCarre(c) < strict) == (a.distance(c) < s), "distanceCarre < seuil au bord de " + std::to_string(s));
+                verifier((a.distanceCarre(c) <= inclus) == (a.distance(c) <= s), "distanceCarre <= rayon au bord de " + std::to_string(s));
+            }
+        }
+    }
+    for (int i = 0; i < 200000; ++i) {
+        Position a = tirer(), b = tirer();
+        double s = a.distance(b) * std::uniform_real_distribution<double>(0.999999, 1.000001)(aleatoire);
+        verifier((a.distanceCarre(b) < seuilCarreStrict(s)) == (a.distance(b) < s), "distanceCarre < seuil (tirage)");
+        verifier((a.distanceCarre(b) <= seuilCarreInclus(s)) == (a.distance(b) <= s), "distanceCarre <= rayon (tirage)");
+    }
+
+    // Aéroport le plus proche : même choix qu'avec les distances, égalités comprises (le premier gagne)
+    std::vector<Aeroport*> aeroports;
+    for (int i = 0; i < 12; ++i) aeroports.push_back(new Aeroport("A" + std::to_string(i), tirer(), 50000.f));
+    aeroports.push_back(new Aeroport("Double", aeroports[3]->position, 50000.f));
+    for (int i = 0; i < 100000; ++i) {
+        Position p = (i % 10 == 0) ? aeroports[3]->position + Position(1, 0, 0) : tirer();
+        verifier(plusProcheAncien(p, aeroports) == plusProcheNouveau(p, aeroports), "aeroport le plus proche different");
+    }
+    for (auto aero : aeroports) verifier(aero->rayonControleCarre == seuilCarreInclus(static_cast<double>(aero->rayonControle)), "rayonControleCarre");
+    for (auto aero : aeroports) delete aero;
+
+    if (echecs > 0) {
+        std::cerr << echecs << " verifications en echec\n";
+        return 1;
+    }
+    std::cout << "Position : toutes les verifications passent\n";
+    return 0;
+}
\ No newline at end of file
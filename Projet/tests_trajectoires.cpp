@@ -0,0 +1,122 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <string>
+#include <map>
+#include <cmath>
+#include <filesystem>
+
+#include "trajectoires.hpp"
+
+// Tests de l'archive des trajectoires : une flotte en marche aléatoire est écrite (varint, zigzag, prédiction, plusieurs blocs),
+// puis relue par lireInstant et lireTrajectoire. Chaque position doit revenir exactement arrondie à RESOLUTION. Code de sortie 1 au premier écart.
+
+static int echecs = 0;
+
+static void verifier(bool condition, const std::string& message) {
+    if (!condition && ++echecs <= 20) std::cerr << "[ECHEC] " << message << "\n";
+}
+
+struct Attendu { // Position enregistrée d'un avion dans une image
+    long long x, y, altitude;
+    EtatAvion etat;
+};
+
+static bool egal(const PointTrajectoire& p, const Attendu& a) {
+    return p.x == static_cast<double>(a.x) && p.y == static_cast<double>(a.y) && p.altitude == static_cast<double>(a.altitude) && p.etat == a.etat;
+}
+
+int main() {
+    const double R = ArchiveTrajectoires::RESOLUTION;
+    const int IMAGES = 5 * ArchiveTrajectoires::IMAGES_PAR_BLOC + 17; // Plusieurs blocs, le dernier incomplet
+    const size_t AVIONS = 40;
+    std::mt19937_64 aleatoire(2024);
+    std::uniform_real_distribution<double> depart(-2e6, 2e6), pas(-400, 400), altitude(0, 12000);
+    std::uniform_int_distribution<int> gigue(-300, 300), etat(0, static_cast<int>(EtatAvion::ROULE_VERS_PARKING));
+
+    std::vector<Avion*> avions;
+    for (size_t i = 0; i < AVIONS; ++i) {
+        avions.push_back(new Avion("T" + std::to_string(i), 4000, 20, 10000, 10, 5000, Position(depart(aleatoire), depart(aleatoire), altitude(aleatoire))));
+    }
+
+    // Images attendues : instant -> (nom -> position arrondie)
+    std::map<int64_t, std::map<std::string, Attendu>> images;
+    std::filesystem::path chemin = std::filesystem::temp_directory_path() / "tests_trajectoires.traj";
+    {
+        ArchiveTrajectoires archive(chemin.string(), 1000);
+        std::vector<bool> termine(AVIONS, false);
+        int64_t instant = 500;
+        for (int image = 0; image < IMAGES; ++image) {
+            instant += 1000 + gigue(aleatoire); // Périodes irrégulières : la prédiction est rapportée à l'écart de temps
+            std::vector<Avion*> flotte;
+            for (size_t i = 0; i < AVIONS; ++i) {
+                if (image < static_cast<int>(i) * 3) continue; // Arrivées échelonnées dans la flotte
+                if (i % 7 == 3 && image > 100 && image < 180) continue; // Absent plusieurs blocs : repart d'une position absolue
+                Avion* avion = avions[i];
+                Position p = avion->getPosition();
+                if (i % 5 == 0 && image % 41 == 0) p = Position(depart(aleatoire), depart(aleatoire), altitude(aleatoire)); // Saut : écart hors prédiction
+                else p = p + Position(pas(aleatoire), pas(aleatoire), pas(aleatoire) / 10);
+                avion->setPosition(p);
+                if (image % 13 == static_cast<int>(i % 13)) avion->setEtat(static_cast<EtatAvion>(etat(aleatoire)));
+                if (i == 11 && image == 200) avion->setEtat(EtatAvion::TERMINE); // Enregistré une dernière fois puis ignoré
+                flotte.push_back(avion);
+
+                if (termine[i]) continue;
+                EtatAvion e = avion->getEtat();
+                images[instant][avion->getNom()] = { std::llround(p.getX() / R), std::llround(p.getY() / R), std::llround(p.getAltitude() / R), e };
+                if (e == EtatAvion::TERMINE) termine[i] = true;
+            }
+            archive.ajouter(flotte, std::chrono::milliseconds(instant));
+        }
+        archive.fermer();
+    }
+
+    LecteurArchive lecteur(chemin.string());
+    verifier(lecteur.getNombreAvions() == AVIONS, "nombre d'avions");
+    verifier(lecteur.getNombreBlocs() == (IMAGES + ArchiveTrajectoires::IMAGES_PAR_BLOC - 1) / ArchiveTrajectoires::IMAGES_PAR_BLOC, "nombre de blocs");
+    verifier(lecteur.getDebutMs() == images.begin()->first && lecteur.getFinMs() == images.rbegin()->first, "bornes de l'archive");
+
+    // lireInstant : image exacte à chaque instant enregistré, la précédente entre deux, rien avant la première
+    verifier(lecteur.lireInstant(images.begin()->first - 1).empty(), "image avant la premiere");
+    for (const auto& [instant, attendue] : images) {
+        for (int64_t t : { instant, instant + 1 }) {
+            std::vector<PointTrajectoire> points = lecteur.lireInstant(t);
+            verifier(points.size() == attendue.size(), "taille de l'image a " + std::to_string(t));
+            for (const PointTrajectoire& p : points) {
+                auto it = attendue.find(lecteur.getNom(p.avion));
+                verifier(p.instantMs == instant && it != attendue.end() && egal(p, it->second), "position a " + std::to_string(t) + " de " + lecteur.getNom(p.avion));
+            }
+        }
+    }
+
+    // lireTrajectoire : toutes les positions de chaque avion, sur toute l'archive puis sur un intervalle à cheval sur des blocs
+    auto debut = std::next(images.begin(), 70)->first, fin = std::next(images.begin(), 260)->first;
+    for (Avion* avion : avions) {
+        uint32_t id = lecteur.trouverAvion(avion->getNom());
+        verifier(id != LecteurArchive::AUCUN, "avion absent " + avion->getNom());
+        if (id == LecteurArchive::AUCUN) continue;
+        for (auto [de, a] : { std::pair{ images.begin()->first, images.rbegin()->first }, std::pair{ debut, fin } }) {
+            std::vector<Attendu> attendus;
+            std::vector<int64_t> instants;
+            for (auto it = images.lower_bound(de); it != images.end() && it->first <= a; ++it) {
+                auto position = it->second.find(avion->getNom());
+                if (position != it->second.end()) { attendus.push_back(position->second); instants.push_back(it->first); }
+            }
+            std::vector<PointTrajectoire> points = lecteur.lireTrajectoire(id, de, a);
+            verifier(points.size() == attendus.size(), "longueur de la trajectoire de " + avion->getNom());
+            for (size_t k = 0; k < std::min(points.size(), attendus.size()); ++k) {
+                verifier(points[k].avion == id && points[k].instantMs == instants[k] && egal(points[k], attendus[k]), "trajectoire de " + avion->getNom());
+            }
+        }
+    }
+
+    for (Avion* avion : avions) delete avion;
+    std::filesystem::remove(chemin);
+
+    if (echecs > 0) {
+        std::cerr << echecs << " verifications en echec\n";
+        return 1;
+    }
+    std::cout << "Trajectoires : toutes les verifications passent\n";
+    return 0;
+}
\ No newline at end of file
@@ -7,49 +7,66 @@
 #include <cmath>
 
 #define PROBA_URGENCE 1500 // Probabilité d'urgence (1 chance sur 1500 par cycle)
+#define MARGE_CROISIERE_ANALYTIQUE 20000.0 // Reprise du pas à pas à cette distance de la zone de contrôle d'arrivée (m)
+#define PERIODE_BOITES 100 // Période de relevé des messages par TWR et APP (ms), 5 relevés par cycle de 500 ms
 
-// Fonction pour mettre en pause le thread courant
-void simuler_pause(int ms) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+// Fonction pour mettre en pause le thread courant (durée en temps simulé)
+bool simuler_pause(int ms, std::stop_token arret) {
+    return Horloge::getHorloge().pause(std::chrono::milliseconds(ms), arret);
+}
+
+bool attendre_jusqua(std::chrono::steady_clock::time_point instant, std::stop_token arret) {
+    thread_local std::mutex mutex; // Une fois par thread, comme dans Horloge::pause : pas d'allocation par attente
+    thread_local std::condition_variable_any reveil;
+    std::unique_lock<std::mutex> lock(mutex);
+    return !reveil.wait_until(lock, arret, instant, [&arret]() { return arret.stop_requested(); });
 }
 
 // Routine du Centre de Contrôle Régional (CCR)
-void routine_ccr(CCR& ccr) {
-    while (true) {
+void routine_ccr(CCR& ccr, std::stop_token arret) {
+    PORTEE_ALLOCATIONS("CCR");
+    while (!arret.stop_requested()) {
         ccr.gererEspaceAerien(); // Gestion des collisions et transferts
-        simuler_pause(50);
+        simuler_pause(50, arret);
     }
 }
 
 // Routine de la Tour de Contrôle (TWR)
-void routine_twr(TWR& twr) {
-    while (true) {
-        simuler_pause(500);
-        // Gestion des décollages si la piste est libre et pas d'urgence
+void routine_twr(TWR& twr, std::stop_token arret) {
+    PORTEE_ALLOCATIONS("TWR");
+    int releve = 0;
+    while (simuler_pause(PERIODE_BOITES, arret)) {
+        twr.traiterMessages(); // Demandes d'atterrissage de l'APP
+        if (++releve % 5 != 0) continue;
+
+        // Gestion des décollages si une piste est libre et pas d'urgence (un décollage par piste disponible)
         Avion* avionPret = twr.choisirAvionPourDecollage();
 
-        if (avionPret != nullptr) {
-            if (!twr.estUrgenceEnCours()) {
-                twr.autoriserDecollage(avionPret);
-            }
+        while (avionPret != nullptr && !twr.estUrgenceEnCours()) {
+            if (!twr.autoriserDecollage(avionPret)) break;
+            avionPret = twr.choisirAvionPourDecollage();
         }
     }
 }
 
 // Routine du Contrôle d'Approche (APP)
-void routine_app(APP& app) {
-    while (true) {
-        app.mettreAJour(); // Gestion des atterrissages et files d'attente
-        simuler_pause(500);
+void routine_app(APP& app, std::stop_token arret) {
+    PORTEE_ALLOCATIONS("APP");
+    int releve = 0;
+    while (!arret.stop_requested()) {
+        if (releve++ % 5 == 0) app.mettreAJour(); // Gestion des atterrissages et files d'attente
+        else app.traiterMessages(); // Transferts, urgences et réponses de la tour entre deux cycles
+        simuler_pause(PERIODE_BOITES, arret);
     }
 }
 
 // Routine principale simulant le comportement d'un avion (un thread par avion)
-void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr, std::vector<Aeroport*> aeroports) {
+void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr, std::vector<Aeroport*> aeroports,
+                   Statistiques& statistiques, Indicateurs& indicateurs, unsigned int graine, std::stop_token arret) {
+    PORTEE_ALLOCATIONS("Avion");
 
     // Initialisation des générateurs aléatoires pour les urgences et destinations
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 gen(graine);
     std::uniform_int_distribution<> distUrgence(0, PROBA_URGENCE);
     std::uniform_int_distribution<> distType(0, 1);
     std::uniform_int_distribution<> distDest(0, (int)aeroports.size() - 1);
@@ -63,18 +80,75 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
     float dt = 1.f; // Pas de temps pour la simulation physique
 
     // Gestion de l'état pour éviter les libérations multiples de la piste
-    EtatAvion dernierEtat = EtatAvion::TERMINE;
-    bool LiberePiste = false;
+    // (un avion restauré en roulage peut avoir déjà dégagé la piste : même critère que plus bas)
+    EtatAvion dernierEtat = avion.getEtat();
+    bool LiberePiste = (dernierEtat == EtatAvion::ROULE_VERS_PARKING) &&
+        std::abs(avion.getPosition().getY() - twrArrivee->getPositionPiste(avion.getPiste()).getY()) > 50.0;
+    bool urgenceSignalee = false; // L'APP d'arrivée a déjà été prévenu de l'urgence
+    bool finApprocheSignalee = false; // L'APP a déjà reçu la fin de la trajectoire d'approche en cours
+
+    // Statistiques : durée de l'état courant et attente cumulée depuis l'entrée dans la zone d'arrivée
+    auto debutEtat = Horloge::getHorloge().maintenant();
+    std::chrono::steady_clock::duration attenteVol(0);
+
+    // Indicateurs en direct : l'avion compte dans son état courant, son parking (d'une sauvegarde) est déjà compté
+    indicateurs.ajouterAvion(dernierEtat);
+    EtatAvion etatCompte = dernierEtat; // Etat dans lequel l'avion est compté
+    Parking* parkingOccupe = avion.getParking();
 
     // Boucle de "vie" de l'avion
-    while (avion.getEtat() != EtatAvion::TERMINE) {
+    while (avion.getEtat() != EtatAvion::TERMINE && !arret.stop_requested()) {
 
         EtatAvion etat = avion.getEtat();
 
         // Réinitialisation si l'état change
         if (etat != dernierEtat) {
+            auto maintenant = Horloge::getHorloge().maintenant();
+            if (dernierEtat == EtatAvion::EN_ATTENTE_ATTERRISSAGE) attenteVol += maintenant - debutEtat;
+            else if (dernierEtat == EtatAvion::ROULE_VERS_PISTE || dernierEtat == EtatAvion::ROULE_VERS_PARKING) statistiques.ajouterRoulage(maintenant - debutEtat);
+            if (etat == EtatAvion::ATTERRISSAGE) {
+                statistiques.ajouterAtterrissage(attenteVol);
+                indicateurs.ajouterArrivee(aeroArrivee, maintenant, attenteVol);
+                attenteVol = std::chrono::steady_clock::duration(0);
+            }
+            else if (etat == EtatAvion::DECOLLAGE) {
+                statistiques.ajouterDecollage();
+                indicateurs.ajouterDepart(aeroDepart, maintenant);
+            }
+            debutEtat = maintenant;
+            indicateurs.changerEtat(etatCompte, etat);
+            etatCompte = etat;
+
+            // Parking attribué à l'arrivée ou quitté au départ : toujours avec un changement d'état
+            Parking* parking = avion.getParking();
+            if (parking != parkingOccupe) {
+                if (parkingOccupe) indicateurs.libererParking(parkingOccupe);
+                if (parking) indicateurs.occuperParking(parking);
+                parkingOccupe = parking;
+            }
+
             dernierEtat = etat;
             LiberePiste = false;
+            finApprocheSignalee = false;
+        }
+
+        // Croisière loin de tout aéroport : position calculée à la lecture, le thread dort jusqu'à la fin du segment
+        if (etat == EtatAvion::EN_ROUTE && !avion.estEnUrgence()) {
+            auto duree = avion.demarrerCroisiereAnalytique(aeroArrivee->position, aeroArrivee->rayonControle + MARGE_CROISIERE_ANALYTIQUE);
+            if (duree.count() > 0) {
+                // Même loi qu'en pas à pas (1 chance sur PROBA_URGENCE + 1 par pas) : rang du premier pas avec incident tiré
+                // d'une loi géométrique, la croisière s'arrête à ce pas pour que l'urgence y soit déclarée
+                long long pasIncident = std::geometric_distribution<long long>(1.0 / (PROBA_URGENCE + 1))(gen) + 1;
+                auto avantIncident = std::chrono::milliseconds(pasIncident * PAS_AVION_MS);
+                bool incident = avantIncident <= duree;
+                int pas = avion.attendreFinCroisiereAnalytique(incident ? avantIncident : duree, arret);
+
+                // Pas arrondis à l'entier inférieur au réveil : l'incident est atteint à un pas près sauf interruption plus tôt
+                if (incident && !arret.stop_requested() && pas + 1 >= pasIncident) {
+                    avion.declarerUrgence(distType(gen) == 0 ? TypeUrgence::MEDICAL : TypeUrgence::PANNE_MOTEUR);
+                }
+                continue;
+            }
         }
 
         // Détection du décollage (encore au sol)
@@ -88,10 +162,10 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
             // Libération de la piste une fois dégagée après atterrissage
             if (etat == EtatAvion::ROULE_VERS_PARKING) {
                 if (!LiberePiste) {
-                    float yPiste = static_cast<float>(twrArrivee->getPositionPiste().getY());
+                    float yPiste = static_cast<float>(twrArrivee->getPositionPiste(avion.getPiste()).getY());
                     // Si l'avion s'est suffisamment éloigné de l'axe de la piste
                     if (std::abs(avion.getPosition().getY() - yPiste) > 50.0f) {
-                        twrArrivee->libererPiste();
+                        twrArrivee->libererPiste(avion.getPiste());
                         LiberePiste = true; // Marqué comme fait
                     }
                 }
@@ -100,7 +174,7 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
             // si on arrive au parking sans avoir libéré, on libère maintenant
             if (etat == EtatAvion::ROULE_VERS_PARKING && avion.getEtat() == EtatAvion::STATIONNE) {
                 if (!LiberePiste) {
-                    twrArrivee->libererPiste();
+                    twrArrivee->libererPiste(avion.getPiste());
                     LiberePiste = true;
                 }
             }
@@ -115,16 +189,17 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
         // Gestion des états
 
         if (etat == EtatAvion::EN_APPROCHE) {
-            // Arrivée en fin de trajectoire d'approche, demande atterrissage
-            if (avion.getTrajectoire().empty()) {
-                bool autorise = appArrivee->demanderAutorisationAtterrissage(&avion);
-                if (!autorise) appArrivee->mettreEnAttente(&avion);
+            // Arrivée en fin de trajectoire d'approche : l'APP demande la piste à la tour, l'avion attend la réponse sur place
+            if (!avion.trajectoireTerminee()) finApprocheSignalee = false;
+            else if (!finApprocheSignalee) {
+                appArrivee->signalerFinApproche(&avion);
+                finApprocheSignalee = true;
             }
         }
 
         else if (etat == EtatAvion::ATTERRISSAGE) {
             // Fin de l'atterrissage, demande de parking
-            if (avion.getTrajectoire().empty()) {
+            if (avion.trajectoireTerminee()) {
                 Parking* p = twrArrivee->choisirParkingLibre();
 
                 if (p) {
@@ -133,8 +208,8 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
                 }
                 else {
                     // Cas très rare, atterrissage mais sans parking disponible, l'avion bloque alors la piste on le fait disparaître
-                    twrArrivee->libererPiste();
-                    simuler_pause(3000);
+                    twrArrivee->libererPiste(avion.getPiste());
+                    if (!simuler_pause(3000, arret)) break;
                     avion.setEtat(EtatAvion::TERMINE);
                 }
             }
@@ -143,25 +218,26 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
         else if (etat == EtatAvion::STATIONNE) {
             // Phase au sol
 
-            simuler_pause(3000);
+            if (!simuler_pause(3000, arret)) break;
             // Gestion des urgences déclarées en vol
             if (avion.estEnUrgence()) {
                 if (avion.getTypeUrgence() == TypeUrgence::PANNE_MOTEUR) {
-                    Logs::getLogs().log("MAINTENANCE", "Reparation", "Moteur en cours de reparation sur " + avion.getNom());
-                    simuler_pause(5000);
+                    Logs::getLogs().log("MAINTENANCE", "Reparation", "Moteur en cours de reparation sur " + avion.getNom(), avion.getNom());
+                    if (!simuler_pause(5000, arret)) break;
                 }
                 else if (avion.getTypeUrgence() == TypeUrgence::MEDICAL) {
-                    Logs::getLogs().log("MAINTENANCE", "Evacuation", "Passager malade debarque de " + avion.getNom());
-                    simuler_pause(2000);
+                    Logs::getLogs().log("MAINTENANCE", "Evacuation", "Passager malade debarque de " + avion.getNom(), avion.getNom());
+                    if (!simuler_pause(2000, arret)) break;
                 }
             }
             avion.effectuerMaintenance();
+            urgenceSignalee = false;
 
             // Recherche d'une nouvelle destination valide
             Aeroport* nouvelleDestination = nullptr;
             bool planDeVolValide = false;
 
-            while (!planDeVolValide) {
+            while (!planDeVolValide && !arret.stop_requested()) {
                 nouvelleDestination = aeroArrivee;
                 do {
                     int idx = distDest(gen);
@@ -173,11 +249,14 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
                     planDeVolValide = true;
                 }
                 else {
+                    statistiques.ajouterPlanRefuse();
                     std::cout << "[CCR] Planning : Vol " << aeroArrivee->nom << " -> " << nouvelleDestination->nom << " refuse (creneau indisponible). Recherche d'un autre itineraire\n";
-                    simuler_pause(1000);
+                    simuler_pause(1000, arret);
                 }
             }
 
+            if (!planDeVolValide) break; // Arrêt de la simulation pendant la recherche
+
             // Mise à jour des paramètres pour le nouveau vol
             aeroDepart = aeroArrivee;
             aeroArrivee = nouvelleDestination;
@@ -189,11 +268,13 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
             std::cout << "[AVION] " << avion.getNom() << " : Nouvel itineraire valide vers " << aeroArrivee->nom << ".\n";
 
             twrActuelle->enregistrerPourDecollage(&avion);
+            if (avion.getEtat() == EtatAvion::EN_ATTENTE_DECOLLAGE) {
+                indicateurs.changerEtat(etatCompte, EtatAvion::EN_ATTENTE_DECOLLAGE);
+                etatCompte = EtatAvion::EN_ATTENTE_DECOLLAGE;
+            }
 
             // Attente passive jusqu'au décollage
-            while (avion.getEtat() == EtatAvion::EN_ATTENTE_DECOLLAGE) {
-                simuler_pause(200);
-            }
+            while (avion.getEtat() == EtatAvion::EN_ATTENTE_DECOLLAGE && simuler_pause(200, arret)) {}
         }
         else if (etat == EtatAvion::DECOLLAGE) {
             TWR* twrActuelle = aeroDepart->twr;
@@ -204,7 +285,7 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
 
                 std::cout << "[AVION] " << avion.getNom() << " quitte la zone et passe en croisiere.\n";
 
-                ccr.prendreEnCharge(&avion);
+                ccr.prendreEnCharge(&avion, aeroDepart);
 
                 // Mise à jour des contrôleurs pour l'arrivée
                 twrArrivee = aeroArrivee->twr;
@@ -224,6 +305,15 @@ void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr,
             }
         }
 
-        simuler_pause(75);
+        // L'avion prévient lui-même l'APP d'une urgence (déclarée ou carburant) dans sa zone
+        if (!urgenceSignalee && (etat == EtatAvion::EN_APPROCHE || etat == EtatAvion::EN_ATTENTE_ATTERRISSAGE) && avion.estEnUrgence()) {
+            appArrivee->signalerUrgence(&avion);
+            urgenceSignalee = true;
+        }
+
+        simuler_pause(PAS_AVION_MS, arret);
     }
+
+    indicateurs.changerEtat(etatCompte, EtatAvion::TERMINE);
+    if (avion.getCarburant() <= 0) statistiques.ajouterCrash();
 }
\ No newline at end of file
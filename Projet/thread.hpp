@@ -1,18 +1,98 @@
 #pragma once
 #include "avion.hpp"
 #include <vector>
+#include <random>
+#include <memory>
+#include <array>
 
-// Met en pause le thread courant pour une dure (en millisecondes)
-void simuler_pause(int ms);
+class Telemetrie;
 
-// Routine CCR
-void routine_ccr(CCR& ccr);
+// Met en pause le thread courant pour une dure simule (en millisecondes), abrge par la demande d'arrt ; false si arrt demand
+bool simuler_pause(int ms, std::stop_token arret);
+
+// Attend un instant rel, abrg par la demande d'arrt ; false si arrt demand
+bool attendre_jusqua(std::chrono::steady_clock::time_point instant, std::stop_token arret);
+
+// Routine CCR (jusqu' la demande d'arrt)
+void routine_ccr(CCR& ccr, std::stop_token arret);
 
 // Routine TWR
-void routine_twr(TWR& twr);
+void routine_twr(TWR& twr, std::stop_token arret);
 
 // Routine APP
-void routine_app(APP& app);
+void routine_app(APP& app, std::stop_token arret);
+
+// Routine pour chaque avion (graine propre : deux simulations de mme graine tirent les mmes incidents et destinations)
+void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr, std::vector<Aeroport*> aeroports,
+                   Statistiques& statistiques, Indicateurs& indicateurs, unsigned int graine, std::stop_token arret);
+
+// Un monde complet : scnario, contrleurs, avions et leurs threads.
+// Aucun tat partag entre deux simulations hormis l'horloge et les logs : plusieurs peuvent tourner dans le mme processus.
+class Simulation {
+private:
+    struct DepartProgramme { // Avion du scnario et son heure de dpart
+        std::chrono::milliseconds instant; // Temps simul depuis le dmarrage
+        Avion* avion;
+        Aeroport* depart;
+    };
+    struct ProfilTrafic { // Dparts gnrs d'un aroport (processus de Poisson)
+        Aeroport* aeroport;
+        double tauxHoraire; // Dparts par heure simule en moyenne sur la journe
+        std::array<double, 24> heures; // Coefficient de chaque heure de la journe (moyenne 1)
+    };
+    struct ModeleAvion { // Caractristiques des avions gnrs
+        float vitesse = 4000, vitesseSol = 20, carburant = 10000, conso = 10, dureeStationnement = 5000;
+    };
+
+    CCR ccr_;
+    std::vector<Aeroport*> aeroports_;
+    std::vector<DepartProgramme> programme_; // Avions du scnario par heure de dpart, lancs par le gnrateur
+    std::vector<Avion*> avionsRestaures_; // Avions d'une sauvegarde, tous lancs au dmarrage
+    std::vector<ProfilTrafic> profils_;
+    ModeleAvion modele_;
+    double dureeJournee_; // Dure d'une journe simule pour les profils horaires (s)
+    size_t limiteGeneres_; // Nombre maximal d'avions gnrs par les profils
+    size_t generes_;
+    std::vector<Avion*> avionsGeneres_; // Avions crs par les profils (seul le gnrateur y ajoute)
+    std::vector<Avion*> flotte_; // Avions lancs (programms, restaurs ou gnrs), sans en tre propritaire
+    std::vector<std::jthread> threadsAvions_;
+    mutable std::mutex mutexFlotte_; // Protge flotte_ et threadsAvions_
+    std::vector<std::jthread> threadsInfra_; // Contrleurs, gnrateur de trafic et sauvegardes
+    std::stop_source arret_; // Partag par tous les threads : une seule demande les rveille tous, pauses comprises
+    Statistiques statistiques_;
+    std::unique_ptr<Indicateurs> indicateurs_; // Crs au dmarrage, aliments par les avions et les tours
+    std::mt19937 aleatoire_; // Utilis avant le dmarrage puis par le seul gnrateur de trafic
+    std::unique_ptr<Telemetrie> telemetrie_; // Segment de tlmtrie, s'il est publi
+    std::unique_ptr<ChampVent> champVent_; // Vent du scnario (air calme sans section [VENT])
+    std::chrono::steady_clock::time_point debut_;
+    bool demarree_;
+
+    void chargerScenario(const std::string& chemin);
+    void liberer(); // Dtruit avions, contrleurs et aroports (threads arrts)
+    Aeroport* aeroportLePlusProche(const Avion* avion) const;
+    Aeroport* trouverAeroport(const std::string& nom) const; // nullptr si inconnu
+    void lancerAvions(const std::vector<std::pair<Avion*, Aeroport*>>& lot); // Ajoute le lot  la flotte (un seul verrou) puis lance un thread par avion, cr hors du verrou
+    Avion* creerAvionGenere(const ProfilTrafic& profil); // Avion au dpart de l'aroport du profil, destination au hasard
+    void genererTrafic(); // Lance par lots les dparts programms et ceux tirs dans les profils
+
+public:
+    Simulation(const std::string& scenario, unsigned int graine);
+    ~Simulation(); // Arrte les threads puis libre le monde
+    Simulation(const Simulation&) = delete;
+    void operator=(const Simulation&) = delete;
+
+    std::vector<Avion*> restaurer(const std::string& chemin); // Remplace les avions du scnario par ceux d'une sauvegarde (avant demarrer)
+    void demarrer(); // Lance les contrleurs, les avions restaurs et le gnrateur de trafic
+    void sauvegarderPeriodiquement(const std::string& chemin, std::chrono::seconds periode); // Sauvegardes en tche de fond (aprs demarrer)
+    void rapporterAllocations(std::chrono::seconds periode); // Allocations par pas simul et par porte sur la sortie standard (aprs demarrer, build PROFIL_ALLOCATIONS)
+    void publierTelemetrie(const std::string& nom); // Image de la flotte et des contrleurs en mmoire partage  chaque pas (aprs demarrer)
+    void archiverTrajectoires(const std::string& chemin, std::chrono::milliseconds periode); // Positions de toute la flotte par priode simule, archive ferme  l'arrt (aprs demarrer)
+    void arreter(); // Demande l'arrt et attend tous les threads, en moins d'un pas (sans effet si dj arrte)
 
-// Routine pour chaque avion
-void routine_avion(Avion& avion, Aeroport& depart, Aeroport& arrivee, CCR& ccr, std::vector<Aeroport*> aeroports);
\ No newline at end of file
+    CCR& getCCR();
+    const std::vector<Aeroport*>& getAeroports() const;
+    std::vector<Avion*> getFlotte() const; // Copie de la liste des avions lancs, valides jusqu' la destruction de la simulation
+    size_t getNombreAvions() const; // Avions programms ou restaurs, plus la limite des avions gnrs : borne de la flotte
+    BilanSimulation getBilan() const; // Indicateurs depuis le dmarrage
+    const Indicateurs* getIndicateurs() const; // Indicateurs en direct pour l'affichage (nullptr avant demarrer)
+};
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include "trajectoires.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+static const char MAGIE_ARCHIVE[8] = "SIMTRAJ";
+static const uint32_t BOUTISME = 0x01020304; // Relu 0x04030201 sur une machine de l'autre boutisme
+static const int NOMBRE_COLONNES = 7; // Instants, nombres d'avions, identifiants, x, y, altitudes, états
+
+// Entiers sans signe en varint : 7 bits par octet, bit de poids fort à 1 tant que la valeur continue
+static void ecrireVarint(std::vector<uint8_t>& colonne, uint64_t valeur) {
+    while (valeur >= 0x80) {
+        colonne.push_back(static_cast<uint8_t>(valeur | 0x80));
+        valeur >>= 7;
+    }
+    colonne.push_back(static_cast<uint8_t>(valeur));
+}
+
+static uint64_t lireVarint(const uint8_t*& p, const uint8_t* fin) {
+    uint64_t valeur = 0;
+    for (int decalage = 0; decalage < 64; decalage += 7) {
+        if (p == fin) throw std::runtime_error("Bloc d'archive tronque");
+        uint8_t octet = *p++;
+        valeur |= static_cast<uint64_t>(octet & 0x7F) << decalage;
+        if (!(octet & 0x80)) return valeur;
+    }
+    throw std::runtime_error("Varint invalide dans l'archive");
+}
+
+// Entiers signés en zigzag : 0, -1, 1, -2... deviennent 0, 1, 2, 3... (les petits écarts restent sur un octet)
+static uint64_t zigzag(int64_t valeur) { return (static_cast<uint64_t>(valeur) << 1) ^ static_cast<uint64_t>(valeur >> 63); }
+static int64_t dezigzag(uint64_t valeur) { return static_cast<int64_t>(valeur >> 1) ^ -static_cast<int64_t>(valeur & 1); }
+
+// Prédiction d'une coordonnée à l'instant donné, à la vitesse mesurée entre les deux échantillons précédents
+// (rien : 0, un seul : lui-même). Calcul entier : l'écrivain et le lecteur obtiennent exactement la même valeur.
+static int64_t predire(uint32_t echantillons, int64_t dernier, int64_t avantDernier, int64_t instant, const int64_t instants[2]) {
+    if (echantillons == 0) return 0;
+    if (echantillons == 1 || instants[0] <= instants[1]) return dernier;
+    return dernier + (dernier - avantDernier) * (instant - instants[0]) / (instants[0] - instants[1]);
+}
+
+ArchiveTrajectoires::ArchiveTrajectoires(const std::string& chemin, uint32_t periodeMs)
+    : fichier_(chemin, std::ios::binary | std::ios::trunc), chemin_(chemin), taille_(0), debutBloc_(0), dernierInstant_(0),
+      imagesBloc_(0), lignesBloc_(0), lignes_(0), ferme_(false) {
+    if (!fichier_) throw std::runtime_error("Impossible de creer l'archive " + chemin);
+    EnTeteArchive entete{};
+    std::memcpy(entete.magie, MAGIE_ARCHIVE, sizeof(entete.magie));
+    entete.version = VERSION;
+    entete.boutisme = BOUTISME;
+    entete.periodeMs = periodeMs;
+    entete.resolution = RESOLUTION;
+    fichier_.write(reinterpret_cast<const char*>(&entete), sizeof(entete));
+    if (!fichier_) throw std::runtime_error("Ecriture impossible : " + chemin);
+    taille_ = sizeof(entete);
+}
+
+ArchiveTrajectoires::~ArchiveTrajectoires() {
+    try {
+        fermer();
+    }
+    catch (const std::exception&) {
+        // Archive laissée sans index : le lecteur la refuse
+    }
+}
+
+void ArchiveTrajectoires::ajouter(const std::vector<Avion*>& flotte, std::chrono::steady_clock::duration instant) {
+    if (ferme_) throw std::logic_error("Archive deja fermee");
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(instant).count();
+
+    // Image relevée d'abord, avions triés par identifiant : les écarts d'identifiants tiennent sur un octet
+    image_.clear();
+    for (Avion* avion : flotte) {
+        auto [it, nouveau] = suivis_.try_emplace(avion);
+        Suivi& suivi = it->second;
+        if (nouveau) {
+            std::string nom = avion->getNom();
+            suivi.identifiant = static_cast<uint32_t>(avions_.size());
+            suivi.bloc = std::numeric_limits<uint64_t>::max();
+            suivi.termine = false;
+            avions_.push_back({ ms, ms, static_cast<uint32_t>(noms_.size()), static_cast<uint32_t>(nom.size()) });
+            noms_ += nom;
+        }
+        if (suivi.termine) continue;
+        InstantaneAvion etat = avion->getInstantane();
+        Ligne ligne{ &suivi, { std::llround(etat.position.getX() / RESOLUTION), std::llround(etat.position.getY() / RESOLUTION),
+                               std::llround(etat.position.getAltitude() / RESOLUTION) }, static_cast<uint8_t>(etat.etat) };
+        if (etat.etat == EtatAvion::TERMINE) suivi.termine = true;
+        avions_[suivi.identifiant].dernierMs = ms;
+        image_.push_back(ligne);
+    }
+    std::sort(image_.begin(), image_.end(), [](const Ligne& a, const Ligne& b) { return a.suivi->identifiant < b.suivi->identifiant; });
+
+    if (imagesBloc_ == 0) debutBloc_ = ms;
+    ecrireVarint(instants_, zigzag(ms - (imagesBloc_ == 0 ? 0 : dernierInstant_)));
+    ecrireVarint(nombres_, image_.size());
+    std::vector<uint8_t>* colonnes[3] = { &x_, &y_, &altitudes_ };
+    int64_t precedent = -1;
+    for (const Ligne& ligne : image_) {
+        Suivi& suivi = *ligne.suivi;
+        if (suivi.bloc != blocs_.size()) { // Premier passage dans ce bloc : positions absolues
+            suivi.bloc = blocs_.size();
+            suivi.echantillons = 0;
+        }
+        bool changement = suivi.echantillons == 0 || suivi.etat != ligne.etat;
+        ecrireVarint(identifiants_, (static_cast<uint64_t>(suivi.identifiant - precedent - 1) << 1) | (changement ? 1 : 0));
+        precedent = suivi.identifiant;
+        for (int c = 0; c < 3; ++c) {
+            ecrireVarint(*colonnes[c], zigzag(ligne.position[c] - predire(suivi.echantillons, suivi.dernier[c], suivi.avantDernier[c], ms, suivi.instants)));
+            suivi.avantDernier[c] = suivi.dernier[c];
+            suivi.dernier[c] = ligne.position[c];
+        }
+        suivi.instants[1] = suivi.instants[0];
+        suivi.instants[0] = ms;
+        if (changement) etats_.push_back(ligne.etat);
+        suivi.etat = ligne.etat;
+        suivi.echantillons = std::min<uint32_t>(suivi.echantillons + 1, 2);
+    }
+
+    ++imagesBloc_;
+    lignesBloc_ += image_.size();
+    lignes_ += image_.size();
+    dernierInstant_ = ms;
+    if (imagesBloc_ >= IMAGES_PAR_BLOC || lignesBloc_ >= LIGNES_PAR_BLOC) ecrireBloc();
+}
+
+void ArchiveTrajectoires::ecrireBloc() {
+    if (imagesBloc_ == 0) return;
+    bloc_.clear();
+    ecrireVarint(bloc_, imagesBloc_);
+    std::vector<uint8_t>* colonnes[NOMBRE_COLONNES] = { &instants_, &nombres_, &identifiants_, &x_, &y_, &altitudes_, &etats_ };
+    for (std::vector<uint8_t>* colonne : colonnes) {
+        ecrireVarint(bloc_, colonne->size());
+        bloc_.insert(bloc_.end(), colonne->begin(), colonne->end());
+        colonne->clear();
+    }
+    if (bloc_.size() > std::numeric_limits<uint32_t>::max()) throw std::runtime_error("Bloc d'archive trop grand");
+
+    fichier_.write(reinterpret_cast<const char*>(bloc_.data()), static_cast<std::streamsize>(bloc_.size()));
+    if (!fichier_) throw std::runtime_error("Ecriture impossible : " + chemin_);
+    blocs_.push_back({ debutBloc_, dernierInstant_, taille_, static_cast<uint32_t>(bloc_.size()), imagesBloc_ });
+    taille_ += bloc_.size();
+    imagesBloc_ = 0;
+    lignesBloc_ = 0;
+}
+
+void ArchiveTrajectoires::fermer() {
+    if (ferme_) return;
+    ferme_ = true;
+    ecrireBloc();
+
+    PiedArchive pied{};
+    pied.decalageIndex = taille_;
+    pied.nombreBlocs = static_cast<uint32_t>(blocs_.size());
+    pied.nombreAvions = static_cast<uint32_t>(avions_.size());
+    pied.tailleNoms = noms_.size();
+    std::memcpy(pied.magie, MAGIE_ARCHIVE, sizeof(pied.magie));
+    fichier_.write(reinterpret_cast<const char*>(blocs_.data()), static_cast<std::streamsize>(blocs_.size() * sizeof(EntreeBloc)));
+    fichier_.write(reinterpret_cast<const char*>(avions_.data()), static_cast<std::streamsize>(avions_.size() * sizeof(EntreeAvion)));
+    fichier_.write(noms_.data(), static_cast<std::streamsize>(noms_.size()));
+    fichier_.write(reinterpret_cast<const char*>(&pied), sizeof(pied));
+    fichier_.close();
+    if (!fichier_) throw std::runtime_error("Ecriture impossible : " + chemin_);
+    taille_ += blocs_.size() * sizeof(EntreeBloc) + avions_.size() * sizeof(EntreeAvion) + noms_.size() + sizeof(pied);
+}
+
+uint64_t ArchiveTrajectoires::getTaille() const { return taille_; }
+uint64_t ArchiveTrajectoires::getNombreLignes() const { return lignes_; }
+
+LecteurArchive::LecteurArchive(const std::string& chemin) : fichier_(chemin, std::ios::binary), entete_{}, blocsLus_(0) {
+    if (!fichier_) throw std::runtime_error("Archive introuvable : " + chemin);
+    fichier_.seekg(0, std::ios::end);
+    uint64_t taille = static_cast<uint64_t>(fichier_.tellg());
+    if (taille < sizeof(EnTeteArchive) + sizeof(PiedArchive)) throw std::runtime_error("Archive trop courte : " + chemin);
+
+    fichier_.seekg(0);
+    fichier_.read(reinterpret_cast<char*>(&entete_), sizeof(entete_));
+    if (std::memcmp(entete_.magie, MAGIE_ARCHIVE, sizeof(entete_.magie)) != 0) throw std::runtime_error("Pas une archive de trajectoires : " + chemin);
+    if (entete_.boutisme != BOUTISME) throw std::runtime_error("Archive ecrite sur une machine d'un autre boutisme");
+    if (entete_.version != ArchiveTrajectoires::VERSION) throw std::runtime_error("Version d'archive non prise en charge");
+
+    PiedArchive pied{};
+    fichier_.seekg(static_cast<std::streamoff>(taille - sizeof(pied)));
+    fichier_.read(reinterpret_cast<char*>(&pied), sizeof(pied));
+    if (!fichier_ || std::memcmp(pied.magie, MAGIE_ARCHIVE, sizeof(pied.magie)) != 0) throw std::runtime_error("Archive incomplete (sans index) : " + chemin);
+    uint64_t tailleIndex = pied.nombreBlocs * sizeof(EntreeBloc) + pied.nombreAvions * sizeof(EntreeAvion) + pied.tailleNoms;
+    if (pied.decalageIndex < sizeof(EnTeteArchive) || pied.decalageIndex + tailleIndex + sizeof(pied) != taille) {
+        throw std::runtime_error("Index d'archive incoherent : " + chemin);
+    }
+
+    blocs_.resize(pied.nombreBlocs);
+    avions_.resize(pied.nombreAvions);
+    std::string noms(pied.tailleNoms, '\0');
+    fichier_.seekg(static_cast<std::streamoff>(pied.decalageIndex));
+    fichier_.read(reinterpret_cast<char*>(blocs_.data()), static_cast<std::streamsize>(blocs_.size() * sizeof(EntreeBloc)));
+    fichier_.read(reinterpret_cast<char*>(avions_.data()), static_cast<std::streamsize>(avions_.size() * sizeof(EntreeAvion)));
+    fichier_.read(noms.data(), static_cast<std::streamsize>(noms.size()));
+    if (!fichier_) throw std::runtime_error("Lecture de l'index impossible : " + chemin);
+    for (const EntreeBloc& bloc : blocs_) {
+        if (bloc.decalage < sizeof(EnTeteArchive) || bloc.decalage + bloc.taille > pied.decalageIndex) throw std::runtime_error("Index d'archive incoherent : " + chemin);
+    }
+    for (const EntreeAvion& avion : avions_) {
+        if (static_cast<uint64_t>(avion.debutNom) + avion.longueurNom > noms.size()) throw std::runtime_error("Table des avions incoherente : " + chemin);
+        noms_.push_back(noms.substr(avion.debutNom, avion.longueurNom));
+        parNom_.emplace(noms_.back(), static_cast<uint32_t>(noms_.size() - 1));
+    }
+    historiques_.assign(avions_.size(), Historique{});
+}
+
+template <typename Traitement>
+int64_t LecteurArchive::decoderBloc(size_t bloc, uint32_t avion, int64_t finMs, Traitement traiter) {
+    const EntreeBloc& entree = blocs_[bloc];
+    donnees_.resize(entree.taille);
+    fichier_.clear();
+    fichier_.seekg(static_cast<std::streamoff>(entree.decalage));
+    fichier_.read(reinterpret_cast<char*>(donnees_.data()), static_cast<std::streamsize>(donnees_.size()));
+    if (!fichier_) throw std::runtime_error("Lecture d'un bloc d'archive impossible");
+    uint64_t decodage = ++blocsLus_;
+
+    const uint8_t* p = donnees_.data();
+    const uint8_t* fin = p + donnees_.size();
+    uint64_t images = lireVarint(p, fin);
+    const uint8_t* colonnes[NOMBRE_COLONNES];
+    const uint8_t* finsColonnes[NOMBRE_COLONNES];
+    for (int c = 0; c < NOMBRE_COLONNES; ++c) {
+        uint64_t longueur = lireVarint(p, fin);
+        if (longueur > static_cast<uint64_t>(fin - p)) throw std::runtime_error("Bloc d'archive tronque");
+        colonnes[c] = p;
+        finsColonnes[c] = p + longueur;
+        p += longueur;
+    }
+
+    // Toutes les lignes sont parcourues : chaque écart dépend des positions précédentes du même avion
+    int64_t instant = 0, dernierInstant = std::numeric_limits<int64_t>::min();
+    for (uint64_t i = 0; i < images; ++i) {
+        instant += dezigzag(lireVarint(colonnes[0], finsColonnes[0]));
+        if (instant > finMs) break;
+        dernierInstant = instant;
+        uint64_t nombre = lireVarint(colonnes[1], finsColonnes[1]);
+        int64_t precedent = -1;
+        for (uint64_t n = 0; n < nombre; ++n) {
+            uint64_t valeur = lireVarint(colonnes[2], finsColonnes[2]);
+            uint64_t identifiant = static_cast<uint64_t>(precedent + 1) + (valeur >> 1);
+            if (identifiant >= historiques_.size()) throw std::runtime_error("Avion inconnu dans un bloc d'archive");
+            precedent = static_cast<int64_t>(identifiant);
+            Historique& h = historiques_[identifiant];
+            if (h.bloc != decodage) {
+                h.bloc = decodage;
+                h.echantillons = 0;
+            }
+            int64_t position[3];
+            for (int c = 0; c < 3; ++c) {
+                position[c] = predire(h.echantillons, h.dernier[c], h.avantDernier[c], instant, h.instants) + dezigzag(lireVarint(colonnes[3 + c], finsColonnes[3 + c]));
+                h.avantDernier[c] = h.dernier[c];
+                h.dernier[c] = position[c];
+            }
+            h.instants[1] = h.instants[0];
+            h.instants[0] = instant;
+            h.echantillons = std::min<uint32_t>(h.echantillons + 1, 2);
+            if (valeur & 1) {
+                if (colonnes[6] == finsColonnes[6]) throw std::runtime_error("Bloc d'archive tronque");
+                h.etat = *colonnes[6]++;
+            }
+            if (avion == AUCUN || avion == identifiant) {
+                traiter(PointTrajectoire{ instant, static_cast<uint32_t>(identifiant), position[0] * entete_.resolution, position[1] * entete_.resolution,
+                                          position[2] * entete_.resolution, static_cast<EtatAvion>(h.etat) });
+            }
+        }
+    }
+    return dernierInstant;
+}
+
+size_t LecteurArchive::getNombreBlocs() const { return blocs_.size(); }
+size_t LecteurArchive::getNombreAvions() const { return avions_.size(); }
+const std::string& LecteurArchive::getNom(uint32_t avion) const { return noms_.at(avion); }
+const EntreeAvion& LecteurArchive::getAvion(uint32_t avion) const { return avions_.at(avion); }
+int64_t LecteurArchive::getDebutMs() const { return blocs_.empty() ? 0 : blocs_.front().debutMs; }
+int64_t LecteurArchive::getFinMs() const { return blocs_.empty() ? 0 : blocs_.back().finMs; }
+uint32_t LecteurArchive::getPeriodeMs() const { return entete_.periodeMs; }
+uint64_t LecteurArchive::getBlocsLus() const { return blocsLus_; }
+
+uint32_t LecteurArchive::trouverAvion(const std::string& nom) const {
+    auto it = parNom_.find(nom);
+    return it == parNom_.end() ? AUCUN : it->second;
+}
+
+std::vector<PointTrajectoire> LecteurArchive::lireInstant(int64_t instantMs) {
+    // Dernier bloc commencé à l'instant demandé ou avant : un seul bloc décodé
+    auto suivant = std::upper_bound(blocs_.begin(), blocs_.end(), instantMs, [](int64_t t, const EntreeBloc& b) { return t < b.debutMs; });
+    std::vector<PointTrajectoire> points;
+    if (suivant == blocs_.begin()) return points;
+    int64_t derniere = decoderBloc(static_cast<size_t>(suivant - blocs_.begin() - 1), AUCUN, instantMs, [&](const PointTrajectoire& point) {
+        if (!points.empty() && points.back().instantMs != point.instantMs) points.clear();
+        points.push_back(point);
+    });
+    if (!points.empty() && points.back().instantMs != derniere) points.clear(); // Dernière image vide
+    return points;
+}
+
+std::vector<PointTrajectoire> LecteurArchive::lireTrajectoire(uint32_t avion, int64_t debutMs, int64_t finMs) {
+    const EntreeAvion& entree = getAvion(avion);
+    debutMs = std::max(debutMs, entree.premierMs);
+    finMs = std::min(finMs, entree.dernierMs);
+    std::vector<PointTrajectoire> points;
+    if (debutMs > finMs) return points;
+
+    // Blocs qui recoupent l'intervalle, restreint à la présence de l'avion dans l'archive
+    auto premier = std::lower_bound(blocs_.begin(), blocs_.end(), debutMs, [](const EntreeBloc& b, int64_t t) { return b.finMs < t; });
+    for (auto it = premier; it != blocs_.end() && it->debutMs <= finMs; ++it) {
+        decoderBloc(static_cast<size_t>(it - blocs_.begin()), avion, finMs, [&](const PointTrajectoire& point) {
+            if (point.instantMs >= debutMs) points.push_back(point);
+        });
+    }
+    return points;
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+#include "avion.hpp"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <unordered_map>
+#include <cstdint>
+
+// Archive des trajectoires de toute la flotte : une image des positions par période de temps simulé, regroupées en blocs.
+// Dans un bloc, les images sont rangées par colonnes (instants, nombres d'avions, identifiants, x, y, altitudes, états),
+// chaque valeur en varint : identifiants en écart au précédent de l'image, positions arrondies à RESOLUTION en écart à la
+// prédiction linéaire (vitesse des deux images précédentes du même avion dans le bloc, rapportée à l'écart de temps), état seulement quand il change.
+// Un bloc se décode seul : l'index de fin de fichier suffit pour n'en lire que ceux de l'intervalle demandé.
+// Disposition : EnTeteArchive, blocs, index (EntreeBloc), table des avions (EntreeAvion puis noms), PiedArchive.
+
+struct EnTeteArchive {
+    char magie[8]; // "SIMTRAJ"
+    uint32_t version;
+    uint32_t boutisme;
+    uint32_t periodeMs; // Période d'échantillonnage demandée (temps simulé)
+    uint32_t reserve;
+    double resolution; // Pas des positions enregistrées (unités du monde)
+};
+
+struct EntreeBloc {
+    int64_t debutMs; // Instants de la première et de la dernière image du bloc
+    int64_t finMs;
+    uint64_t decalage; // Depuis le début du fichier
+    uint32_t taille; // Octets du bloc
+    uint32_t images;
+};
+
+struct EntreeAvion {
+    int64_t premierMs; // Première et dernière image où l'avion figure
+    int64_t dernierMs;
+    uint32_t debutNom; // Dans la table des noms, sans zéro final
+    uint32_t longueurNom;
+};
+
+struct PiedArchive {
+    uint64_t decalageIndex;
+    uint32_t nombreBlocs;
+    uint32_t nombreAvions;
+    uint64_t tailleNoms;
+    char magie[8]; // "SIMTRAJ" : écrite en dernier, une archive interrompue n'est pas reconnue
+};
+
+static_assert(sizeof(EnTeteArchive) == 32 && sizeof(EntreeBloc) == 32, "Format d'archive modifie");
+static_assert(sizeof(EntreeAvion) == 24 && sizeof(PiedArchive) == 32, "Format d'archive modifie");
+
+struct PointTrajectoire { // Position d'un avion dans une image de l'archive
+    int64_t instantMs; // Temps simulé depuis le démarrage
+    uint32_t avion; // Identifiant dans l'archive (ordre de première apparition)
+    double x, y, altitude;
+    EtatAvion etat;
+};
+
+// Côté simulateur : une image par appel à ajouter, un seul thread écrivain
+class ArchiveTrajectoires {
+private:
+    struct Suivi { // Historique d'un avion dans le bloc en cours
+        uint32_t identifiant;
+        uint64_t bloc; // Bloc des échantillons ci-dessous : un avion absent du bloc en cours repart de zéro
+        uint32_t echantillons;
+        int64_t dernier[3]; // x, y, altitude arrondis
+        int64_t avantDernier[3];
+        int64_t instants[2]; // Instants du dernier et de l'avant-dernier échantillon (ms)
+        uint8_t etat;
+        bool termine; // Image TERMINE déjà enregistrée : l'avion n'apparaît plus
+    };
+    struct Ligne {
+        Suivi* suivi;
+        int64_t position[3];
+        uint8_t etat;
+    };
+
+    std::ofstream fichier_;
+    std::string chemin_;
+    uint64_t taille_; // Octets écrits
+    std::unordered_map<const Avion*, Suivi> suivis_;
+    std::vector<EntreeAvion> avions_;
+    std::string noms_;
+    std::vector<EntreeBloc> blocs_;
+    std::vector<Ligne> image_; // Réutilisée à chaque image
+
+    // Bloc en cours, une colonne par champ
+    std::vector<uint8_t> instants_, nombres_, identifiants_, x_, y_, altitudes_, etats_;
+    std::vector<uint8_t> bloc_; // Bloc assemblé avant écriture
+    int64_t debutBloc_;
+    int64_t dernierInstant_;
+    uint32_t imagesBloc_;
+    size_t lignesBloc_;
+    uint64_t lignes_; // Positions enregistrées depuis l'ouverture
+    bool ferme_;
+
+    void ecrireBloc();
+
+public:
+    static const uint32_t VERSION = 1;
+    static constexpr double RESOLUTION = 1.0;
+    static const uint32_t IMAGES_PAR_BLOC = 64;
+    static const size_t LIGNES_PAR_BLOC = 1 << 20; // Borne la mémoire du bloc en cours pour les grandes flottes
+
+    ArchiveTrajectoires(const std::string& chemin, uint32_t periodeMs); // Crée (ou remplace) le fichier
+    ~ArchiveTrajectoires(); // Ferme l'archive si ce n'est déjà fait
+    ArchiveTrajectoires(const ArchiveTrajectoires&) = delete;
+    void operator=(const ArchiveTrajectoires&) = delete;
+
+    void ajouter(const std::vector<Avion*>& flotte, std::chrono::steady_clock::duration instant); // Image de la flotte à l'instant simulé donné
+    void fermer(); // Écrit le dernier bloc, l'index et la table des avions
+
+    uint64_t getTaille() const;
+    uint64_t getNombreLignes() const;
+};
+
+// Côté analyse : lit l'index à l'ouverture, puis seulement les blocs utiles à chaque requête
+class LecteurArchive {
+private:
+    struct Historique { // Dernières positions décodées d'un avion dans le bloc en cours de décodage
+        uint64_t bloc; // Décodage auquel appartient l'historique (0 : aucun)
+        uint32_t echantillons;
+        int64_t dernier[3];
+        int64_t avantDernier[3];
+        int64_t instants[2];
+        uint8_t etat;
+    };
+
+    std::ifstream fichier_;
+    EnTeteArchive entete_;
+    std::vector<EntreeBloc> blocs_;
+    std::vector<EntreeAvion> avions_;
+    std::vector<std::string> noms_;
+    std::unordered_map<std::string, uint32_t> parNom_;
+    uint64_t blocsLus_;
+    std::vector<Historique> historiques_; // Un par avion, réutilisés d'un bloc à l'autre
+    std::vector<uint8_t> donnees_;
+
+    // Décode les images du bloc jusqu'à finMs et passe à traiter chaque position retenue (avion AUCUN : toutes) ;
+    // renvoie l'instant de la dernière image décodée
+    template <typename Traitement>
+    int64_t decoderBloc(size_t bloc, uint32_t avion, int64_t finMs, Traitement traiter);
+
+public:
+    static const uint32_t AUCUN = 0xFFFFFFFF;
+
+    LecteurArchive(const std::string& chemin); // Lance une exception si le fichier n'est pas une archive complète
+
+    size_t getNombreBlocs() const;
+    size_t getNombreAvions() const;
+    const std::string& getNom(uint32_t avion) const;
+    uint32_t trouverAvion(const std::string& nom) const; // AUCUN si l'avion n'est pas dans l'archive
+    const EntreeAvion& getAvion(uint32_t avion) const;
+    int64_t getDebutMs() const;
+    int64_t getFinMs() const;
+    uint32_t getPeriodeMs() const;
+    uint64_t getBlocsLus() const; // Blocs décodés depuis l'ouverture
+
+    std::vector<PointTrajectoire> lireInstant(int64_t instantMs); // Dernière image enregistrée à l'instant donné ou avant (vide avant la première)
+    std::vector<PointTrajectoire> lireTrajectoire(uint32_t avion, int64_t debutMs, int64_t finMs); // Positions de l'avion entre deux instants inclus
+};
\ No newline at end of file
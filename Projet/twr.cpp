@@ -3,81 +3,189 @@
 #include <algorithm>
 #include <sstream>
 
-TWR::TWR(std::vector<Parking>& parkings, Position posPiste, float tempsAtterrissageDecollage)
-    : pisteLibre_(true),
+const auto CYCLE_TWR = std::chrono::milliseconds(500); // Période de routine_twr
+
+TWR::TWR(const std::string& aeroport, std::vector<Parking>& parkings, const ReseauRoulage& roulage, Position posPiste, float tempsAtterrissageDecollage)
+    : aeroport_(aeroport),
     parkings_(parkings),
-    posPiste_(posPiste),
+    roulage_(roulage),
     tempsAtterrissageDecollage_(tempsAtterrissageDecollage),
     urgenceEnCours_(false),
-    tourActuel_(Tour::DECOLLAGE),
-    demandeAtterrissage_(false)
+    demandeAtterrissage_(false),
+    maxDepartsEnCours_(3),
+    indicateurs_(nullptr),
+    aeroportIndicateurs_(nullptr)
 {
     if (parkings_.empty()) throw std::runtime_error("TWR initialisee sans parkings");
+    pistes_.push_back(Piste("PRINCIPALE", posPiste, ModePiste::MIXTE, tempsAtterrissageDecollage_)); // Piste par défaut
+    publierEtat();
 }
 
-Position TWR::getPositionPiste() const {
+const std::string& TWR::getAeroport() const { return aeroport_; }
+
+void TWR::setIndicateurs(Indicateurs* indicateurs, const Aeroport* aeroport) {
     std::lock_guard<std::mutex> lock(mutexTWR_);
-    return posPiste_;
+    indicateurs_ = indicateurs;
+    aeroportIndicateurs_ = aeroport;
+}
+
+void TWR::libererPisteVerrouillee(size_t indexPiste, std::chrono::steady_clock::time_point maintenant) {
+    Piste& piste = pistes_[indexPiste];
+    auto avant = piste.getOccupationCumulee();
+    piste.liberer(maintenant);
+    if (indicateurs_ && piste.getOccupationCumulee() != avant) indicateurs_->ajouterOccupationPiste(aeroportIndicateurs_, maintenant, piste.getOccupationCumulee() - avant);
 }
 
-bool TWR::estPisteLibre() const { return pisteLibre_; }
-void TWR::libererPiste() { pisteLibre_ = true; }
-void TWR::reserverPiste() { pisteLibre_ = false; }
+void TWR::publierEtat() {
+    auto etat = std::make_shared<EtatPublie>();
+    etat->pistes = pistes_;
+    for (size_t i = 0; i < pistes_.size(); ++i) etat->decollageEnAttente.push_back(decollageEnAttente(i));
+    etatPublie_.store(std::move(etat));
+}
 
-void TWR::setDemandeAtterrissage(bool statut) {
+size_t TWR::indexParking(const Parking* parking) const {
+    if (parking < parkings_.data() || parking >= parkings_.data() + parkings_.size()) {
+        throw std::invalid_argument("Parking n'appartenant pas a cet aeroport");
+    }
+    return static_cast<size_t>(parking - parkings_.data());
+}
+
+void TWR::viderPistes() {
     std::lock_guard<std::mutex> lock(mutexTWR_);
-    demandeAtterrissage_ = statut;
+    pistes_.clear();
+    publierEtat();
 }
 
-bool TWR::autoriserAtterrissage(Avion* avion) {
+void TWR::ajouterPiste(const std::string& nom, Position seuil, ModePiste mode, float tempsOccupation) {
     std::lock_guard<std::mutex> lock(mutexTWR_);
-    if (!avion) throw std::invalid_argument("Avion NULL");
+    for (const auto& piste : pistes_) {
+        if (piste.getNom() == nom) throw std::invalid_argument("Piste en double : " + nom);
+    }
+    // Temps d'occupation négatif : on garde celui de la tour
+    pistes_.push_back(Piste(nom, seuil, mode, tempsOccupation < 0 ? tempsAtterrissageDecollage_ : tempsOccupation));
+    publierEtat();
+}
 
-    // Vérification de la disponibilité d'un parking
-    bool parkingDispo = false;
-    for (const auto& p : parkings_) {
-        if (!p.estOccupe()) {
-            parkingDispo = true;
-            break;
-        }
+size_t TWR::getNombrePistes() const { return etatPublie_.load()->pistes.size(); }
+
+size_t TWR::getIndexPiste(const std::string& nom) const {
+    std::lock_guard<std::mutex> lock(mutexTWR_);
+    for (size_t i = 0; i < pistes_.size(); ++i) {
+        if (pistes_[i].getNom() == nom) return i;
     }
+    throw std::invalid_argument("Piste inconnue : " + nom);
+}
 
-    // Priorité absolue aux urgences
-    if (avion->estEnUrgence()) {
-        pisteLibre_ = false;
-        avion->setEtat(EtatAvion::ATTERRISSAGE);
-        return true;
+std::vector<Piste> TWR::getPistes() const { return etatPublie_.load()->pistes; }
+
+Position TWR::getPositionPiste(size_t indexPiste) const {
+    auto etat = etatPublie_.load();
+    if (indexPiste >= etat->pistes.size()) throw std::out_of_range("Piste inexistante");
+    return etat->pistes[indexPiste].getSeuil();
+}
+
+bool TWR::estPisteLibre(size_t indexPiste) const {
+    std::lock_guard<std::mutex> lock(mutexTWR_);
+    if (indexPiste >= pistes_.size()) throw std::out_of_range("Piste inexistante");
+    return pistes_[indexPiste].estLibre();
+}
+
+void TWR::libererPiste(size_t indexPiste) {
+    std::lock_guard<std::mutex> lock(mutexTWR_);
+    if (indexPiste >= pistes_.size()) throw std::out_of_range("Piste inexistante");
+    libererPisteVerrouillee(indexPiste, Horloge::getHorloge().maintenant());
+    publierEtat();
+}
+
+void TWR::reserverPiste(size_t indexPiste) {
+    std::lock_guard<std::mutex> lock(mutexTWR_);
+    if (indexPiste >= pistes_.size()) throw std::out_of_range("Piste inexistante");
+    pistes_[indexPiste].reserver(Horloge::getHorloge().maintenant());
+    publierEtat();
+}
+
+bool TWR::parkingDisponible() const {
+    for (const auto& p : parkings_) {
+        if (!p.estOccupe()) return true;
     }
+    return false;
+}
 
-    // Refus si piste occupée ou pas de parking
-    if (!pisteLibre_) {
-        return false;
+bool TWR::decollageEnAttente(size_t indexPiste) const {
+    for (auto* a : filePourDecollage_) {
+        InstantaneAvion etat = a->getInstantane();
+        if (etat.etat == EtatAvion::EN_ATTENTE_PISTE && etat.piste == indexPiste) return true;
     }
-    if (!parkingDispo) {
-        return false;
+    return false;
+}
+
+void TWR::setDemandeAtterrissage(bool statut) { demandeAtterrissage_ = statut; }
+
+bool TWR::autoriserAtterrissage(Avion* avion) {
+    std::lock_guard<std::mutex> lock(mutexTWR_);
+    if (!avion) throw std::invalid_argument("Avion NULL");
+
+    auto maintenant = Horloge::getHorloge().maintenant();
+    size_t pisteAssignee = avion->getPiste();
+    if (pisteAssignee >= pistes_.size() || !pistes_[pisteAssignee].accepteArrivees()) pisteAssignee = pistes_.size();
+
+    // Une piste convient si elle est disponible et que ce n'est pas le tour d'un décollage (mode mixte)
+    auto pisteUtilisable = [&](size_t i) {
+        if (!pistes_[i].accepteArrivees() || !pistes_[i].estDisponible(maintenant)) return false;
+        if (pistes_[i].getMode() == ModePiste::MIXTE && pistes_[i].getTour() == Tour::DECOLLAGE && decollageEnAttente(i)) return false;
+        return true;
+    };
+
+    // Piste assignée par APP en priorité, sinon n'importe quelle autre piste d'arrivée utilisable
+    size_t piste = pistes_.size();
+    if (pisteAssignee < pistes_.size() && pisteUtilisable(pisteAssignee)) piste = pisteAssignee;
+    for (size_t i = 0; i < pistes_.size() && piste == pistes_.size(); ++i) {
+        if (pisteUtilisable(i)) piste = i;
     }
 
-    // Vérification s'il y a des avions en attente de décollage
-    bool avionsEnAttenteDecollage = false;
-    for (auto* a : filePourDecollage_) {
-        if (a->getEtat() == EtatAvion::EN_ATTENTE_PISTE) {
-            avionsEnAttenteDecollage = true;
-            break;
+    // Priorité absolue aux urgences (sur la piste assignée si aucune n'est disponible)
+    if (avion->estEnUrgence() && piste == pistes_.size()) {
+        piste = pisteAssignee;
+        for (size_t i = 0; i < pistes_.size() && piste == pistes_.size(); ++i) {
+            if (pistes_[i].accepteArrivees()) piste = i;
         }
     }
 
-    // Gestion de l'alternance Décollage/Atterrissage
-    if (tourActuel_ == Tour::DECOLLAGE && avionsEnAttenteDecollage) {
-        return false; // Priorité aux décollages
+    // Refus si aucune piste disponible ou pas de parking
+    if (piste == pistes_.size()) {
+        return false;
+    }
+    if (!avion->estEnUrgence() && !parkingDisponible()) {
+        return false;
     }
 
     // Autorisation accordée
-    pisteLibre_ = false;
-    tourActuel_ = Tour::DECOLLAGE; // Le prochain tour sera pour un décollage
+    pistes_[piste].reserver(maintenant);
+    pistes_[piste].setTour(Tour::DECOLLAGE); // Le prochain tour sera pour un décollage
+    publierEtat();
+
+    // Trajectoire finale vers la piste, transmise avant le changement d'état
+    Position p = pistes_[piste].getSeuil();
+    avion->setPiste(piste);
+    avion->setTrajectoire({{p.getX() + 1500.0, p.getY(), 0.0}});
     avion->setEtat(EtatAvion::ATTERRISSAGE);
     return true;
 }
 
+void TWR::demanderAtterrissage(Avion* avion, APP* demandeur) {
+    if (!avion || !demandeur) throw std::invalid_argument("Avion ou APP NULL");
+    demandesAtterrissage_.deposer({ avion, demandeur });
+}
+
+void TWR::traiterMessages() {
+    for (const auto& demande : demandesAtterrissage_.relever()) {
+        bool accord = autoriserAtterrissage(demande.avion);
+        demande.demandeur->recevoirReponseAtterrissage(demande.avion, accord); // Réponse déposée, la tour n'attend pas l'APP
+    }
+    std::lock_guard<std::mutex> lock(mutexTWR_);
+    publierEtat(); // Les avions arrivés au seuil depuis le dernier relevé
+}
+
 Parking* TWR::choisirParkingLibre() {
     std::lock_guard<std::mutex> lock(mutexTWR_);
     for (auto& parking : parkings_) {
@@ -102,20 +210,14 @@ void TWR::attribuerParking(Avion* avion, Parking* parking) {
 
     std::stringstream ss;
     ss << "Avion " << avion->getNom() << " au parking " << parking->getNom();
-    Logs::getLogs().log("TWR", "Parking", ss.str());
+    Logs::getLogs().log("TWR", "Parking", ss.str(), avion->getNom(), aeroport_);
 }
 
 void TWR::gererRoulageVersParking(Avion* avion, Parking* parking) {
     if (!avion || !parking) throw std::invalid_argument("Avion ou parking NULL");
 
-    // Création du chemin de roulage
-    std::vector<Position> cheminRoulage;
-    cheminRoulage.push_back(Position(posPiste_.getX(), posPiste_.getY(), 0)); // Sortie de piste
-    cheminRoulage.push_back(Position(posPiste_.getX(), posPiste_.getY() + 200, 0)); // Voie de circulation
-    cheminRoulage.push_back(Position(parking->getPosition().getX(), posPiste_.getY() + 200, 0)); // Approche parking
-    cheminRoulage.push_back(parking->getPosition()); // Entrée parking
-
-    avion->setTrajectoire(cheminRoulage);
+    // Chemin de roulage précalculé au chargement (sortie de la piste d'atterrissage -> parking)
+    avion->setTrajectoire(roulage_.getCheminVersParking(avion->getPiste(), indexParking(parking)));
     avion->setEtat(EtatAvion::ROULE_VERS_PARKING);
 }
 
@@ -129,55 +231,101 @@ void TWR::enregistrerPourDecollage(Avion* avion) {
     }
 }
 
+void TWR::setMaxDepartsEnCours(size_t max) {
+    std::lock_guard<std::mutex> lock(mutexTWR_);
+    if (max == 0) throw std::invalid_argument("Il faut au moins un depart en cours par piste");
+    maxDepartsEnCours_ = max;
+}
+
 Avion* TWR::choisirAvionPourDecollage() {
     std::lock_guard<std::mutex> lock(mutexTWR_);
 
     if (filePourDecollage_.empty()) return nullptr;
 
-    // Priorité 1 : Avion déjà au seuil de piste
+    // Priorité 1 : Avion déjà au seuil d'une piste disponible (et dont c'est le tour en mode mixte)
+    auto maintenant = Horloge::getHorloge().maintenant();
+    bool parkingDispo = parkingDisponible();
     for (Avion* avion : filePourDecollage_) {
-        if (avion->getEtat() == EtatAvion::EN_ATTENTE_PISTE) return avion;
+        InstantaneAvion etat = avion->getInstantane();
+        if (etat.etat != EtatAvion::EN_ATTENTE_PISTE || etat.piste >= pistes_.size()) continue;
+        const Piste& piste = pistes_[etat.piste];
+        if (!piste.estDisponible(maintenant)) continue;
+        if (piste.getMode() == ModePiste::MIXTE && piste.getTour() == Tour::ATTERRISSAGE && demandeAtterrissage_ && parkingDispo) continue;
+        return avion;
     }
 
-    // Si un avion roule déjà vers la piste, on attend qu'il arrive
+    // Roulages en parallèle : le suivant est déjà au seuil quand la piste se libère
+    lancerRoulages(maintenant);
+    return nullptr; // Aucun avion prêt à décoller maintenant (ceux qui roulent ne le sont pas encore)
+}
+
+size_t TWR::chargeDepart(size_t indexPiste) const {
+    size_t charge = 0;
     for (Avion* avion : filePourDecollage_) {
-        if (avion->getEtat() == EtatAvion::ROULE_VERS_PISTE) return nullptr;
+        InstantaneAvion etat = avion->getInstantane();
+        if ((etat.etat == EtatAvion::ROULE_VERS_PISTE || etat.etat == EtatAvion::EN_ATTENTE_PISTE) && etat.piste == indexPiste) charge++;
     }
+    return charge;
+}
 
-    // Priorité 2 : Choisir l'avion le plus éloigné de la piste
-    Avion* prioritaire = nullptr;
-    double maxDistance = -1.0;
-
-    for (Avion* avion : filePourDecollage_) {
-        if (avion->getEtat() == EtatAvion::EN_ATTENTE_DECOLLAGE) {
-            Parking* parking = avion->getParking();
-            if (parking) {
-                double distance = parking->getDistancePiste(posPiste_);
-                if (distance > maxDistance) {
-                    maxDistance = distance;
-                    prioritaire = avion;
+void TWR::lancerRoulages(std::chrono::steady_clock::time_point maintenant) {
+    while (true) {
+        size_t pisteDepart = choisirPisteDepart();
+        size_t charge = chargeDepart(pisteDepart);
+        if (charge >= maxDepartsEnCours_) return; // File de départ pleine
+
+        // Avion le plus éloigné de la piste (en distance de roulage) : c'est lui qui doit partir le plus tôt
+        Avion* prioritaire = nullptr;
+        double maxDistance = -1.0;
+        for (Avion* avion : filePourDecollage_) {
+            if (avion->getEtat() == EtatAvion::EN_ATTENTE_DECOLLAGE) {
+                Parking* parking = avion->getParking();
+                if (parking) {
+                    double distance = roulage_.getLongueurVersPiste(pisteDepart, indexParking(parking));
+                    if (distance > maxDistance) {
+                        maxDistance = distance;
+                        prioritaire = avion;
+                    }
                 }
             }
         }
-    }
+        if (!prioritaire) return;
 
-    // Lancement du roulage pour l'avion choisi
-    if (prioritaire) {
-        std::vector<Position> cheminRoulage;
-        Parking* pkg = prioritaire->getParking();
-        if (!pkg) throw std::logic_error("Parking NULL");
+        // Instant où la piste pourra accueillir ce départ, derrière ceux qui roulent ou attendent déjà
+        const Piste& piste = pistes_[pisteDepart];
+        auto occupation = piste.getOccupationEstimee();
+        if (piste.getMode() == ModePiste::MIXTE && demandeAtterrissage_) occupation *= 2; // Un atterrissage s'intercale entre deux départs
+        auto creneau = std::max(maintenant, piste.getLiberationEstimee()) + occupation * static_cast<long long>(charge);
 
-        // Chemin inverse du parking vers la piste
-        cheminRoulage.push_back(Position(pkg->getPosition().getX(), posPiste_.getY() + 200, 0));
-        cheminRoulage.push_back(Position(posPiste_.getX(), posPiste_.getY() + 200, 0));
-        cheminRoulage.push_back(Position(posPiste_.getX(), posPiste_.getY(), 0));
+        // Départ du parking pour arriver au seuil au plus tard à ce créneau (la tour ne regarde qu'une fois par cycle)
+        float vitesseSol = std::max(prioritaire->getVitesseSol(), 1.f);
+        auto tempsRoulage = std::chrono::milliseconds(static_cast<long long>(maxDistance / vitesseSol * PAS_AVION_MS));
+        if (maintenant + tempsRoulage + CYCLE_TWR < creneau) return;
 
-        prioritaire->setTrajectoire(cheminRoulage);
+        // Chemin précalculé du parking vers le point d'attente de la piste choisie
+        Parking* pkg = prioritaire->getParking();
+        prioritaire->setPiste(pisteDepart);
+        prioritaire->setTrajectoire(roulage_.getCheminVersPiste(pisteDepart, indexParking(pkg)));
         prioritaire->setEtat(EtatAvion::ROULE_VERS_PISTE);
+        Logs::getLogs().log("TWR", "Roulage", "Roulage de " + prioritaire->getNom() + " vers la piste " + piste.getNom(), prioritaire->getNom(), aeroport_);
+    }
+}
 
-        return nullptr; // Retourne null car l'avion n'est pas encore prêt à décoller (il roule)
+size_t TWR::choisirPisteDepart() const {
+    // Piste de décollage avec le moins d'avions qui y roulent ou y attendent, puis la plus tôt disponible
+    size_t meilleure = pistes_.size();
+    size_t meilleureCharge = 0;
+    for (size_t i = 0; i < pistes_.size(); ++i) {
+        if (!pistes_[i].accepteDeparts()) continue;
+        size_t charge = chargeDepart(i);
+        if (meilleure == pistes_.size() || charge < meilleureCharge ||
+            (charge == meilleureCharge && pistes_[i].getDisponibleA() < pistes_[meilleure].getDisponibleA())) {
+            meilleure = i;
+            meilleureCharge = charge;
+        }
     }
-    return nullptr;
+    if (meilleure == pistes_.size()) throw std::logic_error("Aucune piste de decollage");
+    return meilleure;
 }
 
 bool TWR::autoriserDecollage(Avion* avion) {
@@ -187,39 +335,38 @@ bool TWR::autoriserDecollage(Avion* avion) {
     if (urgenceEnCours_) return false; // Blocage total si urgence en cours
 
     if (avion->getEtat() == EtatAvion::EN_ATTENTE_PISTE) {
-        if (!pisteLibre_) return false;
+        if (avion->getPiste() >= pistes_.size()) throw std::logic_error("Piste de decollage inexistante");
+        Piste& piste = pistes_[avion->getPiste()];
+        auto maintenant = Horloge::getHorloge().maintenant();
+        if (!piste.estDisponible(maintenant)) return false;
 
         // Vérification disponibilité parking (pour éviter blocage si atterrissage forcé)
-        bool parkingDispo = false;
-        for (const auto& p : parkings_) {
-            if (!p.estOccupe()) {
-                parkingDispo = true;
-                break;
-            }
-        }
+        bool parkingDispo = parkingDisponible();
 
-        // Gestion de l'alternance Atterrissage/Décollage
-        if (tourActuel_ == Tour::ATTERRISSAGE && demandeAtterrissage_) {
+        // Gestion de l'alternance Atterrissage/Décollage (pistes mixtes uniquement)
+        if (piste.getMode() == ModePiste::MIXTE && piste.getTour() == Tour::ATTERRISSAGE && demandeAtterrissage_) {
             if (parkingDispo) {
                 return false; // Priorité aux atterrissages
             }
         }
 
         // Autorisation accordée
-        pisteLibre_ = false;
-        tourActuel_ = Tour::ATTERRISSAGE; // Le prochain tour sera pour un atterrissage
+        piste.reserver(maintenant);
+        piste.setTour(Tour::ATTERRISSAGE); // Le prochain tour sera pour un atterrissage
 
         // Trajectoire de montée initiale
+        Position seuil = piste.getSeuil();
         std::vector<Position> trajMontee;
-        trajMontee.push_back(Position(posPiste_.getX() + 1500, posPiste_.getY(), 0));
-        trajMontee.push_back(Position(posPiste_.getX() + 21500, posPiste_.getY(), 3000));
+        trajMontee.push_back(Position(seuil.getX() + 1500, seuil.getY(), 0));
+        trajMontee.push_back(Position(seuil.getX() + 21500, seuil.getY(), 3000));
 
         avion->setTrajectoire(trajMontee);
         avion->setEtat(EtatAvion::DECOLLAGE);
+        publierEtat();
 
         std::stringstream ss;
         ss << "Decollage immediat pour " << avion->getNom();
-        Logs::getLogs().log("TWR", "Decollage", ss.str());
+        Logs::getLogs().log("TWR", "Decollage", ss.str(), avion->getNom(), aeroport_);
 
         return true;
     }
@@ -233,16 +380,34 @@ void TWR::retirerAvionDeDecollage(Avion* avion) {
     auto it = std::find(filePourDecollage_.begin(), filePourDecollage_.end(), avion);
     if (it != filePourDecollage_.end()) {
         filePourDecollage_.erase(it);
-        pisteLibre_ = true; // Libération de la piste une fois l'avion en l'air
+        if (avion->getPiste() < pistes_.size()) libererPisteVerrouillee(avion->getPiste(), Horloge::getHorloge().maintenant()); // Libération de la piste une fois l'avion en l'air
+        publierEtat();
     }
 }
 
-void TWR::setUrgenceEnCours(bool statut) {
+void TWR::capturer(std::vector<Piste>& pistes, std::vector<Avion*>& fileDecollage) const {
     std::lock_guard<std::mutex> lock(mutexTWR_);
-    urgenceEnCours_ = statut;
+    pistes = pistes_;
+    fileDecollage = filePourDecollage_;
 }
 
-bool TWR::estUrgenceEnCours() const {
+void TWR::restaurer(const std::vector<Piste>& pistes, const std::vector<Avion*>& fileDecollage, bool urgenceEnCours) {
     std::lock_guard<std::mutex> lock(mutexTWR_);
-    return urgenceEnCours_;
+    if (pistes.size() != pistes_.size()) throw std::invalid_argument("Nombre de pistes different de celui du scenario");
+    for (size_t i = 0; i < pistes.size(); ++i) {
+        if (pistes[i].getNom() != pistes_[i].getNom()) throw std::invalid_argument("Piste inconnue : " + pistes[i].getNom());
+    }
+    pistes_ = pistes;
+    filePourDecollage_ = fileDecollage;
+    urgenceEnCours_ = urgenceEnCours;
+    publierEtat();
+}
+
+void TWR::setUrgenceEnCours(bool statut) { urgenceEnCours_ = statut; }
+
+bool TWR::estUrgenceEnCours() const { return urgenceEnCours_; }
+
+bool TWR::estDecollageEnAttente(size_t indexPiste) const {
+    auto etat = etatPublie_.load();
+    return indexPiste < etat->decollageEnAttente.size() && etat->decollageEnAttente[indexPiste];
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "avion.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+// Fichier de vent (texte, les lignes commençant par # sont ignorées) :
+//   GRILLE nx ny x0 y0 pas   noeud sud-ouest et espacement en m, au moins 2 x 2 noeuds
+//   INSTANT t                secondes simulées depuis le chargement, croissantes, chacune suivie de
+//   u v u v ...              ny lignes (du sud au nord) de nx couples, en m par pas comme les vitesses des avions
+// Avant le premier instant le champ vaut le premier, après le dernier il garde le dernier.
+
+const double ALTITUDE_VENT_PLEIN = 9000.0; // Au-dessus, le vent de la grille s'applique en entier
+const float ATTENUATION_SOL = 0.3f; // Part du vent conservée au niveau du sol
+const double PAS_GRILLE_GENEREE = 25000.0; // m
+const size_t INSTANTS_GENERES = 36;
+const double PERIODE_GENEREE = 1800.0; // s simulées
+const int TOURBILLONS_GENERES = 5;
+const double PI = 3.14159265358979323846;
+
+ChampVent::ChampVent(double x0, double y0, double pas, size_t nx, size_t ny)
+    : x0_(x0), y0_(y0), pas_(pas), nx_(nx), ny_(ny), periode_(0), origine_(Horloge::getHorloge().maintenant()) {
+    if (pas <= 0 || nx < 2 || ny < 2) throw std::invalid_argument("Grille de vent invalide");
+}
+
+ChampVent ChampVent::charger(const std::string& chemin) {
+    std::ifstream fichier(chemin);
+    if (!fichier.is_open()) throw std::runtime_error("Fichier de vent " + chemin + " pas trouve");
+
+    // Tous les mots hors commentaires, dans l'ordre
+    std::stringstream contenu;
+    std::string ligne;
+    while (std::getline(fichier, ligne)) {
+        if (!ligne.empty() && ligne[0] != '#') contenu << ligne << ' ';
+    }
+
+    std::string mot;
+    size_t nx = 0, ny = 0;
+    double x0 = 0, y0 = 0, pas = 0;
+    if (!(contenu >> mot) || mot != "GRILLE" || !(contenu >> nx >> ny >> x0 >> y0 >> pas)) {
+        throw std::runtime_error("Fichier de vent " + chemin + " : GRILLE nx ny x0 y0 pas attendue");
+    }
+    ChampVent champ(x0, y0, pas, nx, ny);
+
+    while (contenu >> mot) {
+        double t;
+        if (mot != "INSTANT" || !(contenu >> t)) throw std::runtime_error("Fichier de vent " + chemin + " : INSTANT t attendu");
+        if (!champ.instants_.empty() && t <= champ.instants_.back()) throw std::runtime_error("Fichier de vent " + chemin + " : instants non croissants");
+        champ.instants_.push_back(t);
+        for (size_t i = 0; i < 2 * nx * ny; ++i) {
+            float composante;
+            if (!(contenu >> composante)) throw std::runtime_error("Fichier de vent " + chemin + " : valeurs manquantes a l'instant " + std::to_string(t));
+            champ.composantes_.push_back(composante);
+        }
+    }
+    if (champ.instants_.empty()) throw std::runtime_error("Fichier de vent " + chemin + " : aucun instant");
+    return champ;
+}
+
+ChampVent ChampVent::generer(double xMin, double yMin, double xMax, double yMax, float vitesse, unsigned int graine) {
+    if (xMax <= xMin || yMax <= yMin) throw std::invalid_argument("Zone de vent vide");
+    if (vitesse < 0) throw std::invalid_argument("Vitesse du vent negative");
+
+    size_t nx = static_cast<size_t>(std::ceil((xMax - xMin) / PAS_GRILLE_GENEREE)) + 1;
+    size_t ny = static_cast<size_t>(std::ceil((yMax - yMin) / PAS_GRILLE_GENEREE)) + 1;
+    ChampVent champ(xMin, yMin, PAS_GRILLE_GENEREE, nx, ny);
+    champ.periode_ = PERIODE_GENEREE;
+    double largeur = PAS_GRILLE_GENEREE * static_cast<double>(nx - 1);
+    double hauteur = PAS_GRILLE_GENEREE * static_cast<double>(ny - 1);
+
+    struct Tourbillon {
+        double x, y, rayon, intensite; // intensite < 0 : sens horaire
+    };
+    std::mt19937 gen(graine);
+    std::uniform_real_distribution<double> hasard(0.0, 1.0);
+    double phaseCourant = 2 * PI * hasard(gen);
+    std::vector<Tourbillon> tourbillons;
+    for (int i = 0; i < TOURBILLONS_GENERES; ++i) {
+        Tourbillon t;
+        t.x = hasard(gen) * largeur;
+        t.y = hasard(gen) * hauteur;
+        t.rayon = (0.1 + 0.15 * hasard(gen)) * std::min(largeur, hauteur);
+        t.intensite = (hasard(gen) < 0.5 ? -1.0 : 1.0) * (1.0 + hasard(gen)) * vitesse;
+        tourbillons.push_back(t);
+    }
+
+    // Instants réguliers sur la période : tout dérive d'un tour complet, le dernier instant se raccorde au premier
+    champ.composantes_.reserve(INSTANTS_GENERES * nx * ny * 2);
+    for (size_t k = 0; k < INSTANTS_GENERES; ++k) {
+        double avance = static_cast<double>(k) / static_cast<double>(INSTANTS_GENERES);
+        champ.instants_.push_back(avance * PERIODE_GENEREE);
+        for (size_t iy = 0; iy < ny; ++iy) {
+            double y = PAS_GRILLE_GENEREE * static_cast<double>(iy);
+            for (size_t ix = 0; ix < nx; ++ix) {
+                double x = PAS_GRILLE_GENEREE * static_cast<double>(ix);
+
+                // Courant d'ouest dont la force varie avec la latitude et oscille sur la période
+                double u = vitesse * (0.6 + 0.4 * std::sin(2 * PI * (y / hauteur + avance) + phaseCourant));
+                double v = 0;
+
+                // Tourbillons emportés vers l'est, d'une largeur de carte par période (la carte est vue comme cyclique en x)
+                for (const auto& t : tourbillons) {
+                    double dx = std::remainder(x - (t.x + avance * largeur), largeur);
+                    double dy = y - t.y;
+                    double f = t.intensite / t.rayon * std::exp(-(dx * dx + dy * dy) / (t.rayon * t.rayon));
+                    u -= f * dy;
+                    v += f * dx;
+                }
+                champ.composantes_.push_back(static_cast<float>(u));
+                champ.composantes_.push_back(static_cast<float>(v));
+            }
+        }
+    }
+    return champ;
+}
+
+size_t ChampVent::indexInstant(std::chrono::steady_clock::time_point instant, float& poids) const {
+    double t = std::chrono::duration<double>(instant - origine_).count();
+    size_t n = instants_.size();
+    poids = 0;
+    if (periode_ > 0) {
+        // Instants réguliers, le dernier se raccorde au premier
+        double position = (t - std::floor(t / periode_) * periode_) / periode_ * static_cast<double>(n);
+        size_t i = std::min(static_cast<size_t>(position), n - 1);
+        poids = static_cast<float>(position - static_cast<double>(i));
+        return i;
+    }
+    if (t <= instants_.front()) return 0;
+    if (t >= instants_.back()) return n - 1;
+    size_t i = static_cast<size_t>(std::upper_bound(instants_.begin(), instants_.end(), t) - instants_.begin()) - 1;
+    poids = static_cast<float>((t - instants_[i]) / (instants_[i + 1] - instants_[i]));
+    return i;
+}
+
+void ChampVent::echantillonner(const std::vector<Position>& positions, std::chrono::steady_clock::time_point instant, std::vector<Vent>& vents) const {
+    // Deux couches encadrant l'instant, choisies une fois pour tout le lot
+    float poids;
+    size_t i = indexInstant(instant, poids);
+    size_t suivant = (periode_ > 0) ? (i + 1) % instants_.size() : std::min(i + 1, instants_.size() - 1);
+    const float* avant = composantes_.data() + i * 2 * nx_ * ny_;
+    const float* apres = composantes_.data() + suivant * 2 * nx_ * ny_;
+
+    double inversePas = 1.0 / pas_;
+    double xMax = static_cast<double>(nx_ - 1) - 1e-6;
+    double yMax = static_cast<double>(ny_ - 1) - 1e-6;
+    vents.resize(positions.size());
+
+    for (size_t k = 0; k < positions.size(); ++k) {
+        const Position& p = positions[k];
+
+        // Cellule de la grille (bornée à ses bords) et poids bilinéaires
+        double gx = std::clamp((p.getX() - x0_) * inversePas, 0.0, xMax);
+        double gy = std::clamp((p.getY() - y0_) * inversePas, 0.0, yMax);
+        size_t ix = static_cast<size_t>(gx);
+        size_t iy = static_cast<size_t>(gy);
+        float fx = static_cast<float>(gx - static_cast<double>(ix));
+        float fy = static_cast<float>(gy - static_cast<double>(iy));
+        float p00 = (1 - fx) * (1 - fy), p10 = fx * (1 - fy), p01 = (1 - fx) * fy, p11 = fx * fy;
+        size_t n00 = 2 * (iy * nx_ + ix);
+        size_t n01 = n00 + 2 * nx_;
+
+        float ua = p00 * avant[n00] + p10 * avant[n00 + 2] + p01 * avant[n01] + p11 * avant[n01 + 2];
+        float va = p00 * avant[n00 + 1] + p10 * avant[n00 + 3] + p01 * avant[n01 + 1] + p11 * avant[n01 + 3];
+        float ub = p00 * apres[n00] + p10 * apres[n00 + 2] + p01 * apres[n01] + p11 * apres[n01 + 2];
+        float vb = p00 * apres[n00 + 1] + p10 * apres[n00 + 3] + p01 * apres[n01 + 1] + p11 * apres[n01 + 3];
+
+        // Vent plus faible près du sol
+        float hauteur = static_cast<float>(std::clamp(p.getAltitude() / ALTITUDE_VENT_PLEIN, 0.0, 1.0));
+        float attenuation = ATTENUATION_SOL + (1 - ATTENUATION_SOL) * hauteur;
+        vents[k].u = (ua + poids * (ub - ua)) * attenuation;
+        vents[k].v = (va + poids * (vb - va)) * attenuation;
+    }
+}
\ No newline at end of file